@@ -0,0 +1,134 @@
+// AdcCapture.cpp - continuous ADC sampling through the DMA controller
+#include "AdcCapture.h"
+#include <Arduino.h>
+#include <driver/adc.h>
+
+#define CAPTURE_TASK_STACK 3072
+#define CAPTURE_TASK_PRIORITY 5
+
+bool AdcCapture::begin(const uint8_t *pinList, uint8_t count, uint32_t sampleRateHz) {
+    if (running || count == 0 || count > ADC_CAPTURE_MAX_PINS) {
+        return false;
+    }
+
+    // Every pin has to be on ADC1; ADC2 is shared with the radio on the C3
+    uint32_t channelMask = 0;
+    adc_digi_pattern_config_t pattern[ADC_CAPTURE_MAX_PINS] = {};
+    for (uint8_t i = 0; i < count; i++) {
+        int8_t channel = digitalPinToAnalogChannel(pinList[i]);
+        if (channel < 0 || channel >= SOC_ADC_CHANNEL_NUM(0)) {
+            return false;
+        }
+        pins[i] = pinList[i];
+        channels[i] = channel;
+        channelMask |= 1 << channel;
+
+        pattern[i].atten = ADC_ATTEN_DB_11; // Same 0-3.3 V range as analogRead()
+        pattern[i].channel = channel;
+        pattern[i].unit = 0;
+        pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
+    pinCount = count;
+
+    adc_digi_init_config_t init = {};
+    init.max_store_buf_size = ADC_FRAME_BYTES * 4;
+    init.conv_num_each_intr = ADC_FRAME_BYTES;
+    init.adc1_chan_mask = channelMask;
+    if (adc_digi_initialize(&init) != ESP_OK) {
+        return false;
+    }
+
+    adc_digi_configuration_t config = {};
+    config.sample_freq_hz = sampleRateHz;
+    config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+    config.pattern_num = count;
+    config.adc_pattern = pattern;
+    if (adc_digi_controller_configure(&config) != ESP_OK || adc_digi_start() != ESP_OK) {
+        adc_digi_deinitialize();
+        return false;
+    }
+
+    running = true;
+    xTaskCreate(captureTask, "adcCapture", CAPTURE_TASK_STACK, this, CAPTURE_TASK_PRIORITY, NULL);
+    return true;
+}
+
+void AdcCapture::captureTask(void *arg) {
+    AdcCapture *self = (AdcCapture *)arg;
+    uint8_t frame[ADC_FRAME_BYTES];
+
+    for (;;) {
+        // Blocks until the DMA interrupt hands over a frame. ESP_ERR_INVALID_STATE
+        // means the driver's own pool overflowed, but the frame is still good.
+        uint32_t length = 0;
+        esp_err_t err = adc_digi_read_bytes(frame, sizeof(frame), &length, portMAX_DELAY);
+        if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+            continue;
+        }
+
+        for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= length; i += SOC_ADC_DIGI_RESULT_BYTES) {
+            const adc_digi_output_data_t *result = (const adc_digi_output_data_t *)&frame[i];
+            if (result->type2.unit == 0) {
+                self->store(result->type2.channel, result->type2.data);
+            }
+        }
+    }
+}
+
+void AdcCapture::store(uint8_t channel, uint16_t sample) {
+    for (uint8_t i = 0; i < pinCount; i++) {
+        if (channels[i] != channel) {
+            continue;
+        }
+        SampleRing &ring = rings[i];
+        uint32_t head = ring.head.load(std::memory_order_relaxed);
+        if (head - ring.tail.load(std::memory_order_acquire) >= ADC_RING_SAMPLES) {
+            ring.overruns++;
+            return;
+        }
+        ring.samples[head & (ADC_RING_SAMPLES - 1)] = sample;
+        ring.head.store(head + 1, std::memory_order_release);
+        return;
+    }
+}
+
+SampleRing *AdcCapture::ringFor(uint8_t pin) {
+    for (uint8_t i = 0; i < pinCount; i++) {
+        if (pins[i] == pin) {
+            return &rings[i];
+        }
+    }
+    return NULL;
+}
+
+size_t AdcCapture::read(uint8_t pin, uint16_t *dest, size_t maxSamples) {
+    SampleRing *ring = ringFor(pin);
+    if (!ring) {
+        return 0;
+    }
+
+    uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+    size_t count = ring->head.load(std::memory_order_acquire) - tail;
+    if (count > maxSamples) {
+        count = maxSamples;
+    }
+    for (size_t i = 0; i < count; i++) {
+        dest[i] = ring->samples[(tail + i) & (ADC_RING_SAMPLES - 1)];
+    }
+    ring->tail.store(tail + count, std::memory_order_release);
+    return count;
+}
+
+size_t AdcCapture::available(uint8_t pin) {
+    SampleRing *ring = ringFor(pin);
+    if (!ring) {
+        return 0;
+    }
+    return ring->head.load(std::memory_order_acquire) - ring->tail.load(std::memory_order_relaxed);
+}
+
+uint32_t AdcCapture::overruns(uint8_t pin) {
+    SampleRing *ring = ringFor(pin);
+    return ring ? ring->overruns : 0;
+}
@@ -0,0 +1,52 @@
+// AdcCapture.h - continuous ADC sampling through the DMA controller
+//
+// The ADC's digital controller converts the configured pins in turn at a fixed
+// rate and DMAs the results into driver buffers. A capture task moves them into
+// one ring buffer per pin, so readers take whole blocks without ever waiting on
+// a conversion.
+#ifndef ADC_CAPTURE_H
+#define ADC_CAPTURE_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ADC_CAPTURE_MAX_PINS 2
+#define ADC_RING_SAMPLES 2048 // Per pin, power of two
+#define ADC_FRAME_BYTES 256   // Conversion results handed over per DMA interrupt
+
+// One producer (the capture task) and one reader; the indices only ever grow
+struct SampleRing {
+    uint16_t samples[ADC_RING_SAMPLES];
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+    uint32_t overruns = 0; // Samples dropped because the reader fell behind
+};
+
+// Called with each block a reader takes out of a ring, in capture order
+typedef void (*SampleTap)(const uint16_t *samples, size_t count);
+
+class AdcCapture {
+public:
+    // Start sampling every pin in turn; sampleRateHz is the total across all pins
+    bool begin(const uint8_t *pins, uint8_t count, uint32_t sampleRateHz);
+    bool isRunning() const { return running; }
+
+    // Copy out up to maxSamples captured on pin, oldest first
+    size_t read(uint8_t pin, uint16_t *dest, size_t maxSamples);
+    size_t available(uint8_t pin);
+    uint32_t overruns(uint8_t pin);
+
+private:
+    static void captureTask(void *arg);
+    void store(uint8_t channel, uint16_t sample);
+    SampleRing *ringFor(uint8_t pin);
+
+    uint8_t pins[ADC_CAPTURE_MAX_PINS];
+    uint8_t channels[ADC_CAPTURE_MAX_PINS];
+    uint8_t pinCount = 0;
+    SampleRing rings[ADC_CAPTURE_MAX_PINS];
+    bool running = false;
+};
+
+#endif // ADC_CAPTURE_H
@@ -0,0 +1,189 @@
+#ifdef RUN_BENCHMARKS
+
+#include "Benchmark.h"
+#include "FixedPoint.h"
+#include "Framing.h"
+#include "SoundMeter.h"
+#include "Spectrum.h"
+#include <math.h>
+
+#ifdef NATIVE_BUILD
+#include <chrono>
+#include <stdio.h>
+#define BENCH_PRINTF printf
+#define BENCH_UNIT "ns"
+#define BENCH_UNITS_PER_SECOND 1e9f
+static uint32_t benchNow() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+#else
+#include <Arduino.h>
+#define BENCH_PRINTF Serial.printf
+#define BENCH_UNIT "cycles"
+#define BENCH_UNITS_PER_SECOND (ESP.getCpuFreqMHz() * 1e6f)
+static uint32_t benchNow() {
+    return ESP.getCycleCount();
+}
+#endif
+
+#define BENCH_ROUNDS 8
+#define ADC_VALUES (ADC_MAX_COUNT + 1)
+
+// Keeps results alive so the compiler can't drop the work being timed
+static volatile int32_t sinkInt;
+static volatile float sinkFloat;
+
+// The float conversions from the original readGas()/getSoundLevelInDecibels()
+static float floatMillivolts(int raw) {
+    float voltage = raw * (3.3 / 4095.0);
+    return voltage * 1000;
+}
+
+static float floatPercent(int raw) {
+    float voltage = raw * (3.3 / 4095.0);
+    return (voltage / 3.3) * 100;
+}
+
+static float floatDecibels(int raw) {
+    float voltage = (raw / 4095.0) * 3.3;
+    return 20 * log10(voltage / 0.00631);
+}
+
+// Average time per call over every ADC value
+template <typename Fn>
+static float timePerCall(Fn fn) {
+    uint32_t start = benchNow();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (int raw = 0; raw < ADC_VALUES; raw++) {
+            fn(raw);
+        }
+    }
+    return (float)(benchNow() - start) / (BENCH_ROUNDS * ADC_VALUES);
+}
+
+static void report(const char *name, float floatTime, float fixedTime, float maxError, const char *unit) {
+    BENCH_PRINTF("%-12s %10.1f %10.1f %8.1fx   max error %.3f %s\n", name, floatTime, fixedTime,
+                 fixedTime > 0 ? floatTime / fixedTime : 0.0f, maxError, unit);
+}
+
+// Synthetic mic signal: 8 windows of 125 ms at 10 kHz around a 1.9 V bias
+#define SYNTH_WINDOW 1250
+#define SYNTH_WINDOWS 8
+#define SYNTH_SAMPLES (SYNTH_WINDOW * SYNTH_WINDOWS)
+#define SYNTH_RATE_HZ 10000
+#define SYNTH_BIAS 2360
+
+static uint16_t synth[SYNTH_SAMPLES];
+
+static void makeSignal(float amplitude) {
+    for (int i = 0; i < SYNTH_SAMPLES; i++) {
+        float x = amplitude * sinf(2 * (float)M_PI * 440 * i / SYNTH_RATE_HZ);
+        synth[i] = (uint16_t)lroundf(SYNTH_BIAS + x);
+    }
+}
+
+// Throughput of the kernel, in the same units as the conversions above. Its
+// accuracy is checked by test/test_sound_meter.
+static void benchSoundMeter() {
+    BENCH_PRINTF("\n=== SoundMeter on synthetic blocks, %d-sample windows, Leq over %d ===\n", SYNTH_WINDOW,
+                 SYNTH_WINDOWS);
+    makeSignal(500);
+    SoundMeter meter(SYNTH_WINDOW, SYNTH_WINDOWS);
+    uint32_t start = benchNow();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (int offset = 0; offset < SYNTH_SAMPLES; offset += 250) {
+            meter.process(&synth[offset], 250);
+        }
+    }
+    float perSample = (float)(benchNow() - start) / (BENCH_ROUNDS * SYNTH_SAMPLES);
+    sinkInt = meter.level().rmsCentiDb;
+    BENCH_PRINTF("process(): %.2f " BENCH_UNIT " per sample in 250-sample blocks\n", perSample);
+}
+
+// Time per block of analyse(), and the share of real time that is. Its
+// accuracy is checked by test/test_spectrum.
+static void benchSpectrum() {
+    BENCH_PRINTF("\n=== Spectrum, %d-point fixed-point FFT at %d Hz ===\n", SPECTRUM_SIZE, SPECTRUM_SAMPLE_RATE_HZ);
+    makeSignal(500);
+    static Spectrum spectrum;
+    SpectrumLevels levels;
+    uint32_t start = benchNow();
+    for (int round = 0; round < BENCH_ROUNDS * 4; round++) {
+        spectrum.analyse(&synth[(round % 8) * SPECTRUM_SIZE], levels);
+    }
+    float perBlock = (float)(benchNow() - start) / (BENCH_ROUNDS * 4);
+    sinkInt = levels.aWeightedCentiDb;
+    float blocksPerSecond = BENCH_UNITS_PER_SECOND / perBlock;
+    BENCH_PRINTF("analyse(): %.0f " BENCH_UNIT " per block, %.0f blocks/s, %.2f%% of real time\n", perBlock,
+                 blocksPerSecond, 100.0f * SPECTRUM_SAMPLE_RATE_HZ / SPECTRUM_SIZE / blocksPerSecond);
+}
+
+// Cost of framing a sample record and what it takes on the wire. The CRC,
+// COBS and packing are checked by test/test_framing.
+static void benchFraming() {
+    BENCH_PRINTF("\n=== Telemetry framing, COBS + CRC-16 ===\n");
+
+    // A full sample record: header, 128 packed samples
+    static uint8_t payload[FRAME_MAX_PAYLOAD];
+    uint16_t block[128];
+    for (int i = 0; i < 128; i++) {
+        block[i] = synth[i] & 0x0FFF;
+    }
+    uint8_t frame[FRAME_MAX_ENCODED(FRAME_MAX_PAYLOAD)];
+    size_t frameSize = 0;
+    uint32_t start = benchNow();
+    for (int round = 0; round < BENCH_ROUNDS * 16; round++) {
+        size_t length = 7 + packSamples12(block, 128, &payload[7]);
+        frameSize = buildFrame(1, round, round, payload, length, frame);
+    }
+    float perFrame = (float)(benchNow() - start) / (BENCH_ROUNDS * 16);
+    sinkInt = frameSize;
+    float bytesPerSample = (float)frameSize / 128;
+    BENCH_PRINTF("128-sample record: %u bytes on the wire, %.2f bytes/sample, %.0f " BENCH_UNIT " to build\n",
+                 (unsigned)frameSize, bytesPerSample, perFrame);
+    BENCH_PRINTF("Gas at 1 kHz: %.0f B/s; gas + mic at 10 kHz: %.0f B/s (115200 baud carries 11520)\n",
+                 1000 * bytesPerSample, 11000 * bytesPerSample);
+}
+
+void runBenchmarks() {
+    BENCH_PRINTF("\n=== Fixed-point vs float, " BENCH_UNIT " per call ===\n");
+    BENCH_PRINTF("%-12s %10s %10s %9s\n", "", "float", "fixed", "speedup");
+
+    float maxMvError = 0;
+    float maxPermilleError = 0;
+    float maxDbError = 0;
+    for (int raw = 0; raw < ADC_VALUES; raw++) {
+        maxMvError = fmaxf(maxMvError, fabsf(adcToMillivolts(raw) - floatMillivolts(raw)));
+        maxPermilleError = fmaxf(maxPermilleError, fabsf(adcToPermille(raw) - floatPercent(raw) * 10));
+        if (raw > 0) {
+            int32_t centiDb = ratioToCentiDb(adcToMicrovolts(raw), MIC_REFERENCE_UV);
+            maxDbError = fmaxf(maxDbError, fabsf(centiDb / 100.0f - floatDecibels(raw)));
+        }
+    }
+
+    report("adc -> mV",
+           timePerCall([](int raw) { sinkFloat = floatMillivolts(raw); }),
+           timePerCall([](int raw) { sinkInt = adcToMillivolts(raw); }), maxMvError, "mV");
+    report("adc -> %",
+           timePerCall([](int raw) { sinkFloat = floatPercent(raw); }),
+           timePerCall([](int raw) { sinkInt = adcToPermille(raw); }), maxPermilleError / 10, "%");
+    report("adc -> dB",
+           timePerCall([](int raw) { sinkFloat = floatDecibels(raw); }),
+           timePerCall([](int raw) { sinkInt = ratioToCentiDb(adcToMicrovolts(raw), MIC_REFERENCE_UV); }),
+           maxDbError, "dB");
+
+    benchSoundMeter();
+    benchSpectrum();
+    benchFraming();
+}
+
+#if defined(NATIVE_BUILD) && !defined(PIO_UNIT_TESTING)
+int main() {
+    runBenchmarks();
+    return 0;
+}
+#endif
+
+#endif // RUN_BENCHMARKS
@@ -0,0 +1,9 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+// Time the fixed-point sensor math against the float versions it replaced
+// and check its accuracy. Prints cycles per call on the device and
+// nanoseconds per call on the native build.
+void runBenchmarks();
+
+#endif // BENCHMARK_H
@@ -0,0 +1,53 @@
+// FixedPoint.h - integer sensor math for the FPU-less ESP32-C3
+//
+// The C3 has no FPU, so every float or double operation is a library call.
+// These helpers keep the sampling paths in integers: Q16.16 scale factors for
+// ADC conversions and a table-driven log2/log10 for decibels.
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+
+// 12-bit ADC with a 3.3 V full scale
+#define ADC_MAX_COUNT 4095
+#define ADC_FULL_SCALE_MV 3300
+
+// Returned for a zero input, where the level in dB is minus infinity
+#define CENTI_DB_SILENCE INT32_MIN
+
+// Scale factors, rounded at compile time
+constexpr uint32_t MV_PER_COUNT_Q16 = (ADC_FULL_SCALE_MV * 65536ULL + ADC_MAX_COUNT / 2) / ADC_MAX_COUNT;
+constexpr uint32_t UV_PER_COUNT_Q8 = (ADC_FULL_SCALE_MV * 1000ULL * 256 + ADC_MAX_COUNT / 2) / ADC_MAX_COUNT;
+constexpr uint32_t PERMILLE_PER_COUNT_Q16 = (1000 * 65536ULL + ADC_MAX_COUNT / 2) / ADC_MAX_COUNT;
+constexpr int32_t LOG10_2_Q16 = 19728; // log10(2) in Q16.16
+
+// ADC counts to millivolts
+inline uint16_t adcToMillivolts(uint16_t raw) {
+    return (raw * MV_PER_COUNT_Q16 + 0x8000) >> 16;
+}
+
+// ADC counts to microvolts
+inline uint32_t adcToMicrovolts(uint16_t raw) {
+    return (raw * UV_PER_COUNT_Q8 + 0x80) >> 8;
+}
+
+// ADC counts to tenths of a percent of full scale (0-1000)
+inline uint16_t adcToPermille(uint16_t raw) {
+    return (raw * PERMILLE_PER_COUNT_Q16 + 0x8000) >> 16;
+}
+
+// log2(x) in Q16.16 for x > 0, accurate to about 1e-5
+int32_t log2Q16(uint32_t x);
+
+// log10(x) in Q16.16 for x > 0
+inline int32_t log10Q16(uint32_t x) {
+    return (int32_t)(((int64_t)log2Q16(x) * LOG10_2_Q16 + 0x8000) >> 16);
+}
+
+// floor(sqrt(x)), bit by bit with no multiplies
+uint32_t isqrt64(uint64_t x);
+
+// 20 * log10(value / reference) in hundredths of a dB, CENTI_DB_SILENCE for 0
+int32_t ratioToCentiDb(uint32_t value, uint32_t reference);
+
+#endif // FIXED_POINT_H
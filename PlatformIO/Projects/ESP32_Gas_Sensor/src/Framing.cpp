@@ -0,0 +1,95 @@
+// Framing.cpp - telemetry record framing for a lossy byte stream
+#include "Framing.h"
+#include <string.h>
+
+uint16_t crc16(const uint8_t *data, size_t length, uint16_t crc) {
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+size_t cobsEncode(const uint8_t *in, size_t length, uint8_t *out) {
+    // Each code byte counts the bytes up to the next zero, at most 254 of them
+    size_t codeAt = 0;
+    size_t written = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < length; i++) {
+        if (in[i] != 0) {
+            out[written++] = in[i];
+            code++;
+        }
+        if (in[i] == 0 || code == 0xFF) {
+            out[codeAt] = code;
+            codeAt = written++;
+            code = 1;
+        }
+    }
+    out[codeAt] = code;
+    return written;
+}
+
+size_t cobsDecode(const uint8_t *in, size_t length, uint8_t *out) {
+    size_t read = 0;
+    size_t written = 0;
+    while (read < length) {
+        uint8_t code = in[read++];
+        if (code == 0 || read + code - 1 > length) {
+            return 0;
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            if (in[read] == 0) {
+                return 0;
+            }
+            out[written++] = in[read++];
+        }
+        if (code < 0xFF && read < length) {
+            out[written++] = 0;
+        }
+    }
+    return written;
+}
+
+size_t packSamples12(const uint16_t *samples, size_t count, uint8_t *out) {
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 1 < count; i += 2) {
+        uint16_t a = samples[i] & 0x0FFF;
+        uint16_t b = samples[i + 1] & 0x0FFF;
+        out[written++] = a & 0xFF;
+        out[written++] = (a >> 8) | ((b & 0x0F) << 4);
+        out[written++] = b >> 4;
+    }
+    if (i < count) {
+        out[written++] = samples[i] & 0xFF;
+        out[written++] = (samples[i] >> 8) & 0x0F;
+    }
+    return written;
+}
+
+size_t buildFrame(uint8_t type, uint16_t sequence, uint32_t timestampUs, const uint8_t *payload, size_t length,
+                  uint8_t *out) {
+    if (length > FRAME_MAX_PAYLOAD) {
+        return 0;
+    }
+
+    uint8_t record[FRAME_HEADER_BYTES + FRAME_MAX_PAYLOAD + 2];
+    record[0] = type;
+    record[1] = sequence & 0xFF;
+    record[2] = sequence >> 8;
+    for (int i = 0; i < 4; i++) {
+        record[3 + i] = (timestampUs >> (8 * i)) & 0xFF;
+    }
+    memcpy(&record[FRAME_HEADER_BYTES], payload, length);
+    size_t size = FRAME_HEADER_BYTES + length;
+    uint16_t crc = crc16(record, size);
+    record[size++] = crc & 0xFF;
+    record[size++] = crc >> 8;
+
+    size_t encoded = cobsEncode(record, size, out);
+    out[encoded++] = 0;
+    return encoded;
+}
@@ -0,0 +1,42 @@
+// Framing.h - telemetry record framing for a lossy byte stream
+//
+// A record is a type byte, a 16-bit sequence number, a 32-bit microsecond
+// timestamp and a payload, followed by a CRC-16 of all of it. The whole
+// thing is COBS-encoded, so it contains no zero bytes, and a zero ends the
+// frame. A receiver that joins mid-stream or loses bytes resyncs at the next
+// zero, the CRC catches corruption and sequence gaps show dropped frames.
+// Multi-byte fields are little-endian. No hardware calls, so the native build
+// can check and time it.
+#ifndef FRAMING_H
+#define FRAMING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FRAME_HEADER_BYTES 7 // Type, sequence, timestamp
+#define FRAME_MAX_PAYLOAD 200
+
+// Worst-case encoded size of a record with the given payload, delimiter included
+#define FRAME_MAX_ENCODED(payload) (FRAME_HEADER_BYTES + (payload) + 2 + ((FRAME_HEADER_BYTES + (payload) + 2) / 254) + 2)
+
+// CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF
+uint16_t crc16(const uint8_t *data, size_t length, uint16_t crc = 0xFFFF);
+
+// COBS-encode length bytes into out, which needs length + length / 254 + 1
+// bytes; returns the encoded size, not counting a delimiter
+size_t cobsEncode(const uint8_t *in, size_t length, uint8_t *out);
+
+// Decode a frame without its delimiter; returns 0 if it is malformed
+size_t cobsDecode(const uint8_t *in, size_t length, uint8_t *out);
+
+// Pack 12-bit samples two to three bytes (the first sample in the low 12
+// bits); an odd count leaves the last sample in two bytes. Returns the bytes
+// written.
+size_t packSamples12(const uint16_t *samples, size_t count, uint8_t *out);
+
+// Build a complete frame, delimiter included, into out, which needs
+// FRAME_MAX_ENCODED(length) bytes. Returns the frame size.
+size_t buildFrame(uint8_t type, uint16_t sequence, uint32_t timestampUs, const uint8_t *payload, size_t length,
+                  uint8_t *out);
+
+#endif // FRAMING_H
@@ -0,0 +1,44 @@
+#include "GasSensor.h"
+#include <Arduino.h>
+#include "FixedPoint.h"
+
+GasSensor::GasSensor(uint8_t analogPin, AdcCapture &capture) : pin(analogPin), capture(capture) {}
+
+void GasSensor::begin() {
+    pinMode(pin, INPUT);
+}
+
+void GasSensor::update() {
+    uint16_t block[64];
+    size_t count;
+    while ((count = capture.read(pin, block, 64)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            total += block[i];
+        }
+        samples += count;
+        if (tap) {
+            tap(block, count);
+        }
+    }
+}
+
+GasReading GasSensor::read() {
+    // analogRead() can't share ADC1 with the DMA controller, so while capture
+    // runs the gas pin is part of its pattern and each read is an average
+    if (capture.isRunning()) {
+        update();
+        if (samples > 0) {
+            lastRaw = (total + samples / 2) / samples;
+        }
+        total = 0;
+        samples = 0;
+    } else {
+        lastRaw = analogRead(pin);
+    }
+
+    GasReading reading;
+    reading.raw = lastRaw;
+    reading.millivolts = adcToMillivolts(reading.raw);
+    reading.permille = adcToPermille(reading.raw);
+    return reading;
+}
@@ -0,0 +1,38 @@
+#ifndef GAS_SENSOR_H
+#define GAS_SENSOR_H
+
+#include <stdint.h>
+#include "AdcCapture.h"
+
+// One gas sensor sample, all integer
+struct GasReading {
+    uint16_t raw;        // 12-bit ADC value
+    uint16_t millivolts; // Sensor output voltage
+    uint16_t permille;   // Output as tenths of a percent of full scale
+};
+
+class GasSensor {
+public:
+    GasSensor(uint8_t analogPin, AdcCapture &capture);
+    void begin();
+
+    // Fold captured samples into the running average; call often enough that
+    // the capture ring never fills
+    void update();
+
+    // Also hand every captured sample to tap as update() takes it
+    void onSamples(SampleTap tap) { this->tap = tap; }
+
+    // Average of everything captured since the last read
+    GasReading read();
+
+private:
+    uint8_t pin;
+    AdcCapture &capture;
+    SampleTap tap = nullptr;
+    uint32_t total = 0;
+    uint32_t samples = 0;
+    uint16_t lastRaw = 0;
+};
+
+#endif // GAS_SENSOR_H
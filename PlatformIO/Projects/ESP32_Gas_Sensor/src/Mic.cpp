@@ -0,0 +1,45 @@
+#include "Mic.h"
+#include <string.h>
+#include "FixedPoint.h"
+
+static_assert(MIC_SAMPLE_RATE_HZ == SPECTRUM_SAMPLE_RATE_HZ, "the spectrum tables are built for the mic rate");
+
+Mic::Mic(uint8_t analogPin, AdcCapture &capture)
+    : pin(analogPin), capture(capture), meter(MIC_SAMPLE_RATE_HZ * MIC_WINDOW_MS / 1000, MIC_LEQ_WINDOWS) {
+    // Nothing measured until the first block completes
+    for (int band = 0; band < SPECTRUM_BANDS; band++) {
+        bands.bandCentiDb[band] = CENTI_DB_SILENCE;
+    }
+    bands.totalCentiDb = CENTI_DB_SILENCE;
+    bands.aWeightedCentiDb = CENTI_DB_SILENCE;
+}
+
+uint16_t Mic::update() {
+    uint16_t block[MIC_BLOCK_SAMPLES];
+    uint16_t closed = 0;
+    size_t count;
+    while ((count = capture.read(pin, block, MIC_BLOCK_SAMPLES)) > 0) {
+        closed += meter.process(block, count);
+        if (tap) {
+            tap(block, count);
+        }
+
+        // Collect whole blocks for the spectrum; at 10 kHz one completes every 51 ms
+        size_t taken = 0;
+        while (taken < count) {
+            size_t copy = SPECTRUM_SIZE - spectrumFill;
+            if (copy > count - taken) {
+                copy = count - taken;
+            }
+            memcpy(&spectrumBlock[spectrumFill], &block[taken], copy * sizeof(uint16_t));
+            spectrumFill += copy;
+            taken += copy;
+            if (spectrumFill == SPECTRUM_SIZE) {
+                spectrum.analyse(spectrumBlock, bands);
+                blocksAnalysed++;
+                spectrumFill = 0;
+            }
+        }
+    }
+    return closed;
+}
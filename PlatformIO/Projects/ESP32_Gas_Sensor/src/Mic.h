@@ -0,0 +1,44 @@
+#ifndef MIC_H
+#define MIC_H
+
+#include <stdint.h>
+#include "AdcCapture.h"
+#include "SoundMeter.h"
+#include "Spectrum.h"
+
+// Conversions per second on the mic pin, and the measurement windows
+#define MIC_SAMPLE_RATE_HZ 10000
+#define MIC_WINDOW_MS 125   // RMS/peak window ("fast" time weighting)
+#define MIC_LEQ_WINDOWS 8   // Windows per Leq value, 1 s
+#define MIC_BLOCK_SAMPLES 256
+
+class Mic {
+public:
+    Mic(uint8_t analogPin, AdcCapture &capture);
+
+    // Run everything captured since the last call through the meter;
+    // returns the number of windows that closed
+    uint16_t update();
+
+    const SoundLevel &level() const { return meter.level(); }
+
+    // Bands and dB(A) of the last full SPECTRUM_SIZE block
+    const SpectrumLevels &spectrumLevels() const { return bands; }
+    uint32_t spectrumBlocks() const { return blocksAnalysed; }
+
+    // Also hand every sample to tap as update() takes it
+    void onSamples(SampleTap tap) { this->tap = tap; }
+
+private:
+    uint8_t pin;
+    AdcCapture &capture;
+    SampleTap tap = nullptr;
+    SoundMeter meter;
+    Spectrum spectrum;
+    SpectrumLevels bands = {};
+    uint16_t spectrumBlock[SPECTRUM_SIZE];
+    uint16_t spectrumFill = 0;
+    uint32_t blocksAnalysed = 0;
+};
+
+#endif // MIC_H
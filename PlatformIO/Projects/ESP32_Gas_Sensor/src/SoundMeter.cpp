@@ -0,0 +1,95 @@
+// SoundMeter.cpp - block-processing sound level kernel
+#include "SoundMeter.h"
+#include "FixedPoint.h"
+
+SoundMeter::SoundMeter(uint32_t windowSamples, uint16_t leqWindows)
+    : windowSamples(windowSamples), leqWindows(leqWindows) {
+    reset();
+}
+
+void SoundMeter::reset() {
+    count = 0;
+    sum = 0;
+    sumSquares = 0;
+    minSample = UINT16_MAX;
+    maxSample = 0;
+    leqEnergy = 0;
+    leqSamples = 0;
+    leqCount = 0;
+    current = {CENTI_DB_SILENCE, CENTI_DB_SILENCE, CENTI_DB_SILENCE, 0, 0};
+}
+
+uint16_t SoundMeter::process(const uint16_t *samples, size_t length) {
+    uint16_t closed = 0;
+    while (length > 0) {
+        // Run the inner loop up to the end of the block or of the window
+        size_t run = windowSamples - count;
+        if (run > length) {
+            run = length;
+        }
+
+        uint32_t runSum = 0;
+        uint64_t runSquares = 0;
+        uint16_t lo = minSample;
+        uint16_t hi = maxSample;
+        for (size_t i = 0; i < run; i++) {
+            uint32_t x = samples[i];
+            runSum += x;
+            runSquares += x * x;
+            if (x < lo) {
+                lo = x;
+            }
+            if (x > hi) {
+                hi = x;
+            }
+        }
+        sum += runSum;
+        sumSquares += runSquares;
+        minSample = lo;
+        maxSample = hi;
+        count += run;
+        samples += run;
+        length -= run;
+
+        if (count == windowSamples) {
+            closeWindow();
+            closed++;
+        }
+    }
+    return closed;
+}
+
+void SoundMeter::closeWindow() {
+    // Sum of squared swings around the window mean, which drops the mic's DC bias
+    uint64_t energy = sumSquares - (uint64_t)sum * sum / count;
+    uint32_t mean = (sum + count / 2) / count;
+    uint32_t peakSwing = maxSample - mean > mean - minSample ? maxSample - mean : mean - minSample;
+
+    current.rmsCentiDb = energyToCentiDb(energy, count);
+    current.peakCentiDb = ratioToCentiDb(adcToMicrovolts(peakSwing), MIC_REFERENCE_UV);
+    current.windows++;
+
+    leqEnergy += energy;
+    leqSamples += count;
+    if (++leqCount == leqWindows) {
+        current.leqCentiDb = energyToCentiDb(leqEnergy, leqSamples);
+        current.leqPeriods++;
+        leqEnergy = 0;
+        leqSamples = 0;
+        leqCount = 0;
+    }
+
+    count = 0;
+    sum = 0;
+    sumSquares = 0;
+    minSample = UINT16_MAX;
+    maxSample = 0;
+}
+
+int32_t energyToCentiDb(uint64_t energy, uint32_t samples) {
+    // Mean square in Q16 so the root keeps 8 fractional bits of an ADC count
+    uint64_t meanSquareQ16 = energy < (1ULL << 47) ? (energy << 16) / samples : (energy / samples) << 16;
+    uint64_t rmsQ8 = isqrt64(meanSquareQ16);
+    uint32_t microvolts = (uint32_t)((rmsQ8 * UV_PER_COUNT_Q8 + 0x8000) >> 16);
+    return ratioToCentiDb(microvolts, MIC_REFERENCE_UV);
+}
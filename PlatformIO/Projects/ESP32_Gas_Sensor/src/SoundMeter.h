@@ -0,0 +1,62 @@
+// SoundMeter.h - block-processing sound level kernel
+//
+// Takes raw 12-bit microphone samples in blocks of any size and measures the
+// AC part of the signal over fixed windows: RMS and peak per window, and the
+// equivalent continuous level (Leq) over a run of windows. Integer only and
+// free of hardware calls, so the native build can feed it synthetic blocks.
+#ifndef SOUND_METER_H
+#define SOUND_METER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Microphone output voltage for 0 dB (sensor calibration)
+#define MIC_REFERENCE_UV 6310
+
+// Latest results, in hundredths of a dB against MIC_REFERENCE_UV
+struct SoundLevel {
+    int32_t rmsCentiDb;  // RMS over the last window
+    int32_t peakCentiDb; // Largest swing from the window mean in the last window
+    int32_t leqCentiDb;  // Equivalent continuous level over the last Leq period
+    uint32_t windows;    // Windows completed since reset()
+    uint32_t leqPeriods; // Leq periods completed since reset()
+};
+
+class SoundMeter {
+public:
+    // windowSamples: samples per RMS/peak window
+    // leqWindows: windows averaged into each Leq value
+    SoundMeter(uint32_t windowSamples, uint16_t leqWindows);
+    void reset();
+
+    // Feed a block of raw ADC samples; returns the number of windows it closed
+    uint16_t process(const uint16_t *samples, size_t length);
+
+    const SoundLevel &level() const { return current; }
+
+private:
+    void closeWindow();
+
+    uint32_t windowSamples;
+    uint16_t leqWindows;
+
+    // Running sums for the open window
+    uint32_t count;
+    uint32_t sum;
+    uint64_t sumSquares;
+    uint16_t minSample;
+    uint16_t maxSample;
+
+    // Running sums for the open Leq period
+    uint64_t leqEnergy;
+    uint32_t leqSamples;
+    uint16_t leqCount;
+
+    SoundLevel current;
+};
+
+// RMS of `energy` (sum of squared swings in ADC counts) over `samples`, in
+// hundredths of a dB against MIC_REFERENCE_UV
+int32_t energyToCentiDb(uint64_t energy, uint32_t samples);
+
+#endif // SOUND_METER_H
@@ -0,0 +1,267 @@
+// Spectrum.cpp - fixed-point spectral analysis of mic sample blocks
+#include "Spectrum.h"
+#include "FixedPoint.h"
+#include "SoundMeter.h"
+
+// Tables for SPECTRUM_SIZE = 512 at SPECTRUM_SAMPLE_RATE_HZ = 10 kHz
+static_assert(SPECTRUM_SIZE == 512 && SPECTRUM_SAMPLE_RATE_HZ == 10000, "regenerate the spectrum tables");
+
+// cos(2 pi k / N) and sin(2 pi k / N) in Q15, k < N/2
+static const int16_t TWIDDLE_COS[SPECTRUM_SIZE / 2] = {
+     32767,  32765,  32757,  32745,  32728,  32705,  32678,  32646,
+     32609,  32567,  32521,  32469,  32412,  32351,  32285,  32213,
+     32137,  32057,  31971,  31880,  31785,  31685,  31580,  31470,
+     31356,  31237,  31113,  30985,  30852,  30714,  30571,  30424,
+     30273,  30117,  29956,  29791,  29621,  29447,  29268,  29085,
+     28898,  28706,  28510,  28310,  28105,  27896,  27683,  27466,
+     27245,  27019,  26790,  26556,  26319,  26077,  25832,  25582,
+     25329,  25072,  24811,  24547,  24279,  24007,  23731,  23452,
+     23170,  22884,  22594,  22301,  22005,  21705,  21403,  21096,
+     20787,  20475,  20159,  19841,  19519,  19195,  18868,  18537,
+     18204,  17869,  17530,  17189,  16846,  16499,  16151,  15800,
+     15446,  15090,  14732,  14372,  14010,  13645,  13279,  12910,
+     12539,  12167,  11793,  11417,  11039,  10659,  10278,   9896,
+      9512,   9126,   8739,   8351,   7962,   7571,   7179,   6786,
+      6393,   5998,   5602,   5205,   4808,   4410,   4011,   3612,
+      3212,   2811,   2410,   2009,   1608,   1206,    804,    402,
+         0,   -402,   -804,  -1206,  -1608,  -2009,  -2410,  -2811,
+     -3212,  -3612,  -4011,  -4410,  -4808,  -5205,  -5602,  -5998,
+     -6393,  -6786,  -7179,  -7571,  -7962,  -8351,  -8739,  -9126,
+     -9512,  -9896, -10278, -10659, -11039, -11417, -11793, -12167,
+    -12539, -12910, -13279, -13645, -14010, -14372, -14732, -15090,
+    -15446, -15800, -16151, -16499, -16846, -17189, -17530, -17869,
+    -18204, -18537, -18868, -19195, -19519, -19841, -20159, -20475,
+    -20787, -21096, -21403, -21705, -22005, -22301, -22594, -22884,
+    -23170, -23452, -23731, -24007, -24279, -24547, -24811, -25072,
+    -25329, -25582, -25832, -26077, -26319, -26556, -26790, -27019,
+    -27245, -27466, -27683, -27896, -28105, -28310, -28510, -28706,
+    -28898, -29085, -29268, -29447, -29621, -29791, -29956, -30117,
+    -30273, -30424, -30571, -30714, -30852, -30985, -31113, -31237,
+    -31356, -31470, -31580, -31685, -31785, -31880, -31971, -32057,
+    -32137, -32213, -32285, -32351, -32412, -32469, -32521, -32567,
+    -32609, -32646, -32678, -32705, -32728, -32745, -32757, -32765,
+};
+
+static const int16_t TWIDDLE_SIN[SPECTRUM_SIZE / 2] = {
+         0,    402,    804,   1206,   1608,   2009,   2410,   2811,
+      3212,   3612,   4011,   4410,   4808,   5205,   5602,   5998,
+      6393,   6786,   7179,   7571,   7962,   8351,   8739,   9126,
+      9512,   9896,  10278,  10659,  11039,  11417,  11793,  12167,
+     12539,  12910,  13279,  13645,  14010,  14372,  14732,  15090,
+     15446,  15800,  16151,  16499,  16846,  17189,  17530,  17869,
+     18204,  18537,  18868,  19195,  19519,  19841,  20159,  20475,
+     20787,  21096,  21403,  21705,  22005,  22301,  22594,  22884,
+     23170,  23452,  23731,  24007,  24279,  24547,  24811,  25072,
+     25329,  25582,  25832,  26077,  26319,  26556,  26790,  27019,
+     27245,  27466,  27683,  27896,  28105,  28310,  28510,  28706,
+     28898,  29085,  29268,  29447,  29621,  29791,  29956,  30117,
+     30273,  30424,  30571,  30714,  30852,  30985,  31113,  31237,
+     31356,  31470,  31580,  31685,  31785,  31880,  31971,  32057,
+     32137,  32213,  32285,  32351,  32412,  32469,  32521,  32567,
+     32609,  32646,  32678,  32705,  32728,  32745,  32757,  32765,
+     32767,  32765,  32757,  32745,  32728,  32705,  32678,  32646,
+     32609,  32567,  32521,  32469,  32412,  32351,  32285,  32213,
+     32137,  32057,  31971,  31880,  31785,  31685,  31580,  31470,
+     31356,  31237,  31113,  30985,  30852,  30714,  30571,  30424,
+     30273,  30117,  29956,  29791,  29621,  29447,  29268,  29085,
+     28898,  28706,  28510,  28310,  28105,  27896,  27683,  27466,
+     27245,  27019,  26790,  26556,  26319,  26077,  25832,  25582,
+     25329,  25072,  24811,  24547,  24279,  24007,  23731,  23452,
+     23170,  22884,  22594,  22301,  22005,  21705,  21403,  21096,
+     20787,  20475,  20159,  19841,  19519,  19195,  18868,  18537,
+     18204,  17869,  17530,  17189,  16846,  16499,  16151,  15800,
+     15446,  15090,  14732,  14372,  14010,  13645,  13279,  12910,
+     12539,  12167,  11793,  11417,  11039,  10659,  10278,   9896,
+      9512,   9126,   8739,   8351,   7962,   7571,   7179,   6786,
+      6393,   5998,   5602,   5205,   4808,   4410,   4011,   3612,
+      3212,   2811,   2410,   2009,   1608,   1206,    804,    402,
+};
+
+// Periodic Hann window in Q15, first half plus the midpoint (it is symmetric)
+static const int16_t HANN_Q15[SPECTRUM_SIZE / 2 + 1] = {
+         0,      1,      5,     11,     20,     31,     44,     60,
+        79,    100,    123,    149,    177,    208,    241,    277,
+       315,    355,    398,    443,    491,    541,    593,    648,
+       705,    765,    827,    891,    958,   1027,   1098,   1171,
+      1247,   1325,   1406,   1488,   1573,   1660,   1749,   1841,
+      1935,   2030,   2128,   2229,   2331,   2435,   2542,   2650,
+      2761,   2874,   2989,   3105,   3224,   3345,   3468,   3592,
+      3719,   3847,   3978,   4110,   4244,   4380,   4518,   4657,
+      4799,   4942,   5086,   5233,   5381,   5531,   5682,   5835,
+      5990,   6146,   6304,   6463,   6624,   6786,   6950,   7115,
+      7281,   7449,   7618,   7789,   7961,   8134,   8308,   8484,
+      8660,   8838,   9017,   9197,   9379,   9561,   9744,   9929,
+     10114,  10300,  10487,  10675,  10864,  11054,  11244,  11436,
+     11628,  11820,  12014,  12208,  12403,  12598,  12794,  12990,
+     13187,  13385,  13583,  13781,  13980,  14179,  14378,  14578,
+     14778,  14978,  15178,  15379,  15580,  15780,  15981,  16182,
+     16383,  16585,  16786,  16987,  17187,  17388,  17589,  17789,
+     17989,  18189,  18389,  18588,  18787,  18986,  19184,  19382,
+     19580,  19777,  19973,  20169,  20364,  20559,  20753,  20947,
+     21139,  21331,  21523,  21713,  21903,  22092,  22280,  22467,
+     22653,  22838,  23023,  23206,  23388,  23570,  23750,  23929,
+     24107,  24283,  24459,  24633,  24806,  24978,  25149,  25318,
+     25486,  25652,  25817,  25981,  26143,  26304,  26463,  26621,
+     26777,  26932,  27085,  27236,  27386,  27534,  27681,  27825,
+     27968,  28110,  28249,  28387,  28523,  28657,  28789,  28920,
+     29048,  29175,  29299,  29422,  29543,  29662,  29778,  29893,
+     30006,  30117,  30225,  30332,  30436,  30538,  30639,  30737,
+     30832,  30926,  31018,  31107,  31194,  31279,  31361,  31442,
+     31520,  31596,  31669,  31740,  31809,  31876,  31940,  32002,
+     32062,  32119,  32174,  32226,  32276,  32324,  32369,  32412,
+     32452,  32490,  32526,  32559,  32590,  32618,  32644,  32667,
+     32688,  32707,  32723,  32736,  32747,  32756,  32762,  32766,
+     32767,
+};
+
+// IEC 61672 A-weighting as a power gain per bin in Q15, bins 0 to N/2 - 1
+static const uint16_t A_WEIGHT_Q15[SPECTRUM_SIZE / 2] = {
+         0,      0,     10,     59,    174,    370,    652,   1017,
+      1459,   1972,   2549,   3183,   3867,   4595,   5362,   6162,
+      6989,   7840,   8709,   9592,  10485,  11384,  12286,  13188,
+     14087,  14980,  15865,  16740,  17604,  18454,  19290,  20109,
+     20913,  21699,  22467,  23216,  23947,  24659,  25351,  26025,
+     26679,  27314,  27931,  28528,  29108,  29669,  30213,  30739,
+     31249,  31741,  32218,  32679,  33124,  33555,  33970,  34372,
+     34760,  35135,  35497,  35846,  36183,  36508,  36823,  37125,
+     37418,  37700,  37972,  38234,  38487,  38731,  38966,  39193,
+     39411,  39622,  39825,  40020,  40208,  40390,  40564,  40732,
+     40894,  41050,  41199,  41343,  41481,  41614,  41742,  41865,
+     41982,  42095,  42204,  42308,  42407,  42502,  42594,  42681,
+     42764,  42844,  42920,  42992,  43061,  43127,  43189,  43248,
+     43305,  43358,  43408,  43455,  43500,  43542,  43581,  43618,
+     43652,  43684,  43714,  43741,  43766,  43788,  43809,  43828,
+     43844,  43859,  43871,  43882,  43891,  43898,  43903,  43906,
+     43908,  43908,  43907,  43904,  43899,  43893,  43886,  43877,
+     43866,  43855,  43841,  43827,  43811,  43794,  43776,  43756,
+     43736,  43714,  43691,  43667,  43641,  43615,  43588,  43559,
+     43530,  43499,  43468,  43435,  43402,  43368,  43333,  43297,
+     43260,  43222,  43183,  43144,  43103,  43062,  43020,  42978,
+     42934,  42890,  42845,  42799,  42753,  42706,  42658,  42610,
+     42561,  42511,  42461,  42410,  42358,  42306,  42253,  42200,
+     42146,  42091,  42036,  41980,  41924,  41868,  41810,  41753,
+     41694,  41636,  41576,  41517,  41457,  41396,  41335,  41273,
+     41211,  41149,  41086,  41023,  40959,  40895,  40831,  40766,
+     40701,  40635,  40569,  40503,  40436,  40369,  40302,  40234,
+     40166,  40098,  40029,  39960,  39891,  39821,  39751,  39681,
+     39610,  39540,  39469,  39397,  39326,  39254,  39182,  39109,
+     39037,  38964,  38890,  38817,  38744,  38670,  38596,  38521,
+     38447,  38372,  38297,  38222,  38147,  38072,  37996,  37920,
+     37844,  37768,  37692,  37615,  37538,  37462,  37384,  37307,
+};
+
+// First and last bin whose centre falls inside each octave band
+static const uint16_t OCTAVE_BAND_BINS[SPECTRUM_BANDS][2] = {
+    {3, 4}, {5, 9}, {10, 18}, {19, 36}, {37, 72}, {73, 144}, {145, 255},
+};
+
+const uint16_t OCTAVE_BAND_CENTERS_HZ[SPECTRUM_BANDS] = {63, 125, 250, 500, 1000, 2000, 4000};
+
+// log10(x) in Q16.16 for 64-bit x > 0
+static int32_t log10Q16Wide(uint64_t x) {
+    int32_t shift = 0;
+    while (x > UINT32_MAX) {
+        x >>= 1;
+        shift++;
+    }
+    return log10Q16((uint32_t)x) + shift * LOG10_2_Q16;
+}
+
+int32_t hannQ15(int n) {
+    return n <= SPECTRUM_SIZE / 2 ? HANN_Q15[n] : HANN_Q15[SPECTRUM_SIZE - n];
+}
+
+void fixedFft(int32_t *re, int32_t *im) {
+    // Bit-reversal permutation
+    for (int i = 1, j = 0; i < SPECTRUM_SIZE; i++) {
+        int bit = SPECTRUM_SIZE >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            int32_t t = re[i];
+            re[i] = re[j];
+            re[j] = t;
+            t = im[i];
+            im[i] = im[j];
+            im[j] = t;
+        }
+    }
+
+    // Decimation-in-time butterflies, one twiddle load per inner loop
+    for (int size = 2; size <= SPECTRUM_SIZE; size <<= 1) {
+        int half = size >> 1;
+        int step = SPECTRUM_SIZE / size;
+        for (int k = 0; k < half; k++) {
+            int64_t wr = TWIDDLE_COS[k * step];
+            int64_t wi = -TWIDDLE_SIN[k * step];
+            for (int a = k; a < SPECTRUM_SIZE; a += size) {
+                int b = a + half;
+                int32_t tr = (int32_t)((re[b] * wr - im[b] * wi + 0x4000) >> 15);
+                int32_t ti = (int32_t)((re[b] * wi + im[b] * wr + 0x4000) >> 15);
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+Spectrum::Spectrum() {
+    // Parseval: the one-sided bin power P of a block, with samples scaled by 16
+    // and a window of summed square W (Q30), has a mean square of
+    // P * 2^14 / W counts^2. Fold that and the reference level into one offset.
+    uint64_t windowPower = 0;
+    for (int n = 0; n < SPECTRUM_SIZE; n++) {
+        int32_t w = hannQ15(n);
+        windowPower += (uint64_t)(w * w);
+    }
+    int32_t log10RefCounts = log10Q16(MIC_REFERENCE_UV) - (log10Q16(UV_PER_COUNT_Q8) - 8 * LOG10_2_Q16);
+    int64_t offsetQ16 = 1000LL * (14 * LOG10_2_Q16 - log10Q16Wide(windowPower)) - 2000LL * log10RefCounts;
+    offsetCentiDb = (int32_t)((offsetQ16 + 0x8000) >> 16);
+}
+
+int32_t Spectrum::powerToCentiDb(uint64_t power) const {
+    if (power == 0) {
+        return CENTI_DB_SILENCE;
+    }
+    return (int32_t)((1000LL * log10Q16Wide(power) + 0x8000) >> 16) + offsetCentiDb;
+}
+
+void Spectrum::analyse(const uint16_t *samples, SpectrumLevels &levels) {
+    // Remove the DC bias, scale up for headroom in the butterflies, window
+    uint32_t sum = 0;
+    for (int n = 0; n < SPECTRUM_SIZE; n++) {
+        sum += samples[n];
+    }
+    int32_t mean = (sum + SPECTRUM_SIZE / 2) / SPECTRUM_SIZE;
+    for (int n = 0; n < SPECTRUM_SIZE; n++) {
+        re[n] = (((int32_t)samples[n] - mean) * 16 * hannQ15(n)) >> 15;
+        im[n] = 0;
+    }
+
+    fixedFft(re, im);
+
+    // Bin powers into the bands, skipping DC and Nyquist
+    uint64_t total = 0;
+    uint64_t weighted = 0;
+    int band = 0;
+    uint64_t bandPower = 0;
+    for (int k = 1; k < SPECTRUM_SIZE / 2; k++) {
+        uint64_t power = (uint64_t)((int64_t)re[k] * re[k] + (int64_t)im[k] * im[k]);
+        total += power;
+        weighted += (power * A_WEIGHT_Q15[k]) >> 15;
+
+        if (band < SPECTRUM_BANDS && k >= OCTAVE_BAND_BINS[band][0]) {
+            bandPower += power;
+            if (k == OCTAVE_BAND_BINS[band][1]) {
+                levels.bandCentiDb[band++] = powerToCentiDb(bandPower);
+                bandPower = 0;
+            }
+        }
+    }
+    levels.totalCentiDb = powerToCentiDb(total);
+    levels.aWeightedCentiDb = powerToCentiDb(weighted);
+}
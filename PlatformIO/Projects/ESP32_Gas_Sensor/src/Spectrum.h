@@ -0,0 +1,49 @@
+// Spectrum.h - fixed-point spectral analysis of mic sample blocks
+//
+// Each block is Hann-windowed and run through an in-place radix-2 FFT in
+// int32 with Q15 twiddles. The bin powers are then summed into octave bands,
+// a flat total and an A-weighted total. Window, twiddle and A-weighting tables
+// are const, so they stay in flash; the working buffers take 4 KB of RAM.
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <stdint.h>
+
+#define SPECTRUM_SIZE 512 // Samples per block, power of two
+#define SPECTRUM_SAMPLE_RATE_HZ 10000 // The A-weighting and band tables are built for this rate
+#define SPECTRUM_BANDS 7
+
+// Nominal octave band centres; the top band is cut off at Nyquist
+extern const uint16_t OCTAVE_BAND_CENTERS_HZ[SPECTRUM_BANDS];
+
+// Levels of one block in hundredths of a dB against MIC_REFERENCE_UV,
+// CENTI_DB_SILENCE when there is no energy at all
+struct SpectrumLevels {
+    int32_t bandCentiDb[SPECTRUM_BANDS];
+    int32_t totalCentiDb;     // All bins except DC, unweighted
+    int32_t aWeightedCentiDb; // dB(A)
+};
+
+class Spectrum {
+public:
+    Spectrum();
+
+    // Analyse one block of SPECTRUM_SIZE raw ADC samples
+    void analyse(const uint16_t *samples, SpectrumLevels &levels);
+
+private:
+    int32_t powerToCentiDb(uint64_t power) const;
+
+    int32_t re[SPECTRUM_SIZE];
+    int32_t im[SPECTRUM_SIZE];
+    int32_t offsetCentiDb; // From summed bin power to a level against the reference
+};
+
+// In-place forward FFT of SPECTRUM_SIZE points, unscaled (the output grows by
+// up to SPECTRUM_SIZE), so inputs must stay within +-2^21
+void fixedFft(int32_t *re, int32_t *im);
+
+// Hann window coefficient n of SPECTRUM_SIZE in Q15
+int32_t hannQ15(int n);
+
+#endif // SPECTRUM_H
@@ -0,0 +1,148 @@
+// Telemetry.cpp - binary sample stream over serial
+#include "Telemetry.h"
+#include <string.h>
+#include "FixedPoint.h"
+#include "Mic.h"
+
+// The gas pin is sampled as fast as the mic, far faster than the sensor
+// responds; boxcar-average it down before sending
+#define GAS_DECIMATION 10
+#define GAS_STREAM_RATE_HZ (MIC_SAMPLE_RATE_HZ / GAS_DECIMATION)
+
+static void put16(uint8_t *&p, uint16_t value) {
+    *p++ = value & 0xFF;
+    *p++ = value >> 8;
+}
+
+static void put32(uint8_t *&p, uint32_t value) {
+    put16(p, value & 0xFFFF);
+    put16(p, value >> 16);
+}
+
+// Centi-dB in 16 bits: silence, and anything past +-327 dB, saturates
+static int16_t centiDb16(int32_t centiDb) {
+    if (centiDb == CENTI_DB_SILENCE || centiDb < -INT16_MAX) {
+        return INT16_MIN;
+    }
+    return centiDb > INT16_MAX ? INT16_MAX : (int16_t)centiDb;
+}
+
+void Telemetry::setMode(TelemetryMode mode) {
+    // Close off any text so the first frame doesn't run into it
+    if (current == TELEMETRY_OFF && mode != TELEMETRY_OFF) {
+        out.write((uint8_t)0);
+    }
+    current = mode;
+    micBlock.fill = 0;
+    gasBlock.fill = 0;
+    micIndex = 0;
+    gasIndex = 0;
+    gasSum = 0;
+    gasCount = 0;
+}
+
+bool Telemetry::send(TelemetryRecord type, const uint8_t *payload, size_t length) {
+    uint8_t frame[FRAME_MAX_ENCODED(FRAME_MAX_PAYLOAD)];
+    size_t size = buildFrame(type, sequence++, micros(), payload, length, frame);
+    if (size == 0 || out.availableForWrite() < (int)size) {
+        dropped++;
+        return false;
+    }
+    out.write(frame, size);
+    sent++;
+    return true;
+}
+
+void Telemetry::addSample(TelemetryRecord type, SampleBlock &block, uint32_t &index, uint16_t rateHz,
+                          uint16_t sample) {
+    if (block.fill == 0) {
+        block.firstIndex = index;
+    }
+    block.samples[block.fill++] = sample;
+    index++;
+    if (block.fill < TELEMETRY_BLOCK_SAMPLES) {
+        return;
+    }
+
+    uint8_t payload[7 + TELEMETRY_BLOCK_SAMPLES * 3 / 2];
+    uint8_t *p = payload;
+    put32(p, block.firstIndex);
+    put16(p, rateHz);
+    *p++ = block.fill;
+    p += packSamples12(block.samples, block.fill, p);
+    send(type, payload, p - payload);
+    block.fill = 0;
+}
+
+void Telemetry::micSamples(const uint16_t *samples, size_t count) {
+    if (current < TELEMETRY_ALL_RAW) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        addSample(TELEMETRY_MIC_SAMPLES, micBlock, micIndex, MIC_SAMPLE_RATE_HZ, samples[i]);
+    }
+}
+
+void Telemetry::gasSamples(const uint16_t *samples, size_t count) {
+    if (current < TELEMETRY_GAS_RAW) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        gasSum += samples[i];
+        if (++gasCount == GAS_DECIMATION) {
+            addSample(TELEMETRY_GAS_SAMPLES, gasBlock, gasIndex, GAS_STREAM_RATE_HZ,
+                      (gasSum + GAS_DECIMATION / 2) / GAS_DECIMATION);
+            gasSum = 0;
+            gasCount = 0;
+        }
+    }
+}
+
+void Telemetry::soundLevel(const SoundLevel &level, int32_t aWeightedCentiDb) {
+    if (current < TELEMETRY_LEVELS) {
+        return;
+    }
+    uint8_t payload[8];
+    uint8_t *p = payload;
+    put16(p, centiDb16(level.rmsCentiDb));
+    put16(p, centiDb16(level.peakCentiDb));
+    put16(p, centiDb16(level.leqCentiDb));
+    put16(p, centiDb16(aWeightedCentiDb));
+    send(TELEMETRY_SOUND_LEVEL, payload, sizeof(payload));
+}
+
+void Telemetry::spectrum(const SpectrumLevels &levels) {
+    if (current < TELEMETRY_LEVELS) {
+        return;
+    }
+    uint8_t payload[2 * SPECTRUM_BANDS];
+    uint8_t *p = payload;
+    for (int band = 0; band < SPECTRUM_BANDS; band++) {
+        put16(p, centiDb16(levels.bandCentiDb[band]));
+    }
+    send(TELEMETRY_SPECTRUM, payload, sizeof(payload));
+}
+
+void Telemetry::gasReading(const GasReading &reading) {
+    if (current < TELEMETRY_LEVELS) {
+        return;
+    }
+    uint8_t payload[6];
+    uint8_t *p = payload;
+    put16(p, reading.raw);
+    put16(p, reading.millivolts);
+    put16(p, reading.permille);
+    send(TELEMETRY_GAS_READING, payload, sizeof(payload));
+}
+
+void Telemetry::link(uint32_t micOverruns, uint32_t gasOverruns) {
+    if (current < TELEMETRY_LEVELS) {
+        return;
+    }
+    uint8_t payload[12];
+    uint8_t *p = payload;
+    put32(p, micOverruns);
+    put32(p, gasOverruns);
+    put32(p, dropped);
+    send(TELEMETRY_LINK, payload, sizeof(payload));
+}
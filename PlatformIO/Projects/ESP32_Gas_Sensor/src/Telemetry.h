@@ -0,0 +1,85 @@
+// Telemetry.h - binary sample stream over serial
+//
+// Sends framed records (see Framing.h), one record type per channel, for
+// capture with tools/telemetry_decode.py. A record that does not fit in the
+// serial TX buffer is dropped and counted rather than waited for, so a slow
+// link costs data, never sampling time.
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include "Framing.h"
+#include "GasSensor.h"
+#include "SoundMeter.h"
+#include "Spectrum.h"
+
+// TX buffer to ask for before Serial.begin(): a few frames of headroom
+#define TELEMETRY_TX_BUFFER 4096
+
+// Samples per sample record: 128 pack into 192 bytes
+#define TELEMETRY_BLOCK_SAMPLES 128
+
+// Record types and their payloads
+enum TelemetryRecord : uint8_t {
+    TELEMETRY_MIC_SAMPLES = 1, // u32 index of the first sample, u16 rate in Hz, u8 count, packed 12-bit samples
+    TELEMETRY_GAS_SAMPLES = 2, // Same, for the gas pin
+    TELEMETRY_SOUND_LEVEL = 3, // i16 RMS, peak, Leq and dB(A) in centi-dB; INT16_MIN for silence
+    TELEMETRY_SPECTRUM = 4,    // i16 per octave band in centi-dB, SPECTRUM_BANDS of them
+    TELEMETRY_GAS_READING = 5, // u16 raw, millivolts and permille
+    TELEMETRY_LINK = 6,        // u32 ADC overruns on the mic and gas pins, u32 frames dropped
+};
+
+// What to stream; each level includes the ones before it
+enum TelemetryMode : uint8_t {
+    TELEMETRY_OFF,       // Text reports instead
+    TELEMETRY_LEVELS,    // Sound levels, spectrum, gas readings and link stats: well under 1 KB/s
+    TELEMETRY_GAS_RAW,   // ...plus gas samples, averaged down to 1 kHz: about 2 KB/s, fine at 115200 baud
+    TELEMETRY_ALL_RAW,   // ...plus every mic sample at 10 kHz: about 18 KB/s, needs 230400 baud or USB
+};
+
+// Collects samples into blocks and sends records
+class Telemetry {
+public:
+    explicit Telemetry(Print &out) : out(out) {}
+
+    void setMode(TelemetryMode mode);
+    TelemetryMode mode() const { return current; }
+
+    // Sample taps: every sample in capture order, full rate
+    void micSamples(const uint16_t *samples, size_t count);
+    void gasSamples(const uint16_t *samples, size_t count);
+
+    void soundLevel(const SoundLevel &level, int32_t aWeightedCentiDb);
+    void spectrum(const SpectrumLevels &levels);
+    void gasReading(const GasReading &reading);
+    void link(uint32_t micOverruns, uint32_t gasOverruns);
+
+    uint32_t framesSent() const { return sent; }
+    uint32_t framesDropped() const { return dropped; }
+
+private:
+    // Samples waiting for a full block, and the index of the first one
+    struct SampleBlock {
+        uint16_t samples[TELEMETRY_BLOCK_SAMPLES];
+        uint8_t fill;
+        uint32_t firstIndex;
+    };
+
+    void addSample(TelemetryRecord type, SampleBlock &block, uint32_t &index, uint16_t rateHz, uint16_t sample);
+    bool send(TelemetryRecord type, const uint8_t *payload, size_t length);
+
+    Print &out;
+    TelemetryMode current = TELEMETRY_OFF;
+    uint16_t sequence = 0;
+    uint32_t sent = 0;
+    uint32_t dropped = 0;
+
+    SampleBlock micBlock = {};
+    SampleBlock gasBlock = {};
+    uint32_t micIndex = 0; // Samples seen since the mode last changed
+    uint32_t gasIndex = 0; // Decimated samples, same
+    uint32_t gasSum = 0;
+    uint8_t gasCount = 0;
+};
+
+#endif // TELEMETRY_H
@@ -1,55 +1,149 @@
 #include <Arduino.h>
+#include "AdcCapture.h"
+#include "FixedPoint.h"
+#include "GasSensor.h"
+#include "Mic.h"
+#include "Telemetry.h"
+
+#ifdef RUN_BENCHMARKS
+#include "Benchmark.h"
+#endif
 
 #define GAS_SENSOR_AO 2 // Analog pin (VP)
 #define GAS_SENSOR_DO 4 // Digital pin (not used in code)
 #define MIC_PIN 3       // Analog pin
 
+#define REPORT_INTERVAL_MS 500
+#define POLL_INTERVAL_MS 20 // Well inside the ~200 ms a capture ring holds
+#define LINK_INTERVAL_MS 1000
+
+AdcCapture adcCapture;
+GasSensor gasSensor(GAS_SENSOR_AO, adcCapture);
+Mic mic(MIC_PIN, adcCapture);
+Telemetry telemetry(Serial);
+unsigned long lastReport = 0;
+unsigned long lastLink = 0;
+uint32_t lastSpectrumBlocks = 0;
+
 // Function declarations
-float readGas();
-float getSoundLevelInDecibels();
+GasReading readGas();
+void printCentiDb(const char *label, int32_t centiDb);
+void checkCommands();
+void streamTelemetry(uint16_t windowsClosed);
+void printReport();
 
 void setup() {
+    // Room for a few frames, so a record goes out whole or not at all
+    Serial.setTxBufferSize(TELEMETRY_TX_BUFFER);
     Serial.begin(115200);
-    pinMode(GAS_SENSOR_AO, INPUT);
-    pinMode(MIC_PIN, INPUT);
+    gasSensor.begin();
+
+    // Mic and gas sensor share the ADC's continuous mode, MIC_SAMPLE_RATE_HZ each
+    const uint8_t adcPins[] = {MIC_PIN, GAS_SENSOR_AO};
+    if (!adcCapture.begin(adcPins, sizeof(adcPins), MIC_SAMPLE_RATE_HZ * sizeof(adcPins))) {
+        Serial.println("Continuous ADC failed to start");
+    }
+    mic.onSamples([](const uint16_t *samples, size_t count) { telemetry.micSamples(samples, count); });
+    gasSensor.onSamples([](const uint16_t *samples, size_t count) { telemetry.gasSamples(samples, count); });
+
+#ifdef RUN_BENCHMARKS
+    delay(2000); // Give the serial monitor time to attach
+    runBenchmarks();
+#endif
 }
 
 void loop() {
-    float gasVoltage = readGas();
-    float soundDB = getSoundLevelInDecibels();
+    checkCommands();
+    uint16_t windowsClosed = mic.update();
+    gasSensor.update();
 
-    Serial.print("Sound dB Value: ");
-    Serial.println(soundDB);
+    if (telemetry.mode() != TELEMETRY_OFF) {
+        streamTelemetry(windowsClosed);
+    } else if (millis() - lastReport >= REPORT_INTERVAL_MS) {
+        lastReport = millis();
+        printReport();
+    }
 
-    delay(500);
+    delay(POLL_INTERVAL_MS);
 }
 
 // Function definitions
-float readGas() {
-    // Read analog value
-    int sensorValue = analogRead(GAS_SENSOR_AO);
-    float voltage = sensorValue * (3.3 / 4095.0); // Convert ADC to voltage
-    float percentage = (voltage / 3.3) * 100;     // Convert voltage to percentage
+void checkCommands() {
+    // One character each: t(ext), l(evels), g(as raw), r(aw, everything)
+    while (Serial.available() > 0) {
+        switch (Serial.read()) {
+        case 't':
+            telemetry.setMode(TELEMETRY_OFF);
+            break;
+        case 'l':
+            telemetry.setMode(TELEMETRY_LEVELS);
+            break;
+        case 'g':
+            telemetry.setMode(TELEMETRY_GAS_RAW);
+            break;
+        case 'r':
+            telemetry.setMode(TELEMETRY_ALL_RAW);
+            break;
+        }
+    }
+}
 
-    Serial.print("Gas Analog Value: ");
-    Serial.print(sensorValue);
-    Serial.print(" | Gas Voltage: ");
-    Serial.print(voltage);
-    Serial.print(" | Gas Percentage: ");
-    Serial.println(percentage);
+void streamTelemetry(uint16_t windowsClosed) {
+    // Samples went out through the taps; send what was computed from them
+    if (windowsClosed > 0) {
+        telemetry.soundLevel(mic.level(), mic.spectrumLevels().aWeightedCentiDb);
+    }
+    if (mic.spectrumBlocks() != lastSpectrumBlocks) {
+        lastSpectrumBlocks = mic.spectrumBlocks();
+        telemetry.spectrum(mic.spectrumLevels());
+    }
+    if (millis() - lastReport >= REPORT_INTERVAL_MS) {
+        lastReport = millis();
+        telemetry.gasReading(gasSensor.read());
+    }
+    if (millis() - lastLink >= LINK_INTERVAL_MS) {
+        lastLink = millis();
+        telemetry.link(adcCapture.overruns(MIC_PIN), adcCapture.overruns(GAS_SENSOR_AO));
+    }
+}
+
+void printReport() {
+    readGas();
+
+    const SoundLevel &sound = mic.level();
+    printCentiDb("Sound dB RMS: ", sound.rmsCentiDb);
+    printCentiDb(" | Peak: ", sound.peakCentiDb);
+    printCentiDb(" | Leq: ", sound.leqCentiDb);
+    printCentiDb(" | dB(A): ", mic.spectrumLevels().aWeightedCentiDb);
+    Serial.printf(" | Dropped: %lu\n", (unsigned long)adcCapture.overruns(MIC_PIN));
 
-    return voltage;
+    Serial.print("Octave bands:");
+    for (int band = 0; band < SPECTRUM_BANDS; band++) {
+        Serial.printf(" %uHz ", OCTAVE_BAND_CENTERS_HZ[band]);
+        printCentiDb("", mic.spectrumLevels().bandCentiDb[band]);
+    }
+    Serial.println();
 }
 
-float getSoundLevelInDecibels() {
-    // Read the raw analog value from the microphone
-    int rawValue = analogRead(MIC_PIN);
+GasReading readGas() {
+    // Average since the last report, converted with integer math only
+    GasReading reading = gasSensor.read();
 
-    // Convert the raw value to voltage (assuming 3.3V ADC reference on ESP32)
-    float voltage = (rawValue / 4095.0) * 3.3;
+    Serial.print("Gas Analog Value: ");
+    Serial.print(reading.raw);
+    Serial.printf(" | Gas Voltage: %u.%02u", reading.millivolts / 1000, (reading.millivolts % 1000) / 10);
+    Serial.printf(" | Gas Percentage: %u.%u\n", reading.permille / 10, reading.permille % 10);
 
-    // Convert the voltage to decibels (example conversion, adjust based on sensor calibration)
-    float decibels = 20 * log10(voltage / 0.00631); // 0.00631 is a reference voltage for 0 dB
+    return reading;
+}
 
-    return decibels;
-}
\ No newline at end of file
+void printCentiDb(const char *label, int32_t centiDb) {
+    // Levels are in hundredths of a dB (see SoundMeter.h for calibration)
+    Serial.print(label);
+    if (centiDb == CENTI_DB_SILENCE) {
+        Serial.print("-inf");
+    } else {
+        int32_t magnitude = abs(centiDb);
+        Serial.printf("%s%ld.%02ld", centiDb < 0 ? "-" : "", (long)(magnitude / 100), (long)(magnitude % 100));
+    }
+}
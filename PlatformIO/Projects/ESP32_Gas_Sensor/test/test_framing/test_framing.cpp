@@ -0,0 +1,95 @@
+// Telemetry framing: the CRC-16 check value, records of every payload length
+// back through COBS intact, and the 12-bit sample packing
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+#include "Framing.h"
+
+static uint8_t payload[FRAME_MAX_PAYLOAD];
+
+// Frame the payload, then check the frame has its only zero at the end and
+// decodes back to the header, payload and a matching CRC
+static void checkRoundTrip(size_t length) {
+    uint8_t frame[FRAME_MAX_ENCODED(FRAME_MAX_PAYLOAD)];
+    uint8_t record[FRAME_HEADER_BYTES + FRAME_MAX_PAYLOAD + 2];
+    size_t size = buildFrame(7, 0xBEEF, 0x12345678, payload, length, frame);
+    TEST_ASSERT_GREATER_THAN(0, size);
+    TEST_ASSERT_LESS_OR_EQUAL(FRAME_MAX_ENCODED(length), size);
+    TEST_ASSERT_EQUAL_UINT8(0, frame[size - 1]);
+    TEST_ASSERT_NULL(memchr(frame, 0, size - 1));
+
+    size_t decoded = cobsDecode(frame, size - 1, record);
+    TEST_ASSERT_EQUAL(FRAME_HEADER_BYTES + length + 2, decoded);
+    TEST_ASSERT_EQUAL_HEX16(crc16(record, decoded - 2), record[decoded - 2] | record[decoded - 1] << 8);
+    const uint8_t header[FRAME_HEADER_BYTES] = {7, 0xEF, 0xBE, 0x78, 0x56, 0x34, 0x12};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(header, record, FRAME_HEADER_BYTES);
+    if (length > 0) {
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(payload, &record[FRAME_HEADER_BYTES], length);
+    }
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+// CRC-16/CCITT-FALSE check value
+void test_crc16_check_value() {
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, crc16((const uint8_t *)"123456789", 9));
+}
+
+// All-zero and all-0xFF payloads exercise the 254-byte COBS code blocks
+void test_round_trip_zeros() {
+    for (size_t length = 0; length <= FRAME_MAX_PAYLOAD; length++) {
+        memset(payload, 0, length);
+        checkRoundTrip(length);
+    }
+}
+
+void test_round_trip_ones() {
+    for (size_t length = 0; length <= FRAME_MAX_PAYLOAD; length++) {
+        memset(payload, 0xFF, length);
+        checkRoundTrip(length);
+    }
+}
+
+void test_round_trip_mixed() {
+    srand(1);
+    for (size_t length = 0; length <= FRAME_MAX_PAYLOAD; length++) {
+        for (size_t i = 0; i < length; i++) {
+            payload[i] = (i * 37 + length) % 5 == 0 ? 0 : (uint8_t)rand();
+        }
+        checkRoundTrip(length);
+    }
+}
+
+// A frame cut short or with a code byte pointing past its end is malformed
+void test_decode_rejects_truncated() {
+    uint8_t frame[FRAME_MAX_ENCODED(FRAME_MAX_PAYLOAD)];
+    uint8_t record[FRAME_HEADER_BYTES + FRAME_MAX_PAYLOAD + 2];
+    memset(payload, 0x55, 20);
+    size_t size = buildFrame(1, 1, 1, payload, 20, frame);
+    TEST_ASSERT_EQUAL(0, cobsDecode(frame, size - 5, record));
+}
+
+// Two samples to three bytes, the first in the low 12 bits; the odd one out
+// takes two
+void test_pack_samples12() {
+    const uint16_t samples[5] = {0x000, 0xFFF, 0x123, 0xABC, 0x800};
+    const uint8_t expected[8] = {0x00, 0xF0, 0xFF, 0x23, 0xC1, 0xAB, 0x00, 0x08};
+    uint8_t packed[8];
+    TEST_ASSERT_EQUAL(8, packSamples12(samples, 5, packed));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, packed, 8);
+}
+
+int main(int, char **) {
+    UNITY_BEGIN();
+    RUN_TEST(test_crc16_check_value);
+    RUN_TEST(test_round_trip_zeros);
+    RUN_TEST(test_round_trip_ones);
+    RUN_TEST(test_round_trip_mixed);
+    RUN_TEST(test_decode_rejects_truncated);
+    RUN_TEST(test_pack_samples12);
+    return UNITY_END();
+}
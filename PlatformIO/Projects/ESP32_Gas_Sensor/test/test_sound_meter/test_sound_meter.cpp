@@ -0,0 +1,137 @@
+// SoundMeter on synthetic blocks: every window's RMS and peak, and the Leq,
+// against a double precision reference from the same samples, fed in blocks
+// that straddle the window boundaries
+#include <math.h>
+#include <unity.h>
+#include "FixedPoint.h"
+#include "SoundMeter.h"
+
+// 8 windows of 125 ms at 10 kHz around a 1.9 V bias
+#define SYNTH_WINDOW 1250
+#define SYNTH_WINDOWS 8
+#define SYNTH_SAMPLES (SYNTH_WINDOW * SYNTH_WINDOWS)
+#define SYNTH_RATE_HZ 10000
+#define SYNTH_BIAS 2360
+#define SYNTH_BLOCK 173 // Odd size so blocks straddle window boundaries
+
+#define MAX_ERROR_DB 0.05f
+
+static uint16_t synth[SYNTH_SAMPLES];
+
+enum SynthShape { SYNTH_SILENCE, SYNTH_SINE, SYNTH_SQUARE, SYNTH_LOUD_THEN_QUIET };
+
+static void makeSignal(SynthShape shape, float amplitude) {
+    for (int i = 0; i < SYNTH_SAMPLES; i++) {
+        float phase = 2 * (float)M_PI * 440 * i / SYNTH_RATE_HZ;
+        float x = 0;
+        switch (shape) {
+        case SYNTH_SILENCE:
+            break;
+        case SYNTH_SINE:
+            x = amplitude * sinf(phase);
+            break;
+        case SYNTH_SQUARE:
+            x = sinf(phase) >= 0 ? amplitude : -amplitude;
+            break;
+        case SYNTH_LOUD_THEN_QUIET:
+            x = (i < SYNTH_SAMPLES / 2 ? amplitude : amplitude / 10) * sinf(phase);
+            break;
+        }
+        synth[i] = (uint16_t)lroundf(SYNTH_BIAS + x);
+    }
+}
+
+// Float reference: dB of an RMS or peak value in ADC counts
+static double countsToDb(double counts) {
+    return 20 * log10(counts * (3.3 / 4095.0) / (MIC_REFERENCE_UV / 1e6));
+}
+
+// Feed the signal in odd-sized blocks and check every window as it closes,
+// then the Leq over all of them
+static void checkSoundMeter(SynthShape shape, float amplitude) {
+    makeSignal(shape, amplitude);
+    SoundMeter meter(SYNTH_WINDOW, SYNTH_WINDOWS);
+
+    double leqEnergy = 0;
+    int window = 0;
+    for (int offset = 0; offset < SYNTH_SAMPLES; offset += SYNTH_BLOCK) {
+        int length = SYNTH_SAMPLES - offset < SYNTH_BLOCK ? SYNTH_SAMPLES - offset : SYNTH_BLOCK;
+        int closed = meter.process(&synth[offset], length);
+        // Blocks are shorter than a window, so level() holds the one closed
+        TEST_ASSERT_LESS_OR_EQUAL(1, closed);
+        if (closed == 0) {
+            continue;
+        }
+
+        const uint16_t *w = &synth[window * SYNTH_WINDOW];
+        double mean = 0;
+        for (int i = 0; i < SYNTH_WINDOW; i++) {
+            mean += w[i];
+        }
+        mean /= SYNTH_WINDOW;
+        double energy = 0;
+        double peak = 0;
+        for (int i = 0; i < SYNTH_WINDOW; i++) {
+            energy += (w[i] - mean) * (w[i] - mean);
+            peak = fmax(peak, fabs(w[i] - lround(mean)));
+        }
+        leqEnergy += energy;
+        window++;
+
+        TEST_ASSERT_EQUAL_UINT32(window, meter.level().windows);
+        TEST_ASSERT_FLOAT_WITHIN(MAX_ERROR_DB, countsToDb(sqrt(energy / SYNTH_WINDOW)),
+                                 meter.level().rmsCentiDb / 100.0f);
+        TEST_ASSERT_FLOAT_WITHIN(MAX_ERROR_DB, countsToDb(peak), meter.level().peakCentiDb / 100.0f);
+    }
+
+    TEST_ASSERT_EQUAL(SYNTH_WINDOWS, window);
+    TEST_ASSERT_EQUAL_UINT32(1, meter.level().leqPeriods);
+    TEST_ASSERT_FLOAT_WITHIN(MAX_ERROR_DB, countsToDb(sqrt(leqEnergy / SYNTH_SAMPLES)),
+                             meter.level().leqCentiDb / 100.0f);
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_silence() {
+    makeSignal(SYNTH_SILENCE, 0);
+    SoundMeter meter(SYNTH_WINDOW, SYNTH_WINDOWS);
+    for (int offset = 0; offset < SYNTH_SAMPLES; offset += SYNTH_WINDOW) {
+        meter.process(&synth[offset], SYNTH_WINDOW);
+    }
+    TEST_ASSERT_EQUAL_UINT32(SYNTH_WINDOWS, meter.level().windows);
+    TEST_ASSERT_EQUAL_INT32(CENTI_DB_SILENCE, meter.level().rmsCentiDb);
+    TEST_ASSERT_EQUAL_INT32(CENTI_DB_SILENCE, meter.level().peakCentiDb);
+    TEST_ASSERT_EQUAL_INT32(CENTI_DB_SILENCE, meter.level().leqCentiDb);
+}
+
+void test_loud_sine() {
+    checkSoundMeter(SYNTH_SINE, 500);
+}
+
+// A swing of a few counts, down where rounding in the integer sums shows first
+void test_quiet_sine() {
+    checkSoundMeter(SYNTH_SINE, 5);
+}
+
+void test_square() {
+    checkSoundMeter(SYNTH_SQUARE, 200);
+}
+
+// The Leq follows the energy, not the average of the window levels
+void test_loud_then_quiet() {
+    checkSoundMeter(SYNTH_LOUD_THEN_QUIET, 1000);
+}
+
+int main(int, char **) {
+    UNITY_BEGIN();
+    RUN_TEST(test_silence);
+    RUN_TEST(test_loud_sine);
+    RUN_TEST(test_quiet_sine);
+    RUN_TEST(test_square);
+    RUN_TEST(test_loud_then_quiet);
+    return UNITY_END();
+}
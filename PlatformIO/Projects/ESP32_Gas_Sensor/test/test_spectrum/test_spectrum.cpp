@@ -0,0 +1,221 @@
+// Spectrum: fixedFft() against a double precision FFT of the same integer
+// input, and the band, total and dB(A) levels of analyse() against the whole
+// analysis redone in double precision from the raw samples
+#include <math.h>
+#include <stdlib.h>
+#include <unity.h>
+#include "FixedPoint.h"
+#include "SoundMeter.h"
+#include "Spectrum.h"
+
+#define SYNTH_BIAS 2360 // 1.9 V mic bias
+
+#define MIN_FFT_SNR_DB 70
+#define MAX_LEVEL_ERROR_DB 0.2f
+
+// Double precision reference for fixedFft(), same layout and sign convention
+static double refRe[SPECTRUM_SIZE];
+static double refIm[SPECTRUM_SIZE];
+static int32_t fftRe[SPECTRUM_SIZE];
+static int32_t fftIm[SPECTRUM_SIZE];
+static uint16_t samples[SPECTRUM_SIZE];
+
+static void referenceFft(double *re, double *im) {
+    for (int i = 1, j = 0; i < SPECTRUM_SIZE; i++) {
+        int bit = SPECTRUM_SIZE >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            double t = re[i];
+            re[i] = re[j];
+            re[j] = t;
+            t = im[i];
+            im[i] = im[j];
+            im[j] = t;
+        }
+    }
+    for (int size = 2; size <= SPECTRUM_SIZE; size <<= 1) {
+        int half = size >> 1;
+        for (int k = 0; k < half; k++) {
+            double wr = cos(2 * M_PI * k / size);
+            double wi = -sin(2 * M_PI * k / size);
+            for (int a = k; a < SPECTRUM_SIZE; a += size) {
+                int b = a + half;
+                double tr = re[b] * wr - im[b] * wi;
+                double ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+// SNR of fixedFft() against the reference on the same integer input, in dB
+static float fftSnr(void (*fill)(int32_t *)) {
+    fill(fftRe);
+    for (int n = 0; n < SPECTRUM_SIZE; n++) {
+        fftIm[n] = 0;
+        refRe[n] = fftRe[n];
+        refIm[n] = 0;
+    }
+    fixedFft(fftRe, fftIm);
+    referenceFft(refRe, refIm);
+
+    double signal = 0;
+    double noise = 0;
+    for (int k = 0; k < SPECTRUM_SIZE; k++) {
+        signal += refRe[k] * refRe[k] + refIm[k] * refIm[k];
+        noise += (fftRe[k] - refRe[k]) * (fftRe[k] - refRe[k]) + (fftIm[k] - refIm[k]) * (fftIm[k] - refIm[k]);
+    }
+    return noise > 0 ? 10 * log10(signal / noise) : INFINITY;
+}
+
+// FFT inputs at the scale analyse() feeds it: windowed swings times 16
+static void fillTones(int32_t *x) {
+    for (int n = 0; n < SPECTRUM_SIZE; n++) {
+        double v = 1500 * sin(2 * M_PI * 1000 * n / SPECTRUM_SAMPLE_RATE_HZ) +
+                   40 * sin(2 * M_PI * 3150 * n / SPECTRUM_SAMPLE_RATE_HZ);
+        x[n] = (int32_t)lround(v * 16 * hannQ15(n) / 32768);
+    }
+}
+
+static void fillNoise(int32_t *x) {
+    srand(1);
+    for (int n = 0; n < SPECTRUM_SIZE; n++) {
+        x[n] = (rand() % 4096 - 2048) * 16;
+    }
+}
+
+static void fillQuietTone(int32_t *x) {
+    for (int n = 0; n < SPECTRUM_SIZE; n++) {
+        x[n] = (int32_t)lround(3 * 16 * sin(2 * M_PI * 440 * n / SPECTRUM_SAMPLE_RATE_HZ) * hannQ15(n) / 32768);
+    }
+}
+
+// IEC 61672 A-weighting power gain at f
+static double aWeightPower(double f) {
+    double f2 = f * f;
+    double ra = 12194.0 * 12194.0 * f2 * f2 /
+                ((f2 + 20.6 * 20.6) * sqrt((f2 + 107.7 * 107.7) * (f2 + 737.9 * 737.9)) * (f2 + 12194.0 * 12194.0));
+    return ra * ra * pow(10, 0.2);
+}
+
+// Spectrum::analyse() redone in double precision from the raw samples
+static void referenceLevels(const uint16_t *samples, double *bands, double &total, double &weighted) {
+    double mean = 0;
+    double windowPower = 0;
+    for (int n = 0; n < SPECTRUM_SIZE; n++) {
+        mean += samples[n];
+    }
+    mean /= SPECTRUM_SIZE;
+    for (int n = 0; n < SPECTRUM_SIZE; n++) {
+        double w = 0.5 * (1 - cos(2 * M_PI * n / SPECTRUM_SIZE));
+        refRe[n] = (samples[n] - mean) * w;
+        refIm[n] = 0;
+        windowPower += w * w;
+    }
+    referenceFft(refRe, refIm);
+
+    double refCounts = MIC_REFERENCE_UV / (3.3e6 / 4095);
+    double bandPower[SPECTRUM_BANDS] = {};
+    double sum = 0;
+    double sumA = 0;
+    for (int k = 1; k < SPECTRUM_SIZE / 2; k++) {
+        double f = (double)k * SPECTRUM_SAMPLE_RATE_HZ / SPECTRUM_SIZE;
+        double power = refRe[k] * refRe[k] + refIm[k] * refIm[k];
+        sum += power;
+        sumA += power * aWeightPower(f);
+        for (int b = 0; b < SPECTRUM_BANDS; b++) {
+            double centre = 1000 * pow(2, b - 4);
+            if (f >= centre / M_SQRT2 && f < centre * M_SQRT2) {
+                bandPower[b] += power;
+            }
+        }
+    }
+    // One-sided power back to a mean square in counts: 2 P / (N W)
+    double scale = 2 / (SPECTRUM_SIZE * windowPower) / (refCounts * refCounts);
+    for (int b = 0; b < SPECTRUM_BANDS; b++) {
+        bands[b] = 10 * log10(bandPower[b] * scale);
+    }
+    total = 10 * log10(sum * scale);
+    weighted = 10 * log10(sumA * scale);
+}
+
+// A sine around the mic bias, with uniform noise of up to +-noise counts
+static void checkLevels(float frequency, float amplitude, int noise) {
+    srand(2);
+    for (int n = 0; n < SPECTRUM_SIZE; n++) {
+        float x = amplitude * sinf(2 * (float)M_PI * frequency * n / SPECTRUM_SAMPLE_RATE_HZ);
+        samples[n] = (uint16_t)lroundf(SYNTH_BIAS + x + (noise ? rand() % (2 * noise + 1) - noise : 0));
+    }
+
+    static Spectrum spectrum;
+    SpectrumLevels levels;
+    double bands[SPECTRUM_BANDS];
+    double total;
+    double weighted;
+    spectrum.analyse(samples, levels);
+    referenceLevels(samples, bands, total, weighted);
+
+    TEST_ASSERT_FLOAT_WITHIN(MAX_LEVEL_ERROR_DB, total, levels.totalCentiDb / 100.0f);
+    TEST_ASSERT_FLOAT_WITHIN(MAX_LEVEL_ERROR_DB, weighted, levels.aWeightedCentiDb / 100.0f);
+    // Bands more than 40 dB below the total are down in the FFT rounding noise
+    for (int b = 0; b < SPECTRUM_BANDS; b++) {
+        if (bands[b] > total - 40) {
+            TEST_ASSERT_FLOAT_WITHIN(MAX_LEVEL_ERROR_DB, bands[b], levels.bandCentiDb[b] / 100.0f);
+        }
+    }
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_fft_snr_tones() {
+    TEST_ASSERT_TRUE(fftSnr(fillTones) >= MIN_FFT_SNR_DB);
+}
+
+void test_fft_snr_full_scale_noise() {
+    TEST_ASSERT_TRUE(fftSnr(fillNoise) >= MIN_FFT_SNR_DB);
+}
+
+// A 3-count swing is mostly rounding, so only a lower floor holds
+void test_fft_snr_quiet_tone() {
+    TEST_ASSERT_TRUE(fftSnr(fillQuietTone) >= 35);
+}
+
+void test_levels_1khz() {
+    checkLevels(1000, 500, 0);
+}
+
+// Far down the A-weighting curve
+void test_levels_100hz() {
+    checkLevels(100, 500, 0);
+}
+
+void test_levels_quiet_3150hz() {
+    checkLevels(3150, 20, 0);
+}
+
+// Spread over every band
+void test_levels_noise() {
+    checkLevels(0, 0, 400);
+}
+
+int main(int, char **) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fft_snr_tones);
+    RUN_TEST(test_fft_snr_full_scale_noise);
+    RUN_TEST(test_fft_snr_quiet_tone);
+    RUN_TEST(test_levels_1khz);
+    RUN_TEST(test_levels_100hz);
+    RUN_TEST(test_levels_quiet_3150hz);
+    RUN_TEST(test_levels_noise);
+    return UNITY_END();
+}
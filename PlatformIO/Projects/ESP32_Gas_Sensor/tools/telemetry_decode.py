@@ -0,0 +1,200 @@
+#!/usr/bin/env python3
+"""Decode the binary telemetry the firmware streams after an 'l', 'g' or 'r'
+on the serial port.
+
+Reads a serial capture (a file, or stdin), checks every frame and writes one
+CSV per record type into an output directory, plus Parquet files when pandas
+and pyarrow are installed. Prints how many frames arrived, how many failed
+their CRC and how many the sequence numbers say went missing.
+
+    pio device monitor --raw > capture.bin   # send 'g', wait, Ctrl-C
+    tools/telemetry_decode.py capture.bin -o capture/
+
+Frame layout (src/Framing.h): COBS-encoded, ended by a zero byte, holding
+u8 type, u16 sequence, u32 time in us, payload, CRC-16/CCITT-FALSE, all
+little-endian. Payloads are listed in src/Telemetry.h. Sample rows are timed
+by their index from when streaming started, everything else by device time.
+"""
+
+import argparse
+import csv
+import os
+import struct
+import sys
+
+HEADER = struct.Struct("<BHI")  # type, sequence, time in us
+CRC = struct.Struct("<H")
+SILENCE = -32768  # INT16_MIN, CENTI_DB_SILENCE squeezed into 16 bits
+SPECTRUM_BANDS = 7
+OCTAVE_BAND_CENTERS_HZ = [63, 125, 250, 500, 1000, 2000, 4000]
+
+MIC_SAMPLES, GAS_SAMPLES, SOUND_LEVEL, SPECTRUM, GAS_READING, LINK = range(1, 7)
+RECORD_NAMES = {
+    MIC_SAMPLES: "mic_samples",
+    GAS_SAMPLES: "gas_samples",
+    SOUND_LEVEL: "sound_level",
+    SPECTRUM: "spectrum",
+    GAS_READING: "gas_reading",
+    LINK: "link",
+}
+
+
+def crc16(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    """Decoded bytes, or None if the encoding is broken."""
+    out = bytearray()
+    pos = 0
+    while pos < len(data):
+        code = data[pos]
+        pos += 1
+        if code == 0 or pos + code - 1 > len(data):
+            return None
+        out += data[pos:pos + code - 1]
+        pos += code - 1
+        if code < 0xFF and pos < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def unpack_samples12(data, count):
+    samples = []
+    for i in range(0, count - 1, 2):
+        a, b, c = data[3 * (i // 2):3 * (i // 2) + 3]
+        samples.append(a | (b & 0x0F) << 8)
+        samples.append(b >> 4 | c << 4)
+    if count % 2:
+        a, b = data[3 * (count // 2):3 * (count // 2) + 2]
+        samples.append(a | (b & 0x0F) << 8)
+    return samples
+
+
+def centi_db(value):
+    return None if value == SILENCE else value / 100.0
+
+
+class TelemetryDecoder:
+    """Turns a byte stream into rows per record type. Feed it bytes as they
+    arrive; rows collect in self.rows, keyed by record name."""
+
+    def __init__(self):
+        self.rows = {name: [] for name in RECORD_NAMES.values()}
+        self.buffer = bytearray()
+        self.frames = 0
+        self.bad_frames = 0
+        self.unknown = 0
+        self.missing = 0
+        self.last_sequence = None
+        self.time_base = 0
+        self.last_time = None
+
+    def feed(self, data):
+        self.buffer += data
+        while True:
+            end = self.buffer.find(0)
+            if end < 0:
+                return
+            chunk = bytes(self.buffer[:end])
+            del self.buffer[:end + 1]
+            if chunk:
+                self._frame(chunk)
+
+    def _frame(self, chunk):
+        record = cobs_decode(chunk)
+        if record is None or len(record) < HEADER.size + CRC.size or \
+                crc16(record[:-CRC.size]) != CRC.unpack_from(record, len(record) - CRC.size)[0]:
+            # Also what text printed before streaming started looks like
+            self.bad_frames += 1
+            return
+        self.frames += 1
+        record_type, sequence, time_us = HEADER.unpack_from(record)
+        payload = record[HEADER.size:-CRC.size]
+
+        if self.last_sequence is not None:
+            self.missing += (sequence - self.last_sequence - 1) & 0xFFFF
+        self.last_sequence = sequence
+        # The device clock wraps every 71 minutes
+        if self.last_time is not None and time_us < self.last_time:
+            self.time_base += 1 << 32
+        self.last_time = time_us
+        seconds = (self.time_base + time_us) / 1e6
+
+        name = RECORD_NAMES.get(record_type)
+        if name is None:
+            self.unknown += 1
+            return
+        rows = self.rows[name]
+        if record_type in (MIC_SAMPLES, GAS_SAMPLES):
+            first, rate, count = struct.unpack_from("<IHB", payload)
+            for i, sample in enumerate(unpack_samples12(payload[7:], count)):
+                rows.append({"index": first + i, "seconds": (first + i) / rate, "raw": sample})
+        elif record_type == SOUND_LEVEL:
+            rms, peak, leq, weighted = struct.unpack_from("<4h", payload)
+            rows.append({"seconds": seconds, "rms_db": centi_db(rms), "peak_db": centi_db(peak),
+                         "leq_db": centi_db(leq), "dba": centi_db(weighted)})
+        elif record_type == SPECTRUM:
+            bands = struct.unpack_from("<%dh" % SPECTRUM_BANDS, payload)
+            row = {"seconds": seconds}
+            for centre, level in zip(OCTAVE_BAND_CENTERS_HZ, bands):
+                row["band_%d_hz_db" % centre] = centi_db(level)
+            rows.append(row)
+        elif record_type == GAS_READING:
+            raw, millivolts, permille = struct.unpack_from("<3H", payload)
+            rows.append({"seconds": seconds, "raw": raw, "millivolts": millivolts, "percent": permille / 10.0})
+        else:
+            mic, gas, dropped = struct.unpack_from("<3I", payload)
+            rows.append({"seconds": seconds, "mic_overruns": mic, "gas_overruns": gas,
+                         "frames_dropped": dropped})
+
+
+def write_tables(rows, directory):
+    os.makedirs(directory, exist_ok=True)
+    try:
+        import pandas
+    except ImportError:
+        pandas = None
+    for name, table in rows.items():
+        if not table:
+            continue
+        with open(os.path.join(directory, name + ".csv"), "w", newline="") as f:
+            writer = csv.DictWriter(f, fieldnames=list(table[0]))
+            writer.writeheader()
+            writer.writerows(table)
+        if pandas is not None:
+            try:
+                pandas.DataFrame(table).to_parquet(os.path.join(directory, name + ".parquet"))
+            except ImportError:
+                pandas = None  # No parquet engine
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("capture", nargs="?", help="serial capture, stdin if omitted")
+    parser.add_argument("-o", "--output", default="telemetry", help="directory for the tables")
+    args = parser.parse_args()
+
+    decoder = TelemetryDecoder()
+    source = open(args.capture, "rb") if args.capture else sys.stdin.buffer
+    with source:
+        while True:
+            data = source.read(65536)
+            if not data:
+                break
+            decoder.feed(data)
+    write_tables(decoder.rows, args.output)
+
+    print("%d frames, %d failed CRC or framing, %d missing by sequence, %d of unknown type" %
+          (decoder.frames, decoder.bad_frames, decoder.missing, decoder.unknown))
+    for name, table in decoder.rows.items():
+        if table:
+            print("  %-12s %d rows" % (name, len(table)))
+
+
+if __name__ == "__main__":
+    main()
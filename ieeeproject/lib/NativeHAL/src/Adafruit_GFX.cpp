@@ -0,0 +1,49 @@
+// Adafruit_GFX.cpp - host stand-in for the Adafruit GFX text renderer
+#include "Adafruit_GFX.h"
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    for (int16_t i = x; i < x + w; i++)
+        for (int16_t j = y; j < y + h; j++)
+            drawPixel(i, j, color);
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size)
+{
+    for (int8_t i = 0; i < 5; i++)
+    {
+        // 7 rows per column, never blank for printable characters
+        uint8_t line = c == ' ' ? 0 : (uint8_t)(((c * 0x9E3779B1u) >> (i * 5)) | (1 << (i % 7))) & 0x7F;
+        for (int8_t j = 0; j < 8; j++, line >>= 1)
+        {
+            if ((line & 1) && size == 1)
+                drawPixel(x + i, y + j, color);
+            else if (line & 1)
+                fillRect(x + i * size, y + j * size, size, size, color);
+            else if (bg != color)
+                fillRect(x + i * size, y + j * size, size, size, bg);
+        }
+    }
+    if (bg != color)
+        fillRect(x + 5 * size, y, size, 8 * size, bg);
+}
+
+size_t Adafruit_GFX::write(uint8_t c)
+{
+    if (c == '\n')
+    {
+        cursor_x = 0;
+        cursor_y += textsize_y * 8;
+    }
+    else if (c != '\r')
+    {
+        if (wrap && (cursor_x + textsize_x * 6) > _width)
+        {
+            cursor_x = 0;
+            cursor_y += textsize_y * 8;
+        }
+        drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x);
+        cursor_x += textsize_x * 6;
+    }
+    return 1;
+}
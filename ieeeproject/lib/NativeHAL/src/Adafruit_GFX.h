@@ -0,0 +1,56 @@
+// Adafruit_GFX.h - host stand-in for the Adafruit GFX text renderer
+#ifndef NATIVE_ADAFRUIT_GFX_H
+#define NATIVE_ADAFRUIT_GFX_H
+
+#include <Arduino.h>
+
+// Text is laid out on the same 6x8 cell grid as the classic GFX font, so
+// cursor movement and wrapping match the device. The glyph bitmaps are
+// synthesised from the character code rather than copied from the real font:
+// distinct characters give distinct pixels, which is all the host needs.
+class Adafruit_GFX : public Print
+{
+protected:
+    int16_t _width;
+    int16_t _height;
+    int16_t cursor_x = 0;
+    int16_t cursor_y = 0;
+    uint16_t textcolor = 1;
+    uint16_t textbgcolor = 1;
+    uint8_t textsize_x = 1;
+    uint8_t textsize_y = 1;
+    bool wrap = true;
+
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+
+public:
+    Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    virtual void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+
+    void setCursor(int16_t x, int16_t y)
+    {
+        cursor_x = x;
+        cursor_y = y;
+    }
+    void setTextSize(uint8_t s) { textsize_x = textsize_y = s > 0 ? s : 1; }
+    void setTextColor(uint16_t c) { textcolor = textbgcolor = c; }
+    void setTextColor(uint16_t c, uint16_t bg)
+    {
+        textcolor = c;
+        textbgcolor = bg;
+    }
+    void setTextWrap(bool w) { wrap = w; }
+
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+    int16_t getCursorX() const { return cursor_x; }
+    int16_t getCursorY() const { return cursor_y; }
+
+    size_t write(uint8_t c) override;
+    using Print::write;
+};
+
+#endif // NATIVE_ADAFRUIT_GFX_H
@@ -0,0 +1,93 @@
+// Adafruit_SSD1306.cpp - host stand-in for the Adafruit SSD1306 OLED driver
+#include "Adafruit_SSD1306.h"
+#include "NativeHal.h"
+
+// The driver never puts more than the Wire buffer in one transaction
+#define WIRE_MAX I2C_BUFFER_LENGTH
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire *twi, int8_t, uint32_t clkDuring,
+                                   uint32_t clkAfter)
+    : Adafruit_GFX(w, h), wire(twi), wireClk(clkDuring), restoreClk(clkAfter)
+{
+}
+
+Adafruit_SSD1306::~Adafruit_SSD1306()
+{
+    free(buffer);
+}
+
+bool Adafruit_SSD1306::begin(uint8_t, uint8_t addr, bool, bool)
+{
+    if (!buffer && !(buffer = (uint8_t *)malloc(_width * ((_height + 7) / 8))))
+        return false;
+    i2caddr = addr;
+    clearDisplay();
+    return true;
+}
+
+void Adafruit_SSD1306::ssd1306_command(uint8_t c)
+{
+    wire->beginTransmission(i2caddr);
+    wire->write((uint8_t)0x00); // Co = 0, D/C = 0
+    wire->write(c);
+    wire->endTransmission();
+}
+
+void Adafruit_SSD1306::display()
+{
+    hal::counters().displayFlushes++;
+    wire->setClock(wireClk);
+
+    static const uint8_t dlist1[] = {SSD1306_PAGEADDR, 0, 0xFF, SSD1306_COLUMNADDR, 0};
+    wire->beginTransmission(i2caddr);
+    wire->write((uint8_t)0x00);
+    wire->write(dlist1, sizeof(dlist1));
+    wire->endTransmission();
+    ssd1306_command(_width - 1);
+
+    uint16_t count = _width * ((_height + 7) / 8);
+    uint8_t *ptr = buffer;
+    wire->beginTransmission(i2caddr);
+    wire->write((uint8_t)0x40);
+    uint16_t bytesOut = 1;
+    while (count--)
+    {
+        if (bytesOut >= WIRE_MAX)
+        {
+            wire->endTransmission();
+            wire->beginTransmission(i2caddr);
+            wire->write((uint8_t)0x40);
+            bytesOut = 1;
+        }
+        wire->write(*ptr++);
+        bytesOut++;
+    }
+    wire->endTransmission();
+
+    wire->setClock(restoreClk);
+}
+
+void Adafruit_SSD1306::clearDisplay()
+{
+    memset(buffer, 0, _width * ((_height + 7) / 8));
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+    if (!buffer || x < 0 || x >= _width || y < 0 || y >= _height)
+        return;
+    uint8_t &cell = buffer[x + (y / 8) * _width];
+    uint8_t bit = 1 << (y & 7);
+    switch (color)
+    {
+    case SSD1306_WHITE:
+        cell |= bit;
+        break;
+    case SSD1306_BLACK:
+        cell &= ~bit;
+        break;
+    case SSD1306_INVERSE:
+        cell ^= bit;
+        break;
+    }
+}
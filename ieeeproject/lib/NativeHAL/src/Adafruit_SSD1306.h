@@ -0,0 +1,45 @@
+// Adafruit_SSD1306.h - host stand-in for the Adafruit SSD1306 OLED driver
+#ifndef NATIVE_ADAFRUIT_SSD1306_H
+#define NATIVE_ADAFRUIT_SSD1306_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "Adafruit_GFX.h"
+
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+
+#define SSD1306_EXTERNALVCC 0x01
+#define SSD1306_SWITCHCAPVCC 0x02
+
+#define SSD1306_COLUMNADDR 0x21
+#define SSD1306_PAGEADDR 0x22
+
+// Keeps a real 1 bit-per-pixel page-ordered framebuffer and pushes it through
+// the Wire stand-in with the same transaction layout as the real driver, so
+// bus bytes and bus time match the device.
+class Adafruit_SSD1306 : public Adafruit_GFX
+{
+private:
+    TwoWire *wire;
+    uint8_t *buffer = nullptr;
+    uint8_t i2caddr = 0;
+    uint32_t wireClk;
+    uint32_t restoreClk;
+
+public:
+    Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire *twi = &Wire, int8_t rst_pin = -1,
+                     uint32_t clkDuring = 400000UL, uint32_t clkAfter = 100000UL);
+    ~Adafruit_SSD1306();
+
+    bool begin(uint8_t switchvcc = SSD1306_SWITCHCAPVCC, uint8_t i2caddr = 0, bool reset = true,
+               bool periphBegin = true);
+    void display();
+    void clearDisplay();
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    uint8_t *getBuffer() { return buffer; }
+    void ssd1306_command(uint8_t c);
+};
+
+#endif // NATIVE_ADAFRUIT_SSD1306_H
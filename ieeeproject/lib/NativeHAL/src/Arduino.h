@@ -0,0 +1,62 @@
+// Arduino.h - host stand-in for the Arduino core
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <math.h>
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "IPAddress.h"
+#include "HardwareSerial.h"
+#include "Esp.h"
+
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+#define PROGMEM
+
+using std::max;
+using std::min;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+void setup();
+void loop();
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+
+// Start SNTP on the device and set the system clock (see hal::epochSeconds()).
+// Both set TZ the way the core does: configTime() to a fixed offset from UTC,
+// configTzTime() to the POSIX TZ string given.
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char *server1, const char *server2 = nullptr,
+                const char *server3 = nullptr);
+void configTzTime(const char *tz, const char *server1, const char *server2 = nullptr,
+                  const char *server3 = nullptr);
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+#endif // NATIVE_ARDUINO_H
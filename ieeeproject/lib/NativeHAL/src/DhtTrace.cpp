@@ -0,0 +1,117 @@
+// DhtTrace.cpp - DHT replies as the RMT peripheral would capture them
+#include "NativeHal.h"
+#include <Arduino.h>
+
+namespace hal
+{
+    // Own generator, so jitter and faults leave the firmware's random() alone
+    static uint32_t traceState = 0x2545F491;
+    static uint32_t corruptions = 0;
+
+    static uint32_t nextRandom(uint32_t range)
+    {
+        traceState ^= traceState << 13;
+        traceState ^= traceState >> 17;
+        traceState ^= traceState << 5;
+        return traceState % range;
+    }
+
+    static int jitter(uint8_t us)
+    {
+        return us ? (int)nextRandom(2 * us + 1) - us : 0;
+    }
+
+    // Pulse index counts levels; two go into each item
+    static void putPulse(uint32_t *items, size_t maxItems, size_t &pulse, uint8_t level, int us)
+    {
+        if (pulse / 2 >= maxItems)
+            return;
+        uint32_t half = (uint32_t)level << 15 | (us & 0x7FFF);
+        if (pulse % 2 == 0)
+            items[pulse / 2] = half;
+        else
+            items[pulse / 2] |= half << 16;
+        pulse++;
+    }
+
+    static void setPulseUs(uint32_t *items, size_t pulse, int us)
+    {
+        int shift = pulse % 2 ? 16 : 0;
+        items[pulse / 2] = (items[pulse / 2] & ~(0x7FFFu << shift)) | (uint32_t)(us & 0x7FFF) << shift;
+    }
+
+    size_t dhtEncode(const uint8_t *bytes, uint32_t *items, size_t maxItems, uint8_t jitterUs)
+    {
+        size_t pulse = 0;
+        // Released line until the sensor answers, then its response
+        putPulse(items, maxItems, pulse, HIGH, 30 + jitter(jitterUs));
+        putPulse(items, maxItems, pulse, LOW, 80 + jitter(jitterUs));
+        putPulse(items, maxItems, pulse, HIGH, 80 + jitter(jitterUs));
+        for (int bit = 0; bit < 40; bit++)
+        {
+            bool one = bytes[bit / 8] & (0x80 >> bit % 8);
+            putPulse(items, maxItems, pulse, LOW, 50 + jitter(jitterUs));
+            putPulse(items, maxItems, pulse, HIGH, (one ? 70 : 26) + jitter(jitterUs));
+        }
+        putPulse(items, maxItems, pulse, LOW, 50 + jitter(jitterUs));
+        putPulse(items, maxItems, pulse, HIGH, 0); // Idle line: the end marker
+        return (pulse + 1) / 2;
+    }
+
+    size_t dhtCapture(bool dht11, uint32_t *items, size_t maxItems)
+    {
+        counters().dhtReads++;
+        if (traceReplaying())
+            return traceServeDht(dht11, items, maxItems);
+        if (env().dhtFails)
+        {
+            traceDht(nullptr, items, 0);
+            return 0;
+        }
+
+        float temperatureC = (indoorTemperatureF() - 32) * 5 / 9;
+        float humidity = indoorHumidity();
+        uint8_t bytes[5];
+        if (dht11)
+        {
+            // Whole-degree, whole-percent resolution
+            bytes[0] = (uint8_t)lroundf(humidity);
+            bytes[1] = 0;
+            bytes[2] = (uint8_t)lroundf(fabsf(temperatureC));
+            bytes[3] = temperatureC < -0.5f ? 0x80 : 0;
+        }
+        else
+        {
+            int tenthsRh = lroundf(humidity * 10);
+            int tenthsC = lroundf(fabsf(temperatureC) * 10);
+            bytes[0] = tenthsRh >> 8;
+            bytes[1] = tenthsRh & 0xFF;
+            bytes[2] = (tenthsC >> 8) | (temperatureC < 0 ? 0x80 : 0);
+            bytes[3] = tenthsC & 0xFF;
+        }
+        bytes[4] = bytes[0] + bytes[1] + bytes[2] + bytes[3];
+        size_t count = dhtEncode(bytes, items, maxItems, 4);
+
+        bool garbled = env().dhtErrorPercent > 0 && (int)nextRandom(100) < env().dhtErrorPercent;
+        if (garbled)
+        {
+            // Pulse 3 + 2n is the low before bit n, 4 + 2n its high
+            size_t bit = nextRandom(40);
+            switch (corruptions++ % 3)
+            {
+            case 0: // A bit read the wrong way
+                setPulseUs(items, 4 + 2 * bit, bytes[bit / 8] & (0x80 >> bit % 8) ? 26 : 70);
+                break;
+            case 1: // Reply cut off: an end marker in the middle
+                items[(3 + 2 * bit) / 2] = 0;
+                count = (3 + 2 * bit) / 2 + 1;
+                break;
+            default: // Interference stretching a low
+                setPulseUs(items, 3 + 2 * bit, 150);
+                break;
+            }
+        }
+        traceDht(garbled ? nullptr : bytes, items, count);
+        return count;
+    }
+}
@@ -0,0 +1,31 @@
+// Esp.cpp - host stand-in for the ESP32 chip info class
+#include "Esp.h"
+#include "NativeHal.h"
+
+EspClass ESP;
+
+static uint32_t heapLeft(uint64_t used)
+{
+    uint32_t size = hal::env().heapSize;
+    return used < size ? size - (uint32_t)used : 0;
+}
+
+uint32_t EspClass::getCycleCount()
+{
+    return (uint32_t)(hal::nowMicros() * getCpuFreqMHz());
+}
+
+uint32_t EspClass::getHeapSize()
+{
+    return hal::env().heapSize;
+}
+
+uint32_t EspClass::getFreeHeap()
+{
+    return heapLeft(hal::heapInUse());
+}
+
+uint32_t EspClass::getMinFreeHeap()
+{
+    return heapLeft(hal::heapHighWater());
+}
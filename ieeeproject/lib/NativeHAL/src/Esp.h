@@ -0,0 +1,21 @@
+// Esp.h - host stand-in for the ESP32 chip info class
+#ifndef NATIVE_ESP_H
+#define NATIVE_ESP_H
+
+#include <cstdint>
+
+// The cycle counter runs off the virtual clock at getCpuFreqMHz(). Heap
+// figures are hal::env().heapSize less what the host run has allocated.
+class EspClass
+{
+public:
+    uint32_t getCycleCount();
+    uint8_t getCpuFreqMHz() { return 160; }
+    uint32_t getHeapSize();
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+};
+
+extern EspClass ESP;
+
+#endif // NATIVE_ESP_H
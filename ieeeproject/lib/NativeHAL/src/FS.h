@@ -0,0 +1,61 @@
+// FS.h - host stand-in for the ESP32 file system API
+#ifndef NATIVE_FS_H
+#define NATIVE_FS_H
+
+#include <Arduino.h>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+enum SeekMode
+{
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+namespace fs
+{
+    // Handle on one file of the LittleFS stand-in; copies share the file but
+    // not the position, and only the copy that wrote charges the commit
+    class File : public Stream
+    {
+    private:
+        int slot = -1;
+        size_t pos = 0;
+        bool writable = false;
+        bool dirty = false;
+
+    public:
+        File() {}
+        File(int slot, size_t pos, bool writable) : slot(slot), pos(pos), writable(writable) {}
+
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t *buffer, size_t size) override;
+        int available() override;
+        int read() override;
+        int peek() override;
+        size_t read(uint8_t *buffer, size_t size);
+        bool seek(uint32_t pos, SeekMode mode = SeekSet);
+        size_t position() const { return pos; }
+        size_t size() const;
+        void flush() {}
+        void close();
+        operator bool() const { return slot >= 0; }
+    };
+
+    class FS
+    {
+    public:
+        File open(const char *path, const char *mode = FILE_READ, bool create = false);
+        bool exists(const char *path);
+        bool remove(const char *path);
+        bool mkdir(const char *path);
+    };
+}
+
+using fs::File;
+using fs::FS;
+
+#endif // NATIVE_FS_H
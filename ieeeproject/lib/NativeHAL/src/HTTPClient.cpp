@@ -0,0 +1,136 @@
+// HTTPClient.cpp - host stand-in for the ESP32 HTTPClient
+#include "HTTPClient.h"
+#include "NativeHal.h"
+#include <WiFi.h>
+#include <cstdio>
+
+// Hours in the hourly arrays, as asked for with forecast_hours=24
+#define FORECAST_HOURS_SERVED 24
+
+// Same shape and field order as a real api.open-meteo.com /v1/forecast reply
+// with timeformat=unixtime
+static String openMeteoResponse()
+{
+    uint32_t now = hal::wallClockSeconds();
+    uint32_t firstHour = now - now % 3600;
+    int64_t firstHourMs = (int64_t)hal::nowMillis() - (int64_t)(now - firstHour) * 1000;
+    int64_t nowMs = hal::nowMillis();
+
+    char json[1024];
+    snprintf(json, sizeof(json),
+             "{\"latitude\":40.69759,\"longitude\":-75.21269,\"generationtime_ms\":0.0350666046142578,"
+             "\"utc_offset_seconds\":0,\"timezone\":\"GMT\",\"timezone_abbreviation\":\"GMT\","
+             "\"elevation\":104.0,\"current_units\":{\"time\":\"unixtime\",\"interval\":\"seconds\","
+             "\"temperature_2m\":\"°F\",\"relative_humidity_2m\":\"%%\",\"precipitation\":\"mm\","
+             "\"wind_speed_10m\":\"mp/h\",\"weather_code\":\"wmo code\"},"
+             "\"current\":{\"time\":%lu,\"interval\":900,\"temperature_2m\":%.1f,"
+             "\"relative_humidity_2m\":%d,\"precipitation\":%.2f,\"wind_speed_10m\":%.1f,"
+             "\"weather_code\":%d},"
+             "\"hourly_units\":{\"time\":\"unixtime\",\"temperature_2m\":\"°F\","
+             "\"precipitation_probability\":\"%%\",\"precipitation\":\"mm\",\"wind_speed_10m\":\"mp/h\","
+             "\"weather_code\":\"wmo code\"},\"hourly\":{",
+             (unsigned long)(now - now % 900), hal::outdoorTemperatureF(), 52, hal::precipitationAtMm(nowMs),
+             hal::windSpeedAtMph(nowMs), hal::weatherCodeAt(nowMs));
+    String body(json);
+
+    const char *fields[] = {"time", "temperature_2m", "precipitation_probability", "precipitation",
+                            "wind_speed_10m", "weather_code"};
+    for (int field = 0; field < 6; field++)
+    {
+        body += field ? ",\"" : "\"";
+        body += fields[field];
+        body += "\":[";
+        for (int hour = 0; hour < FORECAST_HOURS_SERVED; hour++)
+        {
+            int64_t atMs = firstHourMs + hour * 3600000LL;
+            char value[16];
+            switch (field)
+            {
+            case 0:
+                snprintf(value, sizeof(value), "%lu", (unsigned long)(firstHour + hour * 3600));
+                break;
+            case 1:
+                snprintf(value, sizeof(value), "%.1f", hal::outdoorTemperatureAtF(atMs));
+                break;
+            case 2:
+                snprintf(value, sizeof(value), "%d", hal::precipitationChanceAt(atMs));
+                break;
+            case 3:
+                snprintf(value, sizeof(value), "%.2f", hal::precipitationAtMm(atMs));
+                break;
+            case 4:
+                snprintf(value, sizeof(value), "%.1f", hal::windSpeedAtMph(atMs));
+                break;
+            default:
+                snprintf(value, sizeof(value), "%d", hal::weatherCodeAt(atMs));
+                break;
+            }
+            body += hour ? "," : "";
+            body += value;
+        }
+        body += "]";
+    }
+    body += "}}";
+    return body;
+}
+
+bool HTTPClient::begin(const String &url)
+{
+    return begin(ownClient, url);
+}
+
+bool HTTPClient::begin(WiFiClient &client, const String &url)
+{
+    this->client = &client;
+    this->url = url;
+    begun = true;
+    return true;
+}
+
+int HTTPClient::GET()
+{
+    if (!begun)
+        return HTTPC_ERROR_NOT_CONNECTED;
+    hal::counters().httpRequests++;
+    if (WiFi.status() != WL_CONNECTED)
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+
+    if (!client->connected() && !client->connect("api.open-meteo.com", 443))
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+
+    hal::advanceMicros((uint64_t)hal::env().serverResponseMs * 1000);
+    if (hal::traceReplaying())
+    {
+        int code = HTTP_CODE_SERVICE_UNAVAILABLE;
+        std::string recorded;
+        hal::traceServeHttp(code, recorded);
+        if (code != HTTP_CODE_OK)
+            return code;
+        body = recorded.c_str();
+    }
+    else if (hal::env().httpFails)
+    {
+        hal::traceHttp(HTTP_CODE_SERVICE_UNAVAILABLE, "", 0);
+        return HTTP_CODE_SERVICE_UNAVAILABLE;
+    }
+    else
+    {
+        body = openMeteoResponse();
+        hal::traceHttp(HTTP_CODE_OK, body.c_str(), body.length());
+    }
+    client->load(body.c_str(), body.length(), hal::env().httpByteMicros);
+    return HTTP_CODE_OK;
+}
+
+String HTTPClient::getString()
+{
+    hal::advanceMicros((uint64_t)body.length() * hal::env().httpByteMicros);
+    return body;
+}
+
+void HTTPClient::end()
+{
+    begun = false;
+    body = String();
+    client->stop();
+}
@@ -0,0 +1,40 @@
+// HTTPClient.h - host stand-in for the ESP32 HTTPClient
+#ifndef NATIVE_HTTP_CLIENT_H
+#define NATIVE_HTTP_CLIENT_H
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+
+#define HTTP_CODE_OK 200
+#define HTTP_CODE_SERVICE_UNAVAILABLE 503
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+
+// Serves a canned Open-Meteo response. GET() connects first unless the client
+// passed to begin() already is, then charges hal::env().serverResponseMs; the
+// body costs httpByteMicros per byte as it is read. It tracks the simulated
+// outdoor temperature, or is the recorded one while a trace is replayed.
+// end() closes the connection, as the real one does for HTTP/1.0.
+class HTTPClient
+{
+private:
+    String url;
+    String body;
+    WiFiClientSecure ownClient;
+    WiFiClient *client = &ownClient;
+    bool begun = false;
+    bool http10 = false;
+
+public:
+    bool begin(const String &url);
+    bool begin(WiFiClient &client, const String &url);
+    void useHTTP10(bool usehttp10 = true) { http10 = usehttp10; }
+    int GET();
+    String getString();
+    WiFiClient &getStream() { return *client; }
+    int getSize() const { return body.length(); }
+    void end();
+};
+
+#endif // NATIVE_HTTP_CLIENT_H
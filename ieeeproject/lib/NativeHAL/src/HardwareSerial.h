@@ -0,0 +1,34 @@
+// HardwareSerial.h - host stand-in for the board UART
+#ifndef NATIVE_HARDWARE_SERIAL_H
+#define NATIVE_HARDWARE_SERIAL_H
+
+#include "Stream.h"
+
+// TX bytes are counted and charged to the virtual clock at the configured baud
+// rate; they only reach stdout when the host runner is started with --echo.
+// RX bytes come from the scripted input queue in NativeHal.h, and their
+// arrival fires the onReceive() callback like the ESP32 UART driver does.
+class HardwareSerial : public Stream
+{
+private:
+    unsigned long baud = 115200;
+
+public:
+    void begin(unsigned long baudRate) { baud = baudRate; }
+    void end() {}
+    void flush() {}
+    operator bool() const { return true; }
+    void onReceive(void (*fn)());
+
+    int available() override;
+    int read() override;
+    int peek() override;
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+#endif // NATIVE_HARDWARE_SERIAL_H
@@ -0,0 +1,382 @@
+// HostMain.cpp - host entry point: drives setup()/loop() on the virtual clock
+// and reports loop latency, heap traffic and peripheral call counts.
+//
+//   .pio/build/native/program [--hours N] [--echo] [--no-wifi] [--http-fail]
+//                             [--dht-fail] [--dht-errors PERCENT] [--seed N] [--sim]
+//                             [--cmd MS:TEXT]...
+//                             [--wifi-outage MS:SECONDS] [--max-loop-allocs N]
+//                             [--record FILE | --replay FILE]
+//   .pio/build/native/program --bench NAME|list
+//   pio test -e native
+//
+// --record writes the run's DHT replies, weather responses, serial input and
+// servo output to a trace; --replay feeds a trace back in, for as long as it
+// runs unless --hours says otherwise, and reports where the servo did
+// something other than what was recorded. --sim takes the outdoor weather and
+// the room from the seeded simulator in lib/WeatherSim, the room answering to
+// the servo, instead of fixed daily waves.
+#include <Arduino.h>
+#include "NativeHal.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+
+// Count every heap allocation at the malloc level, so C allocations (JSON
+// pools, the SSD1306 framebuffer) show up next to String and operator new
+extern "C"
+{
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t count, size_t size);
+    void *__libc_realloc(void *p, size_t size);
+    void __libc_free(void *p);
+
+    void *malloc(size_t size)
+    {
+        void *p = __libc_malloc(size);
+        if (p)
+            hal::noteAlloc(malloc_usable_size(p));
+        return p;
+    }
+
+    void *calloc(size_t count, size_t size)
+    {
+        void *p = __libc_calloc(count, size);
+        if (p)
+            hal::noteAlloc(malloc_usable_size(p));
+        return p;
+    }
+
+    void *realloc(void *p, size_t size)
+    {
+        if (p)
+            hal::noteFree(malloc_usable_size(p));
+        void *q = __libc_realloc(p, size);
+        if (q)
+            hal::noteAlloc(malloc_usable_size(q));
+        else if (p && size)
+            hal::noteAlloc(malloc_usable_size(p)); // Original block survives
+        return q;
+    }
+
+    void free(void *p)
+    {
+        if (p)
+            hal::noteFree(malloc_usable_size(p));
+        __libc_free(p);
+    }
+}
+#else
+// Without glibc hooks only C++ allocations are counted, and sizes are not
+// known on free, so the peak figure is an upper bound
+void *operator new(size_t size)
+{
+    hal::noteAlloc(size);
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    if (p)
+        hal::noteFree(0);
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    operator delete(p);
+}
+#endif
+
+// Unit tests under test/ bring their own main()
+#ifndef PIO_UNIT_TESTING
+namespace
+{
+    struct Options
+    {
+        double hours = 24;
+        bool hoursGiven = false;
+        bool echo = false;
+        const char *bench = nullptr;
+        long maxLoopAllocs = -1; // Fail the run if one loop() allocates more
+        bool commandsScripted = false;
+        unsigned long seed = 1;
+        const char *record = nullptr;
+        const char *replay = nullptr;
+    };
+
+    void usage(const char *argv0)
+    {
+        fprintf(stderr,
+                "usage: %s [--hours N] [--echo] [--no-wifi] [--http-fail] [--dht-fail]\n"
+                "          [--dht-errors PERCENT] [--seed N] [--sim] [--cmd MS:TEXT]...\n"
+                "          [--wifi-outage MS:SECONDS] [--max-loop-allocs N]\n"
+                "          [--record FILE | --replay FILE]\n"
+                "       %s --bench NAME|list\n",
+                argv0, argv0);
+        exit(2);
+    }
+
+    Options parseArgs(int argc, char **argv)
+    {
+        Options opts;
+        for (int i = 1; i < argc; i++)
+        {
+            String arg(argv[i]);
+            bool hasValue = i + 1 < argc;
+            if (arg == "--hours" && hasValue)
+            {
+                opts.hours = atof(argv[++i]);
+                opts.hoursGiven = true;
+            }
+            else if (arg == "--echo")
+                opts.echo = true;
+            else if (arg == "--no-wifi")
+                hal::env().wifiAvailable = false;
+            else if (arg == "--http-fail")
+                hal::env().httpFails = true;
+            else if (arg == "--dht-fail")
+                hal::env().dhtFails = true;
+            else if (arg == "--dht-errors" && hasValue)
+                hal::env().dhtErrorPercent = atoi(argv[++i]);
+            else if (arg == "--max-loop-allocs" && hasValue)
+                opts.maxLoopAllocs = atol(argv[++i]);
+            else if (arg == "--bench" && hasValue)
+                opts.bench = argv[++i];
+            else if (arg == "--seed" && hasValue)
+                opts.seed = strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--sim")
+                hal::env().simulateWeather = true;
+            else if (arg == "--record" && hasValue)
+                opts.record = argv[++i];
+            else if (arg == "--replay" && hasValue)
+                opts.replay = argv[++i];
+            else if (arg == "--wifi-outage" && hasValue)
+            {
+                // MS:SECONDS -> the access point disappears at MS for SECONDS
+                String spec(argv[++i]);
+                int colon = spec.indexOf(':');
+                if (colon < 0)
+                    usage(argv[0]);
+                hal::env().wifiOutageAtMs = spec.substring(0, colon).toInt();
+                hal::env().wifiOutageMs = spec.substring(colon + 1).toInt() * 1000;
+            }
+            else if (arg == "--cmd" && hasValue)
+            {
+                // MS:TEXT -> TEXT followed by a newline arrives at MS
+                String spec(argv[++i]);
+                int colon = spec.indexOf(':');
+                if (colon < 0)
+                    usage(argv[0]);
+                String text = spec.substring(colon + 1) + "\n";
+                hal::scheduleSerialInput(spec.substring(0, colon).toInt(), text.c_str());
+                opts.commandsScripted = true;
+            }
+            else
+                usage(argv[0]);
+        }
+        if (opts.record && opts.replay)
+            usage(argv[0]);
+        return opts;
+    }
+
+    int runBenchmark(const char *name)
+    {
+        for (hal::Benchmark *b = hal::benchmarks(); b; b = b->next)
+        {
+            if (strcmp(name, b->name) == 0)
+            {
+                fprintf(stderr, "=== %s: %s ===\n", b->name, b->description);
+                hal::resetCounters();
+                b->fn();
+                return 0;
+            }
+        }
+        if (strcmp(name, "list") != 0)
+            fprintf(stderr, "unknown benchmark: %s\n", name);
+        for (hal::Benchmark *b = hal::benchmarks(); b; b = b->next)
+            fprintf(stderr, "  %-20s %s\n", b->name, b->description);
+        return strcmp(name, "list") == 0 ? 0 : 2;
+    }
+
+    void printCounter(const char *name, uint64_t value, double hours)
+    {
+        fprintf(stderr, "  %-18s %12llu  (%.1f/h)\n", name, (unsigned long long)value, value / hours);
+    }
+
+    void printTraceOutputs(const char *name, const hal::TraceOutputs &outputs)
+    {
+        // A capture off the device has rests but no individual writes
+        if (outputs.recorded == 0)
+        {
+            fprintf(stderr, "  %-18s not in the trace\n", name);
+            return;
+        }
+        fprintf(stderr, "  %-18s %6llu recorded, %6llu replayed, %llu diverged", name,
+                (unsigned long long)outputs.recorded, (unsigned long long)outputs.replayed,
+                (unsigned long long)outputs.diverged);
+        if (outputs.diverged && outputs.firstExpected < 0)
+            fprintf(stderr, ", first at %.1f s: %d with nothing recorded yet", outputs.firstAtMs / 1000.0,
+                    outputs.firstAngle);
+        else if (outputs.diverged)
+            fprintf(stderr, ", first at %.1f s: %d instead of %d", outputs.firstAtMs / 1000.0, outputs.firstAngle,
+                    outputs.firstExpected);
+        fprintf(stderr, "\n");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options opts = parseArgs(argc, argv);
+    hal::setSerialEcho(opts.echo);
+    randomSeed(opts.seed);
+    hal::env().simulationSeed = opts.seed;
+
+    if (opts.bench)
+        return runBenchmark(opts.bench);
+
+    if (opts.record && !hal::traceRecord(opts.record))
+    {
+        fprintf(stderr, "cannot write trace %s\n", opts.record);
+        return 2;
+    }
+    if (opts.replay)
+    {
+        if (!hal::traceReplay(opts.replay))
+        {
+            fprintf(stderr, "cannot read trace %s\n", opts.replay);
+            return 2;
+        }
+        if (!opts.hoursGiven)
+            opts.hours = hal::traceDurationMs() / 3600e3;
+    }
+
+    using WallClock = std::chrono::steady_clock;
+    WallClock::time_point wallStart = WallClock::now();
+
+    setup();
+
+    uint64_t setupMicros = hal::nowMicros();
+    uint64_t setupAllocs = hal::counters().heapAllocs;
+    hal::resetCounters();
+
+    // Busy time is virtual time spent in loop() that is not delay(): the time
+    // the control loop is unresponsive on the device. Allocations made by
+    // work that runs on other tasks on the device are not loop() allocations.
+    uint64_t endMicros = opts.replay && !opts.hoursGiven ? (uint64_t)hal::traceDurationMs() * 1000 + 1000
+                                                         : setupMicros + (uint64_t)(opts.hours * 3600e6);
+    uint64_t busyTotal = 0;
+    uint64_t busyMax = 0;
+    uint64_t allocMax = 0;
+    double wallLoopMax = 0;
+    WallClock::time_point loopStart = WallClock::now();
+
+    while (hal::nowMicros() < endMicros)
+    {
+        uint64_t simBefore = hal::nowMicros();
+        uint64_t delayedBefore = hal::counters().delayedMicros;
+        uint64_t allocsBefore = hal::counters().heapAllocs - hal::counters().backgroundAllocs;
+        WallClock::time_point wallBefore = WallClock::now();
+
+        loop();
+
+        double wall = std::chrono::duration<double, std::micro>(WallClock::now() - wallBefore).count();
+        uint64_t busy = (hal::nowMicros() - simBefore) - (hal::counters().delayedMicros - delayedBefore);
+        uint64_t allocs = hal::counters().heapAllocs - hal::counters().backgroundAllocs - allocsBefore;
+        hal::counters().loops++;
+        busyTotal += busy;
+        busyMax = busy > busyMax ? busy : busyMax;
+        allocMax = allocs > allocMax ? allocs : allocMax;
+        wallLoopMax = wall > wallLoopMax ? wall : wallLoopMax;
+    }
+    hal::runIdleTask();
+    hal::traceFinish();
+
+    double loopWall = std::chrono::duration<double>(WallClock::now() - loopStart).count();
+    double totalWall = std::chrono::duration<double>(WallClock::now() - wallStart).count();
+    const hal::Counters &c = hal::counters();
+    double hours = opts.hours > 0 ? opts.hours : 1;
+    uint64_t loops = c.loops ? c.loops : 1;
+
+    double simPerWall = opts.hours / (loopWall > 0 ? loopWall : 1e-9);
+    fprintf(stderr, "\n=== Native run: %g simulated hours in %.3f s (%.0f sim h/s, %.0fx real time) ===\n",
+            opts.hours, totalWall, simPerWall, simPerWall * 3600);
+    fprintf(stderr, "setup():            %.1f ms virtual, %llu heap allocations\n", setupMicros / 1000.0,
+            (unsigned long long)setupAllocs);
+    fprintf(stderr, "loop() iterations:  %llu (%.1f/h)\n", (unsigned long long)c.loops, c.loops / hours);
+    fprintf(stderr, "loop() busy time:   avg %.1f us, max %.1f ms (virtual, excluding delay())\n",
+            (double)busyTotal / loops, busyMax / 1000.0);
+    fprintf(stderr, "loop() host time:   avg %.2f us, max %.1f us (wall clock)\n", loopWall * 1e6 / loops,
+            wallLoopMax);
+    fprintf(stderr, "heap allocations:   %.2f per loop, max %llu in one loop, %llu on other tasks, net %lld\n",
+            (double)(c.heapAllocs - c.backgroundAllocs) / loops, (unsigned long long)allocMax,
+            (unsigned long long)c.backgroundAllocs, (long long)c.heapAllocs - (long long)c.heapFrees);
+    fprintf(stderr, "heap in use:        %llu bytes, peak %llu bytes\n", (unsigned long long)hal::heapInUse(),
+            (unsigned long long)c.heapPeak);
+    fprintf(stderr, "call counts:\n");
+    printCounter("delay()", c.delayCalls, hours);
+    printCounter("analogRead()", c.analogReads, hours);
+    printCounter("DHT reads", c.dhtReads, hours);
+    printCounter("servo writes", c.servoWrites, hours);
+    printCounter("servo attaches", c.servoAttaches, hours);
+    printCounter("full display()", c.displayFlushes, hours);
+    printCounter("I2C transactions", c.wireTransactions, hours);
+    printCounter("I2C bytes", c.wireBytes, hours);
+    printCounter("WiFi.begin()", c.wifiBegins, hours);
+    printCounter("NVS writes", c.nvsWrites, hours);
+    printCounter("LittleFS commits", c.fsWrites, hours);
+    printCounter("LittleFS bytes", c.fsBytesWritten, hours);
+    printCounter("DNS lookups", c.dnsLookups, hours);
+    printCounter("TLS handshakes", c.tlsHandshakes, hours);
+    printCounter("HTTP requests", c.httpRequests, hours);
+    printCounter("serial TX bytes", c.serialTxBytes, hours);
+    printCounter("serial RX bytes", c.serialRxBytes, hours);
+    printCounter("heap allocations", c.heapAllocs, hours);
+
+    const hal::TraceReport &trace = hal::traceReport();
+    if (opts.record)
+        fprintf(stderr, "trace:              %llu records, %llu bytes written to %s (%.0f bytes/h)\n",
+                (unsigned long long)trace.records, (unsigned long long)trace.bytes, opts.record, trace.bytes / hours);
+    if (opts.replay)
+    {
+        fprintf(stderr, "replay of %s: %llu records, %llu bytes\n", opts.replay, (unsigned long long)trace.records,
+                (unsigned long long)trace.bytes);
+        fprintf(stderr, "  inputs served      %llu DHT, %llu HTTP, %llu serial, %llu asked for before any was recorded\n",
+                (unsigned long long)trace.dhtServed, (unsigned long long)trace.httpServed,
+                (unsigned long long)trace.serialServed, (unsigned long long)trace.missing);
+        printTraceOutputs("servo writes", trace.servoWrites);
+        printTraceOutputs("window decisions", trace.servoRests);
+    }
+
+    if (opts.maxLoopAllocs >= 0 && allocMax > (uint64_t)opts.maxLoopAllocs)
+    {
+        fprintf(stderr, "FAIL: a loop() iteration made %llu heap allocations (limit %ld)%s\n",
+                (unsigned long long)allocMax, opts.maxLoopAllocs,
+                opts.commandsScripted ? "; scripted serial commands allocate" : "");
+        return 1;
+    }
+    return 0;
+}
+#endif // PIO_UNIT_TESTING
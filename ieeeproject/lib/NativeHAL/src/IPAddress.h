@@ -0,0 +1,40 @@
+// IPAddress.h - host stand-in for the Arduino IPAddress class
+#ifndef NATIVE_IP_ADDRESS_H
+#define NATIVE_IP_ADDRESS_H
+
+#include "Print.h"
+
+class IPAddress : public Printable
+{
+private:
+    uint8_t octets[4] = {0, 0, 0, 0};
+
+public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : octets{a, b, c, d} {}
+    IPAddress(uint32_t address)
+    {
+        for (int i = 0; i < 4; i++)
+            octets[i] = (address >> (8 * i)) & 0xFF;
+    }
+
+    operator uint32_t() const
+    {
+        return octets[0] | (octets[1] << 8) | (octets[2] << 16) | ((uint32_t)octets[3] << 24);
+    }
+    uint8_t operator[](int index) const { return octets[index]; }
+
+    size_t printTo(Print &p) const override
+    {
+        size_t n = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            n += p.print(octets[i], DEC);
+            if (i < 3)
+                n += p.print('.');
+        }
+        return n;
+    }
+};
+
+#endif // NATIVE_IP_ADDRESS_H
@@ -0,0 +1,202 @@
+// LittleFS.cpp - host stand-in for the ESP32 LittleFS library
+#include "LittleFS.h"
+#include "NativeHal.h"
+#include <cstring>
+
+namespace
+{
+    struct Entry
+    {
+        char path[32];
+        uint8_t data[LITTLEFS_FILE_BYTES];
+        size_t size;
+        bool used;
+    };
+
+    Entry entries[LITTLEFS_MAX_FILES];
+    bool mounted = false;
+
+    const uint64_t FS_OPEN_US = 300;          // Path lookup through the metadata pairs
+    const uint64_t FS_COMMIT_US = 1500;       // Metadata commit when a written file closes
+    const uint64_t FS_WRITE_US_PER_BYTE = 3;  // Page program, amortised block erase
+    const uint64_t FS_READ_BYTES_PER_US = 4;  // Cached SPI flash reads
+
+    int find(const char *path)
+    {
+        for (int i = 0; i < LITTLEFS_MAX_FILES; i++)
+        {
+            if (entries[i].used && strcmp(entries[i].path, path) == 0)
+                return i;
+        }
+        return -1;
+    }
+}
+
+LittleFSFS LittleFS;
+
+namespace fs
+{
+    size_t File::write(uint8_t c)
+    {
+        return write(&c, 1);
+    }
+
+    size_t File::write(const uint8_t *buffer, size_t size)
+    {
+        if (slot < 0 || !writable)
+            return 0;
+        Entry &e = entries[slot];
+        if (pos + size > LITTLEFS_FILE_BYTES)
+            size = LITTLEFS_FILE_BYTES - pos; // Out of space
+        memcpy(e.data + pos, buffer, size);
+        pos += size;
+        if (pos > e.size)
+            e.size = pos;
+        dirty = true;
+        hal::counters().fsBytesWritten += size;
+        hal::advanceMicros(size * FS_WRITE_US_PER_BYTE);
+        return size;
+    }
+
+    int File::available()
+    {
+        return slot < 0 ? 0 : (int)(entries[slot].size - pos);
+    }
+
+    int File::read()
+    {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+
+    int File::peek()
+    {
+        return available() > 0 ? entries[slot].data[pos] : -1;
+    }
+
+    size_t File::read(uint8_t *buffer, size_t size)
+    {
+        size_t left = (size_t)available();
+        if (size > left)
+            size = left;
+        if (size == 0)
+            return 0;
+        memcpy(buffer, entries[slot].data + pos, size);
+        pos += size;
+        hal::advanceMicros(size / FS_READ_BYTES_PER_US + 1);
+        return size;
+    }
+
+    bool File::seek(uint32_t offset, SeekMode mode)
+    {
+        if (slot < 0)
+            return false;
+        size_t base = mode == SeekSet ? 0 : mode == SeekCur ? pos : entries[slot].size;
+        if (base + offset > entries[slot].size)
+            return false;
+        pos = base + offset;
+        return true;
+    }
+
+    size_t File::size() const
+    {
+        return slot < 0 ? 0 : entries[slot].size;
+    }
+
+    void File::close()
+    {
+        if (slot >= 0 && dirty)
+        {
+            hal::counters().fsWrites++;
+            hal::advanceMicros(FS_COMMIT_US);
+        }
+        slot = -1;
+        dirty = false;
+    }
+
+    File FS::open(const char *path, const char *mode, bool create)
+    {
+        if (!mounted || !path || strlen(path) >= sizeof(Entry::path))
+            return File();
+        hal::advanceMicros(FS_OPEN_US);
+
+        bool reading = mode[0] == 'r' && mode[1] != '+';
+        int slot = find(path);
+        if (slot < 0 && (reading && !create))
+            return File();
+        for (int i = 0; slot < 0 && i < LITTLEFS_MAX_FILES; i++)
+        {
+            if (!entries[i].used)
+            {
+                slot = i;
+                strcpy(entries[i].path, path);
+                entries[i].size = 0;
+                entries[i].used = true;
+            }
+        }
+        if (slot < 0)
+            return File(); // Out of directory entries
+
+        if (mode[0] == 'w')
+            entries[slot].size = 0;
+        return File(slot, mode[0] == 'a' ? entries[slot].size : 0, !reading);
+    }
+
+    bool FS::exists(const char *path)
+    {
+        return mounted && find(path) >= 0;
+    }
+
+    bool FS::remove(const char *path)
+    {
+        int slot = mounted ? find(path) : -1;
+        if (slot < 0)
+            return false;
+        entries[slot].used = false;
+        hal::counters().fsWrites++;
+        hal::advanceMicros(FS_COMMIT_US);
+        return true;
+    }
+
+    bool FS::mkdir(const char *)
+    {
+        return mounted;
+    }
+}
+
+bool LittleFSFS::begin(bool, const char *, uint8_t, const char *)
+{
+    // Mounting reads the superblock and walks the metadata
+    hal::advanceMicros(5000);
+    mounted = true;
+    return true;
+}
+
+void LittleFSFS::end()
+{
+    mounted = false;
+}
+
+bool LittleFSFS::format()
+{
+    for (Entry &e : entries)
+        e.used = false;
+    return true;
+}
+
+size_t LittleFSFS::totalBytes()
+{
+    return LITTLEFS_PARTITION_BYTES;
+}
+
+size_t LittleFSFS::usedBytes()
+{
+    // Whole 4 KB blocks per file, plus the two superblocks
+    size_t used = 2 * 4096;
+    for (const Entry &e : entries)
+    {
+        if (e.used)
+            used += (e.size + 4095) / 4096 * 4096;
+    }
+    return used;
+}
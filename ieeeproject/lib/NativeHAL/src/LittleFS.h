@@ -0,0 +1,29 @@
+// LittleFS.h - host stand-in for the ESP32 LittleFS library
+#ifndef NATIVE_LITTLEFS_H
+#define NATIVE_LITTLEFS_H
+
+#include "FS.h"
+
+#define LITTLEFS_MAX_FILES 16
+#define LITTLEFS_FILE_BYTES 32768
+#define LITTLEFS_PARTITION_BYTES 0x160000 // The "spiffs" partition of the default 4 MB layout
+
+// Files in a fixed table that lasts for the whole host run, like the NVS
+// stand-in, so nothing here touches the heap. Opening, reading and writing
+// charge typical SPI flash times to the virtual clock; closing a file that
+// was written counts in hal::counters().fsWrites and charges a metadata
+// commit. Directories are not modelled: paths are just names.
+class LittleFSFS : public fs::FS
+{
+public:
+    bool begin(bool formatOnFail = false, const char *basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+               const char *partitionLabel = "spiffs");
+    void end();
+    bool format();
+    size_t totalBytes();
+    size_t usedBytes();
+};
+
+extern LittleFSFS LittleFS;
+
+#endif // NATIVE_LITTLEFS_H
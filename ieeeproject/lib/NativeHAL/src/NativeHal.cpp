@@ -0,0 +1,479 @@
+// NativeHal.cpp - virtual clock, serial script and Arduino core functions
+#include "NativeHal.h"
+#include <Arduino.h>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <string>
+
+namespace hal
+{
+    static Environment environment;
+    static Counters callCounters;
+    static uint64_t clockMicros = 0;
+    static uint64_t bytesInUse = 0;
+    static uint64_t bytesHighWater = 0;
+    static Benchmark *benchmarkList = nullptr;
+    static bool serialEcho = false;
+    static void (*serialReceiveCallback)() = nullptr;
+    static void (*wifiEventCallback)() = nullptr;
+    static void (*idleTask)() = nullptr;
+    static bool outageReported = false;
+
+    struct ScriptedInput
+    {
+        unsigned long atMs;
+        std::string text;
+    };
+    static std::deque<ScriptedInput> inputScript; // Sorted by atMs
+    static std::string rxBuffer;                  // Bytes that have "arrived"
+
+    Environment &env()
+    {
+        return environment;
+    }
+
+    Counters &counters()
+    {
+        return callCounters;
+    }
+
+    void resetCounters()
+    {
+        callCounters = Counters();
+        callCounters.heapPeak = bytesInUse;
+    }
+
+    void noteAlloc(size_t size)
+    {
+        callCounters.heapAllocs++;
+        callCounters.heapBytes += size;
+        bytesInUse += size;
+        if (bytesInUse > bytesHighWater)
+            bytesHighWater = bytesInUse;
+        if (bytesInUse > callCounters.heapPeak)
+            callCounters.heapPeak = bytesInUse;
+    }
+
+    void noteFree(size_t size)
+    {
+        callCounters.heapFrees++;
+        bytesInUse -= size < bytesInUse ? size : bytesInUse;
+    }
+
+    uint64_t heapInUse()
+    {
+        return bytesInUse;
+    }
+
+    uint64_t heapHighWater()
+    {
+        return bytesHighWater;
+    }
+
+    Benchmark::Benchmark(const char *name, const char *description, BenchmarkFn fn)
+        : name(name), description(description), fn(fn), next(benchmarkList)
+    {
+        benchmarkList = this;
+    }
+
+    Benchmark *benchmarks()
+    {
+        return benchmarkList;
+    }
+
+    uint64_t nowMicros()
+    {
+        return clockMicros;
+    }
+
+    unsigned long nowMillis()
+    {
+        return (unsigned long)(clockMicros / 1000);
+    }
+
+    void advanceMicros(uint64_t us)
+    {
+        clockMicros += us;
+    }
+
+    void runOffClock(void (*fn)())
+    {
+        uint64_t callerClock = clockMicros;
+        uint64_t callerDelayed = callCounters.delayedMicros;
+        uint64_t allocsBefore = callCounters.heapAllocs;
+        fn();
+        clockMicros = callerClock;
+        callCounters.delayedMicros = callerDelayed;
+        callCounters.backgroundAllocs += callCounters.heapAllocs - allocsBefore;
+    }
+
+    void setIdleTask(void (*fn)())
+    {
+        idleTask = fn;
+    }
+
+    void runIdleTask()
+    {
+        if (idleTask)
+            runOffClock(idleTask);
+    }
+
+    static void deliverDueInput()
+    {
+        while (!inputScript.empty() && inputScript.front().atMs <= nowMillis())
+        {
+            rxBuffer += inputScript.front().text;
+            traceSerial(inputScript.front().text);
+            inputScript.pop_front();
+        }
+    }
+
+    void idleUntilInputOr(unsigned long deadlineMs)
+    {
+        unsigned long target = deadlineMs;
+        if (!inputScript.empty() && inputScript.front().atMs < target)
+            target = inputScript.front().atMs;
+        if (target > nowMillis())
+            clockMicros = (uint64_t)target * 1000;
+    }
+
+    // When the scripted outage still has to be reported, ULONG_MAX otherwise
+    static unsigned long pendingWiFiEvent()
+    {
+        if (!wifiEventCallback || outageReported || environment.wifiOutageMs == 0)
+            return ULONG_MAX;
+        return environment.wifiOutageAtMs > nowMillis() ? environment.wifiOutageAtMs : nowMillis();
+    }
+
+    bool sleepUntilInputOr(unsigned long deadlineMs)
+    {
+        runIdleTask();
+        uint64_t before = clockMicros;
+        unsigned long eventAt = pendingWiFiEvent();
+        bool inputFirst = !inputScript.empty() && inputScript.front().atMs < deadlineMs &&
+                          inputScript.front().atMs <= eventAt;
+        bool eventFirst = !inputFirst && eventAt < deadlineMs;
+        idleUntilInputOr(eventFirst ? eventAt : deadlineMs);
+        callCounters.delayCalls++;
+        callCounters.delayedMicros += clockMicros - before;
+
+        if (inputFirst && serialReceiveCallback)
+        {
+            deliverDueInput();
+            serialReceiveCallback();
+        }
+        if (eventFirst)
+        {
+            outageReported = true;
+            wifiEventCallback();
+        }
+        return inputFirst || eventFirst;
+    }
+
+    void setSerialReceiveCallback(void (*fn)())
+    {
+        serialReceiveCallback = fn;
+    }
+
+    bool wifiApUp(unsigned long ms)
+    {
+        return wifiApUpBetween(ms, ms);
+    }
+
+    bool wifiApUpBetween(unsigned long fromMs, unsigned long toMs)
+    {
+        if (!environment.wifiAvailable)
+            return false;
+        if (environment.wifiOutageMs == 0)
+            return true;
+        unsigned long outageEnd = environment.wifiOutageAtMs + environment.wifiOutageMs;
+        return toMs < environment.wifiOutageAtMs || fromMs >= outageEnd;
+    }
+
+    void setWiFiEventCallback(void (*fn)())
+    {
+        wifiEventCallback = fn;
+    }
+
+    void scheduleSerialInput(unsigned long atMs, const char *text)
+    {
+        auto it = inputScript.begin();
+        while (it != inputScript.end() && it->atMs <= atMs)
+            ++it;
+        inputScript.insert(it, ScriptedInput{atMs, text});
+    }
+
+    int serialAvailable()
+    {
+        deliverDueInput();
+        return (int)rxBuffer.size();
+    }
+
+    int serialRead()
+    {
+        deliverDueInput();
+        if (rxBuffer.empty())
+            return -1;
+        int c = (unsigned char)rxBuffer[0];
+        rxBuffer.erase(0, 1);
+        callCounters.serialRxBytes++;
+        return c;
+    }
+
+    int serialPeek()
+    {
+        deliverDueInput();
+        return rxBuffer.empty() ? -1 : (unsigned char)rxBuffer[0];
+    }
+
+    void setSerialEcho(bool echo)
+    {
+        serialEcho = echo;
+    }
+
+    void serialWrite(const uint8_t *buffer, size_t size, unsigned long baud)
+    {
+        callCounters.serialTxBytes += size;
+        // 8N1 framing: 10 bit times per byte
+        advanceMicros((uint64_t)size * 10 * 1000000 / baud);
+        if (serialEcho)
+            fwrite(buffer, 1, size, stdout);
+    }
+
+    static float dailyWave(float base, float swing, float phaseHours, int64_t atMs)
+    {
+        const double dayMs = 24.0 * 60 * 60 * 1000;
+        double phase = (atMs / dayMs - phaseHours / 24.0) * 2 * M_PI;
+        return base + swing * sin(phase);
+    }
+
+    static WeatherSim simulator;
+    static bool simulatorSeeded = false;
+
+    WeatherSim &weatherSim()
+    {
+        if (!simulatorSeeded)
+        {
+            simulator.reset(environment.simulationSeed, environment.wallClockAtStart % 86400);
+            simulatorSeeded = true;
+        }
+        return simulator;
+    }
+
+    void setWindowAngle(int angle)
+    {
+        if (!environment.simulateWeather)
+            return;
+        weatherSim().advanceTo(nowMillis());
+        weatherSim().setWindow(angle);
+    }
+
+    float indoorTemperatureF()
+    {
+        if (environment.simulateWeather)
+        {
+            weatherSim().advanceTo(nowMillis());
+            return weatherSim().room().indoorMicroF() / 1e6f;
+        }
+        return dailyWave(environment.indoorBaseF, environment.indoorSwingF, 9, nowMillis());
+    }
+
+    float indoorHumidity()
+    {
+        if (environment.simulateWeather)
+        {
+            weatherSim().advanceTo(nowMillis());
+            return weatherSim().room().humidityMilli() / 1000.0f;
+        }
+        return environment.indoorHumidity;
+    }
+
+    float outdoorTemperatureF()
+    {
+        return outdoorTemperatureAtF(nowMillis());
+    }
+
+    float outdoorTemperatureAtF(int64_t atMs)
+    {
+        if (environment.simulateWeather)
+            return weatherSim().outdoorMicroFAt(atMs > 0 ? atMs : 0) / 1e6f;
+        return dailyWave(environment.outdoorBaseF, environment.outdoorSwingF, 8, atMs);
+    }
+
+    int weatherCodeAt(int64_t atMs)
+    {
+        if (environment.simulateWeather)
+            return weatherSim().wmoCodeAt(atMs > 0 ? atMs : 0);
+        return environment.rainAtMs >= 0 && atMs >= environment.rainAtMs ? 61 : environment.weatherCode;
+    }
+
+    int precipitationChanceAt(int64_t atMs)
+    {
+        if (environment.simulateWeather)
+            return weatherSim().precipitationChanceAt(atMs > 0 ? atMs : 0);
+        return weatherCodeAt(atMs) >= 51 ? 80 : 5;
+    }
+
+    float precipitationAtMm(int64_t atMs)
+    {
+        if (environment.simulateWeather)
+            return weatherSim().precipitationCentiMmAt(atMs > 0 ? atMs : 0) / 100.0f;
+        return weatherCodeAt(atMs) >= 51 ? 0.8f : 0.0f;
+    }
+
+    float windSpeedAtMph(int64_t atMs)
+    {
+        if (environment.simulateWeather)
+            return weatherSim().windDeciMphAt(atMs > 0 ? atMs : 0) / 10.0f;
+        return 7.9f;
+    }
+
+    static bool systemClockSet = false;
+    static int64_t systemClockOffset = 0; // Seconds between the set time and the virtual clock
+
+    uint32_t wallClockSeconds()
+    {
+        return environment.wallClockAtStart + (uint32_t)(clockMicros / 1000000);
+    }
+
+    uint32_t epochSeconds()
+    {
+        if (systemClockSet)
+            return (uint32_t)(systemClockOffset + (int64_t)(clockMicros / 1000000));
+        return environment.rtcTimeValid ? wallClockSeconds() : 0;
+    }
+
+    void setEpochSeconds(uint32_t seconds)
+    {
+        systemClockOffset = (int64_t)seconds - (int64_t)(clockMicros / 1000000);
+        systemClockSet = true;
+    }
+}
+
+HardwareSerial Serial;
+
+void HardwareSerial::onReceive(void (*fn)())
+{
+    hal::setSerialReceiveCallback(fn);
+}
+
+int HardwareSerial::available()
+{
+    return hal::serialAvailable();
+}
+
+int HardwareSerial::read()
+{
+    return hal::serialRead();
+}
+
+int HardwareSerial::peek()
+{
+    return hal::serialPeek();
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    hal::serialWrite(&c, 1, baud);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    hal::serialWrite(buffer, size, baud);
+    return size;
+}
+
+unsigned long millis()
+{
+    return hal::nowMillis();
+}
+
+unsigned long micros()
+{
+    return (unsigned long)hal::nowMicros();
+}
+
+void delay(unsigned long ms)
+{
+    hal::runIdleTask();
+    hal::counters().delayCalls++;
+    hal::counters().delayedMicros += (uint64_t)ms * 1000;
+    hal::advanceMicros((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    hal::advanceMicros(us);
+}
+
+void yield()
+{
+}
+
+void pinMode(uint8_t, uint8_t)
+{
+}
+
+void digitalWrite(uint8_t, uint8_t)
+{
+}
+
+int digitalRead(uint8_t)
+{
+    return LOW;
+}
+
+uint16_t analogRead(uint8_t)
+{
+    hal::counters().analogReads++;
+    hal::advanceMicros(20); // One-shot ADC conversion on the ESP32-C3
+    return hal::env().analogValue;
+}
+
+void configTzTime(const char *tz, const char *, const char *, const char *)
+{
+    setenv("TZ", tz, 1);
+    tzset();
+    // SNTP answers within a round trip; the host sets the clock at once
+    hal::setEpochSeconds(hal::wallClockSeconds());
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char *server1, const char *server2,
+                const char *server3)
+{
+    // The core's setTimeZone(): POSIX offsets count west of UTC, and the
+    // daylight offset is applied to the DST name. Whole hours are enough here.
+    char tz[sizeof("UTCDST") + 2 * 20]; // Room for two longs, sign included
+    snprintf(tz, sizeof(tz), "UTC%ldDST%ld", -gmtOffsetSec / 3600,
+             (-gmtOffsetSec - daylightOffsetSec) / 3600);
+    configTzTime(tz, server1, server2, server3);
+}
+
+static uint32_t randomState = 1;
+
+long random(long howbig)
+{
+    if (howbig <= 0)
+        return 0;
+    // xorshift32, deterministic across runs for reproducible profiles
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState % howbig;
+}
+
+long random(long howsmall, long howbig)
+{
+    if (howsmall >= howbig)
+        return howsmall;
+    return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long seed)
+{
+    randomState = seed ? (uint32_t)seed : 1;
+}
@@ -0,0 +1,237 @@
+// NativeHal.h - control surface of the host stand-ins
+//
+// Everything the firmware sees as hardware (clock, UART, I2C, DHT, servo,
+// WiFi, DNS, TLS, HTTP, NVS, LittleFS) is simulated here against a virtual
+// clock. delay() advances the clock instead of sleeping, and slow peripherals
+// charge their typical bus time to it, so one simulated hour runs in well
+// under a millisecond.
+#ifndef NATIVE_HAL_H
+#define NATIVE_HAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "WeatherSim.h"
+
+namespace hal
+{
+    // Simulated world the stand-ins read from
+    struct Environment
+    {
+        float indoorBaseF = 72.0;       // Mean indoor temperature
+        float indoorSwingF = 4.0;       // Daily swing around the mean
+        float indoorHumidity = 45.0;    // Relative humidity in percent
+        float outdoorBaseF = 68.0;      // Mean outdoor temperature
+        float outdoorSwingF = 10.0;     // Daily swing around the mean
+        int weatherCode = 2;            // WMO code served by the fake API
+        int64_t rainAtMs = -1;          // Rain (WMO 61) from this virtual time on, in the forecast too; -1 = never
+        bool dhtFails = false;          // DHT never answers the start signal
+        int dhtErrorPercent = 0;        // Share of DHT replies that arrive corrupted
+        bool wifiAvailable = true;      // Access point reachable
+        unsigned long wifiAssociateMs = 2500; // Scan + association + DHCP
+        unsigned long wifiScanMs = 1600;      // Part of it saved by a known BSSID and channel
+        unsigned long wifiDhcpMs = 500;       // Part of it saved by a static IP
+        int32_t wifiChannel = 6;        // Channel the access point is on
+        unsigned long wifiOutageAtMs = 0;     // Access point drops out at this time...
+        unsigned long wifiOutageMs = 0;       // ...for this long (0 = never)
+        bool httpFails = false;         // API returns HTTP 503
+        unsigned long dnsLookupMs = 60;       // Resolver round trip
+        unsigned long dnsTtlMs = 300000;      // How long the answer stays in the lwIP cache
+        unsigned long tcpConnectMs = 80;      // SYN to SYN-ACK
+        unsigned long tlsHandshakeMs = 700;   // Full handshake, ECDHE dominated on the C3
+        unsigned long serverResponseMs = 250; // Request sent to response headers
+        unsigned long httpByteMicros = 10;    // Per body byte read off the socket
+        uint32_t heapSize = 327680;     // DRAM the device heap starts with, for ESP.getFreeHeap()
+        int analogValue = 1800;         // Raw 12-bit value for analogRead()
+        uint32_t wallClockAtStart = 1743862500; // Unix time at virtual time 0
+        bool rtcTimeValid = false;      // System time survived the reset (soft reset, not power-on)
+        bool simulateWeather = false;   // Outdoor weather and the room from weatherSim() instead of the waves above
+        uint32_t simulationSeed = 1;
+    };
+
+    // Call counters, reset by the host runner before each measurement
+    struct Counters
+    {
+        uint64_t loops = 0;
+        uint64_t delayCalls = 0;
+        uint64_t delayedMicros = 0;
+        uint64_t analogReads = 0;
+        uint64_t dhtReads = 0;
+        uint64_t servoWrites = 0;
+        uint64_t servoAttaches = 0;    // PWM started; the firmware releases it when idle
+        uint64_t wireTransactions = 0;
+        uint64_t wireBytes = 0;
+        uint64_t displayFlushes = 0;
+        uint64_t wifiBegins = 0;
+        uint64_t nvsWrites = 0;
+        uint64_t fsWrites = 0;         // LittleFS commits: written files closed, files removed
+        uint64_t fsBytesWritten = 0;
+        uint64_t httpRequests = 0;
+        uint64_t dnsLookups = 0;       // Resolver round trips, cache hits not counted
+        uint64_t tlsHandshakes = 0;
+        uint64_t serialTxBytes = 0;
+        uint64_t serialRxBytes = 0;
+        uint64_t heapAllocs = 0;
+        uint64_t heapFrees = 0;
+        uint64_t heapBytes = 0;
+        uint64_t heapPeak = 0;         // High-water mark of heapInUse() since the last reset
+        uint64_t backgroundAllocs = 0; // Part of heapAllocs made inside runOffClock()
+    };
+
+    Environment &env();
+    Counters &counters();
+    void resetCounters();
+
+    // Heap accounting, fed by the allocator hooks in HostMain.cpp
+    void noteAlloc(size_t size);
+    void noteFree(size_t size);
+    uint64_t heapInUse();
+    uint64_t heapHighWater(); // Most ever in use, never reset
+
+    // Virtual clock
+    uint64_t nowMicros();
+    unsigned long nowMillis();
+    void advanceMicros(uint64_t us);
+
+    // Run fn as if on another FreeRTOS task: the virtual time it takes is not
+    // charged to the caller, so anything it stamps with millis() lies in the
+    // caller's future until the clock catches up
+    void runOffClock(void (*fn)());
+
+    // Stand-in for a task below the loop task's priority: runs off the clock
+    // whenever the firmware blocks in delay() or sleepUntilInputOr(), and
+    // once more when the run ends
+    void setIdleTask(void (*fn)());
+    void runIdleTask();
+
+    // Advance the clock to deadlineMs, or to the next scripted serial input if
+    // that is due earlier
+    void idleUntilInputOr(unsigned long deadlineMs);
+
+    // Block the caller like delay() until deadlineMs, or until scripted serial
+    // input arrives if that is earlier; arriving input fires the receive
+    // callback, the way the UART driver wakes a task blocked on it. Returns
+    // true when input or a WiFi event ended the sleep.
+    bool sleepUntilInputOr(unsigned long deadlineMs);
+    void setSerialReceiveCallback(void (*fn)());
+
+    // Access point reachability from env(): at one time, and all the way
+    // through an interval
+    bool wifiApUp(unsigned long ms);
+    bool wifiApUpBetween(unsigned long fromMs, unsigned long toMs);
+
+    // The start of a scripted outage ends sleepUntilInputOr() early and fires
+    // this callback, like the station disconnect event on the device
+    void setWiFiEventCallback(void (*fn)());
+
+    // Serial RX script: text becomes readable once the clock reaches atMs
+    void scheduleSerialInput(unsigned long atMs, const char *text);
+    int serialAvailable();
+    int serialRead();
+    int serialPeek();
+
+    // Serial TX sink
+    void setSerialEcho(bool echo);
+    void serialWrite(const uint8_t *buffer, size_t size, unsigned long baud);
+
+    // Temperatures the stand-ins report at the current virtual time, and the
+    // outdoor one at any virtual time for the forecast
+    float indoorTemperatureF();
+    float outdoorTemperatureF();
+    float outdoorTemperatureAtF(int64_t atMs);
+    float indoorHumidity();
+
+    // The rest of the weather the fake API serves, at any virtual time
+    int weatherCodeAt(int64_t atMs);
+    int precipitationChanceAt(int64_t atMs);
+    float precipitationAtMm(int64_t atMs);
+    float windSpeedAtMph(int64_t atMs);
+
+    // The simulator behind env().simulateWeather, seeded with
+    // env().simulationSeed on first use and started at the wall clock's time
+    // of day. Its room is stepped up to the virtual time whenever the indoor
+    // readings are taken, and follows the servo through setWindowAngle().
+    WeatherSim &weatherSim();
+    void setWindowAngle(int angle);
+
+    // Real time in the simulated world, and the device's idea of it: 0 until
+    // configTime() or setEpochSeconds() sets it, unless env().rtcTimeValid
+    uint32_t wallClockSeconds();
+    uint32_t epochSeconds();
+    void setEpochSeconds(uint32_t seconds);
+
+    // A DHT reply to the start signal as the RMT peripheral records it: the
+    // indoor readings as 32-bit items (see DhtReader.h) with a few us of
+    // jitter. Nothing when dhtFails; with dhtErrorPercent, now and then a
+    // flipped bit, a cut-off reply or a glitch.
+    size_t dhtCapture(bool dht11, uint32_t *items, size_t maxItems);
+
+    // Five bytes as a DHT reply, for building test traces; returns the items
+    // used, end marker included
+    size_t dhtEncode(const uint8_t *bytes, uint32_t *items, size_t maxItems, uint8_t jitterUs);
+
+    // Record and replay of what the firmware gets from outside (DHT replies,
+    // Open-Meteo responses, serial input) and what it does with it (servo
+    // writes, and the angle it releases the servo at after a move) as a
+    // timestamped binary trace. Replay serves each input from the latest
+    // record at or before the current virtual time, so firmware that reads
+    // at other times still sees the recorded world, and checks each servo
+    // write against the recording the same way.
+    bool traceRecord(const char *path);
+    bool traceReplay(const char *path);
+    void traceFinish(); // Flush and close the recording
+    bool traceReplaying();
+    int64_t traceDurationMs(); // Time of the last record in the replayed trace
+
+    struct TraceOutputs
+    {
+        uint64_t recorded = 0;
+        uint64_t replayed = 0;
+        uint64_t diverged = 0;   // Replayed ones that differ from the recording at that time
+        int64_t firstAtMs = -1;  // First divergence
+        int firstAngle = 0;
+        int firstExpected = -1;  // -1 when nothing was recorded by then
+    };
+
+    struct TraceReport
+    {
+        uint64_t records = 0;    // Written or loaded
+        uint64_t bytes = 0;
+        uint64_t dhtServed = 0;
+        uint64_t httpServed = 0;
+        uint64_t serialServed = 0;
+        uint64_t missing = 0;    // Inputs asked for before the first recorded one
+        TraceOutputs servoWrites;
+        TraceOutputs servoRests; // Where each move ended: the window decisions
+    };
+    const TraceReport &traceReport();
+
+    // Hooks in the stand-ins. The DHT one takes the reply bytes when the
+    // capture is a clean encoding of them, nullptr when it was garbled.
+    void traceDht(const uint8_t *bytes, const uint32_t *items, size_t count);
+    size_t traceServeDht(bool dht11, uint32_t *items, size_t maxItems);
+    void traceHttp(int code, const char *body, size_t size);
+    bool traceServeHttp(int &code, std::string &body);
+    void traceSerial(const std::string &text);
+    void traceServo(int angle, bool rest);
+
+    // Host benchmarks, run with --bench NAME instead of setup()/loop().
+    // Define them with HAL_BENCHMARK in a NATIVE_BUILD-only source file.
+    typedef void (*BenchmarkFn)();
+    struct Benchmark
+    {
+        const char *name;
+        const char *description;
+        BenchmarkFn fn;
+        Benchmark *next;
+        Benchmark(const char *name, const char *description, BenchmarkFn fn);
+    };
+    Benchmark *benchmarks();
+}
+
+#define HAL_BENCHMARK(name, description)                                                   \
+    static void benchmark_##name();                                                        \
+    static hal::Benchmark benchmark_entry_##name(#name, description, benchmark_##name);   \
+    static void benchmark_##name()
+
+#endif // NATIVE_HAL_H
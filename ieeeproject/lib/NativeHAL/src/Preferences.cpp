@@ -0,0 +1,117 @@
+// Preferences.cpp - host stand-in for the ESP32 Preferences (NVS) library
+#include "Preferences.h"
+#include "NativeHal.h"
+#include <cstring>
+
+namespace
+{
+    struct Entry
+    {
+        char space[16];
+        char key[16];
+        uint8_t data[NVS_MAX_BLOB];
+        size_t length;
+        bool used;
+    };
+
+    Entry entries[NVS_MAX_ENTRIES];
+
+    const uint64_t NVS_WRITE_US = 3000; // Typical small-blob commit on the C3
+
+    Entry *find(const char *space, const char *key)
+    {
+        for (Entry &e : entries)
+        {
+            if (e.used && strcmp(e.space, space) == 0 && strcmp(e.key, key) == 0)
+                return &e;
+        }
+        return nullptr;
+    }
+}
+
+bool Preferences::begin(const char *name, bool readOnly)
+{
+    // NVS namespace and key names are limited to 15 characters
+    if (!name || strlen(name) >= sizeof(space))
+        return false;
+    strcpy(space, name);
+    this->readOnly = readOnly;
+    open = true;
+    return true;
+}
+
+void Preferences::end()
+{
+    open = false;
+}
+
+bool Preferences::clear()
+{
+    if (!open || readOnly)
+        return false;
+    for (Entry &e : entries)
+    {
+        if (e.used && strcmp(e.space, space) == 0)
+            e.used = false;
+    }
+    hal::counters().nvsWrites++;
+    hal::advanceMicros(NVS_WRITE_US);
+    return true;
+}
+
+bool Preferences::remove(const char *key)
+{
+    Entry *e = open && !readOnly ? find(space, key) : nullptr;
+    if (!e)
+        return false;
+    e->used = false;
+    hal::counters().nvsWrites++;
+    hal::advanceMicros(NVS_WRITE_US);
+    return true;
+}
+
+bool Preferences::isKey(const char *key)
+{
+    return open && find(space, key);
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t length)
+{
+    if (!open || readOnly || !key || strlen(key) >= sizeof(Entry::key) || length > NVS_MAX_BLOB)
+        return 0;
+
+    Entry *e = find(space, key);
+    for (Entry *slot = entries; !e && slot < entries + NVS_MAX_ENTRIES; slot++)
+    {
+        if (!slot->used)
+        {
+            e = slot;
+            strcpy(e->space, space);
+            strcpy(e->key, key);
+            e->used = true;
+        }
+    }
+    if (!e)
+        return 0;
+
+    memcpy(e->data, value, length);
+    e->length = length;
+    hal::counters().nvsWrites++;
+    hal::advanceMicros(NVS_WRITE_US);
+    return length;
+}
+
+size_t Preferences::getBytes(const char *key, void *buffer, size_t maxLength)
+{
+    Entry *e = open ? find(space, key) : nullptr;
+    if (!e || e->length > maxLength)
+        return 0;
+    memcpy(buffer, e->data, e->length);
+    return e->length;
+}
+
+size_t Preferences::getBytesLength(const char *key)
+{
+    Entry *e = open ? find(space, key) : nullptr;
+    return e ? e->length : 0;
+}
@@ -0,0 +1,33 @@
+// Preferences.h - host stand-in for the ESP32 Preferences (NVS) library
+#ifndef NATIVE_PREFERENCES_H
+#define NATIVE_PREFERENCES_H
+
+#include <Arduino.h>
+
+#define NVS_MAX_ENTRIES 16
+#define NVS_MAX_BLOB 1024
+
+// Key/value blobs in a fixed table that lasts for the whole host run, so a
+// second setup() sees what the first one stored, like a reboot on the device.
+// Writes count in hal::counters().nvsWrites and charge a flash write to the
+// virtual clock.
+class Preferences
+{
+private:
+    char space[16] = {};
+    bool open = false;
+    bool readOnly = false;
+
+public:
+    bool begin(const char *name, bool readOnly = false);
+    void end();
+    bool clear();
+    bool remove(const char *key);
+    bool isKey(const char *key);
+
+    size_t putBytes(const char *key, const void *value, size_t length);
+    size_t getBytes(const char *key, void *buffer, size_t maxLength);
+    size_t getBytesLength(const char *key);
+};
+
+#endif // NATIVE_PREFERENCES_H
@@ -0,0 +1,124 @@
+// Print.cpp - host stand-in for the Arduino Print class
+#include "Print.h"
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t n = 0;
+    while (size--)
+    {
+        n += write(*buffer++);
+    }
+    return n;
+}
+
+size_t Print::write(const char *str)
+{
+    return str ? write((const uint8_t *)str, strlen(str)) : 0;
+}
+
+size_t Print::printf(const char *format, ...)
+{
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (len < 0)
+        return 0;
+    return write((const uint8_t *)buf, (size_t)len < sizeof(buf) ? (size_t)len : sizeof(buf) - 1);
+}
+
+size_t Print::print(const __FlashStringHelper *s)
+{
+    return write(reinterpret_cast<const char *>(s));
+}
+
+size_t Print::print(const String &s)
+{
+    return write((const uint8_t *)s.c_str(), s.length());
+}
+
+size_t Print::print(const char *s)
+{
+    return write(s);
+}
+
+size_t Print::print(char c)
+{
+    return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char n, int base)
+{
+    return print((unsigned long)n, base);
+}
+
+size_t Print::print(int n, int base)
+{
+    return print((long)n, base);
+}
+
+size_t Print::print(unsigned int n, int base)
+{
+    return print((unsigned long)n, base);
+}
+
+size_t Print::print(long n, int base)
+{
+    if (base == DEC && n < 0)
+    {
+        return print('-') + printNumber(0UL - (unsigned long)n, DEC);
+    }
+    return printNumber((unsigned long)n, base);
+}
+
+size_t Print::print(unsigned long n, int base)
+{
+    return printNumber(n, base);
+}
+
+size_t Print::print(double n, int digits)
+{
+    return printFloat(n, digits);
+}
+
+size_t Print::print(const Printable &p)
+{
+    return p.printTo(*this);
+}
+
+size_t Print::println()
+{
+    return write("\r\n");
+}
+
+size_t Print::printNumber(unsigned long n, uint8_t base)
+{
+    char buf[8 * sizeof(long) + 1];
+    char *p = &buf[sizeof(buf) - 1];
+    *p = '\0';
+    if (base < 2)
+        base = 10;
+    do
+    {
+        char digit = n % base;
+        *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+        n /= base;
+    } while (n);
+    return write(p);
+}
+
+size_t Print::printFloat(double number, int digits)
+{
+    if (std::isnan(number))
+        return write("nan");
+    if (std::isinf(number))
+        return write("inf");
+    char buf[64];
+    int len = snprintf(buf, sizeof(buf), "%.*f", digits, number);
+    return write((const uint8_t *)buf, len);
+}
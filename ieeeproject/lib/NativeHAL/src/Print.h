@@ -0,0 +1,66 @@
+// Print.h - host stand-in for the Arduino Print class
+#ifndef NATIVE_PRINT_H
+#define NATIVE_PRINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print;
+
+// Anything that knows how to print itself (IPAddress, ...)
+class Printable
+{
+public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print &p) const = 0;
+};
+
+class Print
+{
+private:
+    size_t printNumber(unsigned long n, uint8_t base);
+    size_t printFloat(double number, int digits);
+
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *str);
+    size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+    size_t print(const __FlashStringHelper *s);
+    size_t print(const String &s);
+    size_t print(const char *s);
+    size_t print(char c);
+    size_t print(unsigned char n, int base = DEC);
+    size_t print(int n, int base = DEC);
+    size_t print(unsigned int n, int base = DEC);
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(double n, int digits = 2);
+    size_t print(const Printable &p);
+
+    size_t println();
+    template <typename T>
+    size_t println(const T &value)
+    {
+        size_t n = print(value);
+        return n + println();
+    }
+    template <typename T>
+    size_t println(const T &value, int format)
+    {
+        size_t n = print(value, format);
+        return n + println();
+    }
+};
+
+#endif // NATIVE_PRINT_H
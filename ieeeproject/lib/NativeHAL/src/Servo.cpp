@@ -0,0 +1,32 @@
+// Servo.cpp - host stand-in for the ServoESP32 library
+#include "Servo.h"
+#include "NativeHal.h"
+
+bool Servo::attach(int pin, int, int minAngle, int maxAngle, int, int, int)
+{
+    if (!attached())
+        hal::counters().servoAttaches++;
+    this->pin = pin;
+    this->minAngle = minAngle;
+    this->maxAngle = maxAngle;
+    return true;
+}
+
+bool Servo::detach()
+{
+    if (!attached())
+        return false;
+    hal::traceServo(angle, true);
+    pin = -1;
+    return true;
+}
+
+void Servo::write(int angle)
+{
+    if (!attached())
+        return;
+    this->angle = constrain(angle, minAngle, maxAngle);
+    hal::counters().servoWrites++;
+    hal::setWindowAngle(this->angle);
+    hal::traceServo(this->angle, false);
+}
@@ -0,0 +1,26 @@
+// Servo.h - host stand-in for the ServoESP32 library
+#ifndef NATIVE_SERVO_H
+#define NATIVE_SERVO_H
+
+#include <Arduino.h>
+
+class Servo
+{
+private:
+    int pin = -1;
+    int angle = 0;
+    int minAngle = 0;
+    int maxAngle = 180;
+
+public:
+    static const int CHANNEL_NOT_ATTACHED = -1;
+
+    bool attach(int pin, int channel = CHANNEL_NOT_ATTACHED, int minAngle = 0, int maxAngle = 180,
+                int minPulseWidthUs = 544, int maxPulseWidthUs = 2400, int frequency = 50);
+    bool detach();
+    void write(int angle);
+    int read() const { return angle; }
+    bool attached() const { return pin >= 0; }
+};
+
+#endif // NATIVE_SERVO_H
@@ -0,0 +1,56 @@
+// Stream.cpp - host stand-in for the Arduino Stream class
+#include "Stream.h"
+#include "NativeHal.h"
+
+int Stream::timedRead()
+{
+    unsigned long start = hal::nowMillis();
+    do
+    {
+        int c = read();
+        if (c >= 0)
+            return c;
+        // Nothing will arrive while we spin on the host, so burn the rest of
+        // the timeout in one step unless scripted input is due before then.
+        hal::idleUntilInputOr(start + _timeout);
+    } while (hal::nowMillis() - start < _timeout);
+    return -1;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length)
+{
+    size_t count = 0;
+    while (count < length)
+    {
+        int c = timedRead();
+        if (c < 0)
+            break;
+        *buffer++ = (char)c;
+        count++;
+    }
+    return count;
+}
+
+String Stream::readString()
+{
+    String ret;
+    int c = timedRead();
+    while (c >= 0)
+    {
+        ret += (char)c;
+        c = timedRead();
+    }
+    return ret;
+}
+
+String Stream::readStringUntil(char terminator)
+{
+    String ret;
+    int c = timedRead();
+    while (c >= 0 && c != terminator)
+    {
+        ret += (char)c;
+        c = timedRead();
+    }
+    return ret;
+}
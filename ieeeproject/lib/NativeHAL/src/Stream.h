@@ -0,0 +1,29 @@
+// Stream.h - host stand-in for the Arduino Stream class
+#ifndef NATIVE_STREAM_H
+#define NATIVE_STREAM_H
+
+#include "Print.h"
+
+class Stream : public Print
+{
+protected:
+    unsigned long _timeout = 1000; // milliseconds, same default as the Arduino core
+
+    // Waits (in virtual time) for the next byte, -1 once the timeout expires
+    int timedRead();
+
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+    unsigned long getTimeout() const { return _timeout; }
+
+    size_t readBytes(char *buffer, size_t length);
+    size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
+    String readString();
+    String readStringUntil(char terminator);
+};
+
+#endif // NATIVE_STREAM_H
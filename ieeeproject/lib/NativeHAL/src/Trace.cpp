@@ -0,0 +1,323 @@
+// Trace.cpp - record and replay of the firmware's inputs and servo outputs
+//
+// A trace is a header, then records back to back:
+//
+//   "WTRC" version:u8 wallClockAtStart:u32le
+//   kind:u8 zigzag-varint(ms since the previous record) varint(length) payload
+//
+// Work run off the clock can stamp a record ahead of the one after it, hence
+// the signed deltas. Payloads by kind:
+//
+//   DHT     0 = no reply; 1 + the five reply bytes; 2 + the raw items, each
+//           half as varint(us << 1 | level), when the capture was garbled
+//   HTTP    varint status code, then the body
+//   SERIAL  bytes as they became readable
+//   SERVO   angle written, one byte
+//   REST    angle the servo was released at, one byte
+//
+// tools/trace_from_log.py writes one from a device running a TRACE_CAPTURE
+// build. It has no SERVO records, so only the rests are compared.
+#include "NativeHal.h"
+#include <Arduino.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace hal
+{
+    enum TraceKind : uint8_t
+    {
+        TRACE_DHT = 1,
+        TRACE_HTTP,
+        TRACE_SERIAL,
+        TRACE_SERVO,
+        TRACE_REST,
+        TRACE_KINDS
+    };
+
+    static const char TRACE_MAGIC[4] = {'W', 'T', 'R', 'C'};
+    static const uint8_t TRACE_VERSION = 1;
+
+    struct TraceRecord
+    {
+        int64_t atMs;
+        std::string payload;
+    };
+
+    static FILE *recordFile = nullptr;
+    static int64_t lastRecordMs = 0;
+    static bool replaying = false;
+    static std::vector<TraceRecord> loaded[TRACE_KINDS]; // Each sorted by atMs
+    static size_t outputCursor[TRACE_KINDS];              // Next recorded output to match
+    static TraceReport report;
+
+    static void putVarint(std::string &out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out += (char)(value | 0x80);
+            value >>= 7;
+        }
+        out += (char)value;
+    }
+
+    static bool getVarint(const std::string &in, size_t &pos, uint64_t &value)
+    {
+        value = 0;
+        for (int shift = 0; pos < in.size() && shift < 64; shift += 7)
+        {
+            uint8_t byte = in[pos++];
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    static void writeRecord(TraceKind kind, const std::string &payload)
+    {
+        if (!recordFile)
+            return;
+        int64_t now = nowMillis();
+        int64_t delta = now - lastRecordMs;
+        lastRecordMs = now;
+
+        std::string head(1, (char)kind);
+        putVarint(head, (uint64_t)delta << 1 ^ (uint64_t)(delta >> 63));
+        putVarint(head, payload.size());
+        fwrite(head.data(), 1, head.size(), recordFile);
+        fwrite(payload.data(), 1, payload.size(), recordFile);
+        report.records++;
+        report.bytes += head.size() + payload.size();
+    }
+
+    // The latest record of a kind at or before now, nullptr if none is yet
+    static const TraceRecord *recordAt(TraceKind kind, int64_t now)
+    {
+        const std::vector<TraceRecord> &records = loaded[kind];
+        auto after = std::upper_bound(records.begin(), records.end(), now,
+                                      [](int64_t at, const TraceRecord &r) { return at < r.atMs; });
+        return after == records.begin() ? nullptr : &*(after - 1);
+    }
+
+    bool traceRecord(const char *path)
+    {
+        recordFile = fopen(path, "wb");
+        if (!recordFile)
+            return false;
+        uint8_t header[9];
+        memcpy(header, TRACE_MAGIC, 4);
+        header[4] = TRACE_VERSION;
+        for (int i = 0; i < 4; i++)
+            header[5 + i] = env().wallClockAtStart >> (8 * i);
+        fwrite(header, 1, sizeof(header), recordFile);
+        report = TraceReport();
+        report.bytes = sizeof(header);
+        lastRecordMs = 0;
+        return true;
+    }
+
+    bool traceReplay(const char *path)
+    {
+        FILE *file = fopen(path, "rb");
+        if (!file)
+            return false;
+        std::string data;
+        char chunk[4096];
+        size_t got;
+        while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0)
+            data.append(chunk, got);
+        fclose(file);
+
+        if (data.size() < 9 || data.compare(0, 4, TRACE_MAGIC, 4) != 0 || (uint8_t)data[4] != TRACE_VERSION)
+            return false;
+        uint32_t wallClock = 0;
+        for (int i = 0; i < 4; i++)
+            wallClock |= (uint32_t)(uint8_t)data[5 + i] << (8 * i);
+
+        report = TraceReport();
+        for (int kind = 0; kind < TRACE_KINDS; kind++)
+        {
+            loaded[kind].clear();
+            outputCursor[kind] = 0;
+        }
+        int64_t atMs = 0;
+        size_t pos = 9;
+        while (pos < data.size())
+        {
+            uint8_t kind = data[pos++];
+            uint64_t delta, length;
+            if (kind == 0 || kind >= TRACE_KINDS || !getVarint(data, pos, delta) || !getVarint(data, pos, length) ||
+                length > data.size() - pos)
+                return false;
+            atMs += (int64_t)(delta >> 1) ^ -(int64_t)(delta & 1);
+            loaded[kind].push_back(TraceRecord{atMs, data.substr(pos, length)});
+            pos += length;
+            report.records++;
+        }
+        report.bytes = data.size();
+        for (std::vector<TraceRecord> &records : loaded)
+            std::stable_sort(records.begin(), records.end(),
+                             [](const TraceRecord &a, const TraceRecord &b) { return a.atMs < b.atMs; });
+
+        // Serial input goes through the same script as --cmd
+        for (const TraceRecord &record : loaded[TRACE_SERIAL])
+        {
+            scheduleSerialInput((unsigned long)record.atMs, record.payload.c_str());
+            report.serialServed++;
+        }
+        report.servoWrites.recorded = loaded[TRACE_SERVO].size();
+        report.servoRests.recorded = loaded[TRACE_REST].size();
+        env().wallClockAtStart = wallClock;
+        replaying = true;
+        return true;
+    }
+
+    void traceFinish()
+    {
+        if (recordFile)
+        {
+            fclose(recordFile);
+            recordFile = nullptr;
+        }
+    }
+
+    bool traceReplaying()
+    {
+        return replaying;
+    }
+
+    int64_t traceDurationMs()
+    {
+        int64_t last = 0;
+        for (const std::vector<TraceRecord> &records : loaded)
+            if (!records.empty())
+                last = std::max(last, records.back().atMs);
+        return last;
+    }
+
+    const TraceReport &traceReport()
+    {
+        return report;
+    }
+
+    void traceDht(const uint8_t *bytes, const uint32_t *items, size_t count)
+    {
+        if (!recordFile)
+            return;
+        std::string payload;
+        if (count == 0)
+        {
+            payload += (char)0;
+        }
+        else if (bytes)
+        {
+            payload += (char)1;
+            payload.append((const char *)bytes, 5);
+        }
+        else
+        {
+            payload += (char)2;
+            for (size_t i = 0; i < count; i++)
+            {
+                for (int shift = 0; shift < 32; shift += 16)
+                {
+                    uint32_t half = items[i] >> shift & 0xFFFF;
+                    putVarint(payload, (half & 0x7FFF) << 1 | half >> 15);
+                }
+            }
+        }
+        writeRecord(TRACE_DHT, payload);
+    }
+
+    size_t traceServeDht(bool, uint32_t *items, size_t maxItems)
+    {
+        const TraceRecord *record = recordAt(TRACE_DHT, nowMillis());
+        if (!record || record->payload.empty())
+        {
+            report.missing++;
+            return 0;
+        }
+        report.dhtServed++;
+        const std::string &payload = record->payload;
+        if (payload[0] == 1 && payload.size() == 6)
+            return dhtEncode((const uint8_t *)payload.data() + 1, items, maxItems, 4);
+
+        size_t count = 0;
+        size_t pos = 1;
+        uint64_t half;
+        while (payload[0] == 2 && count / 2 < maxItems && getVarint(payload, pos, half))
+        {
+            uint32_t value = (uint32_t)(half >> 1 & 0x7FFF) | (uint32_t)(half & 1) << 15;
+            if (count % 2 == 0)
+                items[count / 2] = value;
+            else
+                items[count / 2] |= value << 16;
+            count++;
+        }
+        return (count + 1) / 2;
+    }
+
+    void traceHttp(int code, const char *body, size_t size)
+    {
+        if (!recordFile)
+            return;
+        std::string payload;
+        putVarint(payload, (uint64_t)code);
+        payload.append(body, size);
+        writeRecord(TRACE_HTTP, payload);
+    }
+
+    bool traceServeHttp(int &code, std::string &body)
+    {
+        const TraceRecord *record = recordAt(TRACE_HTTP, nowMillis());
+        uint64_t value;
+        size_t pos = 0;
+        if (!record || !getVarint(record->payload, pos, value))
+        {
+            report.missing++;
+            return false;
+        }
+        report.httpServed++;
+        code = (int)value;
+        body = record->payload.substr(pos);
+        return true;
+    }
+
+    void traceSerial(const std::string &text)
+    {
+        if (recordFile)
+            writeRecord(TRACE_SERIAL, text);
+    }
+
+    void traceServo(int angle, bool rest)
+    {
+        TraceKind kind = rest ? TRACE_REST : TRACE_SERVO;
+        if (recordFile)
+            writeRecord(kind, std::string(1, (char)angle));
+        if (!replaying || loaded[kind].empty())
+            return;
+
+        // Pair it with the next recorded output at the same time; without
+        // one, it should repeat what the recording last did
+        TraceOutputs &outputs = rest ? report.servoRests : report.servoWrites;
+        const std::vector<TraceRecord> &records = loaded[kind];
+        size_t &next = outputCursor[kind];
+        int64_t now = nowMillis();
+        while (next < records.size() && records[next].atMs < now)
+            next++;
+        const TraceRecord *record = next < records.size() && records[next].atMs == now ? &records[next++]
+                                                                                         : recordAt(kind, now);
+        int expected = record ? (uint8_t)record->payload[0] : -1;
+        outputs.replayed++;
+        if (expected != angle)
+        {
+            if (outputs.diverged++ == 0)
+            {
+                outputs.firstAtMs = now;
+                outputs.firstAngle = angle;
+                outputs.firstExpected = expected;
+            }
+        }
+    }
+}
@@ -0,0 +1,144 @@
+// WString.cpp - host stand-in for the Arduino String class
+#include "WString.h"
+#include <cctype>
+#include <cstdio>
+
+static std::string formatInteger(unsigned long value, unsigned char base, bool negative)
+{
+    char buf[8 * sizeof(long) + 2];
+    char *p = &buf[sizeof(buf) - 1];
+    *p = '\0';
+    if (base < 2)
+        base = 10;
+    do
+    {
+        unsigned long digit = value % base;
+        *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+        value /= base;
+    } while (value);
+    if (negative)
+        *--p = '-';
+    return std::string(p);
+}
+
+String::String(int value, unsigned char base) : String(long(value), base) {}
+
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(long value, unsigned char base)
+{
+    bool negative = base == 10 && value < 0;
+    str = formatInteger(negative ? 0UL - (unsigned long)value : (unsigned long)value, base, negative);
+}
+
+String::String(unsigned long value, unsigned char base) : str(formatInteger(value, base, false)) {}
+
+String::String(float value, unsigned int decimalPlaces) : String(double(value), decimalPlaces) {}
+
+String::String(double value, unsigned int decimalPlaces)
+{
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, value);
+    str = buf;
+}
+
+bool String::reserve(unsigned int size)
+{
+    str.reserve(size);
+    return true;
+}
+
+bool String::concat(const String &s)
+{
+    str += s.str;
+    return true;
+}
+
+bool String::concat(const char *s)
+{
+    if (!s)
+        return false;
+    str += s;
+    return true;
+}
+
+bool String::concat(char c)
+{
+    str += c;
+    return true;
+}
+
+bool String::startsWith(const String &prefix) const
+{
+    return str.compare(0, prefix.str.length(), prefix.str) == 0;
+}
+
+bool String::endsWith(const String &suffix) const
+{
+    return str.length() >= suffix.str.length() &&
+           str.compare(str.length() - suffix.str.length(), suffix.str.length(), suffix.str) == 0;
+}
+
+int String::indexOf(char c, unsigned int fromIndex) const
+{
+    size_t pos = str.find(c, fromIndex);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String &s, unsigned int fromIndex) const
+{
+    size_t pos = str.find(s.str, fromIndex);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int beginIndex) const
+{
+    return substring(beginIndex, str.length());
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const
+{
+    if (beginIndex > endIndex)
+    {
+        unsigned int tmp = beginIndex;
+        beginIndex = endIndex;
+        endIndex = tmp;
+    }
+    if (beginIndex >= str.length())
+        return String();
+    if (endIndex > str.length())
+        endIndex = str.length();
+    return String(str.substr(beginIndex, endIndex - beginIndex));
+}
+
+void String::trim()
+{
+    size_t begin = 0;
+    size_t end = str.length();
+    while (begin < end && isspace((unsigned char)str[begin]))
+        begin++;
+    while (end > begin && isspace((unsigned char)str[end - 1]))
+        end--;
+    str = str.substr(begin, end - begin);
+}
+
+void String::toLowerCase()
+{
+    for (char &c : str)
+        c = tolower((unsigned char)c);
+}
+
+String operator+(const String &lhs, const String &rhs)
+{
+    return String(lhs.str + rhs.str);
+}
+
+String operator+(const String &lhs, const char *rhs)
+{
+    return String(lhs.str + (rhs ? rhs : ""));
+}
+
+String operator+(const char *lhs, const String &rhs)
+{
+    return String((lhs ? lhs : "") + rhs.str);
+}
@@ -0,0 +1,78 @@
+// WString.h - host stand-in for the Arduino String class
+#ifndef NATIVE_WSTRING_H
+#define NATIVE_WSTRING_H
+
+#include <string>
+#include <cstdlib>
+
+class __FlashStringHelper;
+
+// Backed by std::string so heap traffic shows up in the host allocation counter.
+// Like the ESP32 core, short strings stay inline (small string optimisation).
+class String
+{
+private:
+    std::string str;
+
+public:
+    String() {}
+    String(const char *s) : str(s ? s : "") {}
+    String(const std::string &s) : str(s) {}
+    String(const __FlashStringHelper *s) : str(reinterpret_cast<const char *>(s)) {}
+    explicit String(char c) : str(1, c) {}
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(float value, unsigned int decimalPlaces = 2);
+    explicit String(double value, unsigned int decimalPlaces = 2);
+
+    unsigned int length() const { return str.length(); }
+    const char *c_str() const { return str.c_str(); }
+    bool reserve(unsigned int size);
+
+    bool concat(const String &s);
+    bool concat(const char *s);
+    bool concat(char c);
+    bool concat(int value) { return concat(String(value)); }
+    bool concat(unsigned int value) { return concat(String(value)); }
+    bool concat(long value) { return concat(String(value)); }
+    bool concat(unsigned long value) { return concat(String(value)); }
+    bool concat(float value) { return concat(String(value)); }
+    bool concat(double value) { return concat(String(value)); }
+
+    template <typename T>
+    String &operator+=(const T &rhs)
+    {
+        concat(rhs);
+        return *this;
+    }
+
+    bool equals(const String &s) const { return str == s.str; }
+    bool equals(const char *s) const { return str == (s ? s : ""); }
+    bool operator==(const String &s) const { return equals(s); }
+    bool operator==(const char *s) const { return equals(s); }
+    bool operator!=(const String &s) const { return !equals(s); }
+    bool operator!=(const char *s) const { return !equals(s); }
+
+    char charAt(unsigned int index) const { return index < str.length() ? str[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+
+    bool startsWith(const String &prefix) const;
+    bool endsWith(const String &suffix) const;
+    int indexOf(char c, unsigned int fromIndex = 0) const;
+    int indexOf(const String &s, unsigned int fromIndex = 0) const;
+    String substring(unsigned int beginIndex) const;
+    String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+    void trim();
+    void toLowerCase();
+    long toInt() const { return std::strtol(str.c_str(), nullptr, 10); }
+    float toFloat() const { return std::strtof(str.c_str(), nullptr); }
+
+    friend String operator+(const String &lhs, const String &rhs);
+    friend String operator+(const String &lhs, const char *rhs);
+    friend String operator+(const char *lhs, const String &rhs);
+};
+
+#endif // NATIVE_WSTRING_H
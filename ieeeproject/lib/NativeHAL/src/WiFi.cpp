@@ -0,0 +1,121 @@
+// WiFi.cpp - host stand-in for the ESP32 WiFi station API
+#include "WiFi.h"
+#include "NativeHal.h"
+#include <cstring>
+
+WiFiClass WiFi;
+
+static uint8_t apBssid[6] = {0x24, 0x0A, 0xC4, 0x5E, 0x21, 0x90};
+static WiFiEventCb disconnectCallback = nullptr;
+static unsigned long lastLookupMs = 0;
+static bool lookupCached = false;
+
+static void raiseDisconnect()
+{
+    if (disconnectCallback)
+        disconnectCallback(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+}
+
+wl_status_t WiFiClass::begin(const char *, const char *, int32_t channel, const uint8_t *bssid, bool connect)
+{
+    hal::counters().wifiBegins++;
+    started = connect;
+    beginTime = millis();
+
+    const hal::Environment &env = hal::env();
+    bool directed = channel > 0 && bssid;
+    associateMs = env.wifiAssociateMs;
+    if (directed)
+        associateMs -= env.wifiScanMs;
+    if ((uint32_t)staticIP != 0)
+        associateMs -= env.wifiDhcpMs;
+
+    // Decided up front; status() reports it once the association time passed
+    joined = hal::wifiApUp(beginTime + associateMs) &&
+             (!directed || (channel == env.wifiChannel && memcmp(bssid, apBssid, sizeof(apBssid)) == 0));
+    return status();
+}
+
+bool WiFiClass::config(IPAddress localIP, IPAddress, IPAddress, IPAddress)
+{
+    // All zeros goes back to DHCP, as on the device
+    staticIP = localIP;
+    return true;
+}
+
+bool WiFiClass::disconnect(bool)
+{
+    started = false;
+    return true;
+}
+
+int WiFiClass::onEvent(WiFiEventCb cb, arduino_event_id_t event)
+{
+    if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED || event == ARDUINO_EVENT_MAX)
+    {
+        disconnectCallback = cb;
+        hal::setWiFiEventCallback(raiseDisconnect);
+    }
+    return 1;
+}
+
+wl_status_t WiFiClass::status()
+{
+    if (!started)
+        return WL_DISCONNECTED;
+    unsigned long joinedAt = beginTime + associateMs;
+    if (millis() < joinedAt)
+        return WL_DISCONNECTED;
+    if (!joined)
+        return WL_NO_SSID_AVAIL;
+    if (!hal::wifiApUpBetween(joinedAt, millis()))
+        return WL_CONNECTION_LOST;
+    return WL_CONNECTED;
+}
+
+int WiFiClass::hostByName(const char *, IPAddress &result)
+{
+    if (status() != WL_CONNECTED)
+        return 0;
+    if (!lookupCached || millis() - lastLookupMs >= hal::env().dnsTtlMs)
+    {
+        hal::counters().dnsLookups++;
+        hal::advanceMicros((uint64_t)hal::env().dnsLookupMs * 1000);
+        lastLookupMs = millis();
+        lookupCached = true;
+    }
+    result = IPAddress(104, 21, 40, 125);
+    return 1;
+}
+
+IPAddress WiFiClass::localIP()
+{
+    if (status() != WL_CONNECTED)
+        return IPAddress();
+    return (uint32_t)staticIP != 0 ? staticIP : IPAddress(192, 168, 1, 42);
+}
+
+IPAddress WiFiClass::gatewayIP()
+{
+    return status() == WL_CONNECTED ? IPAddress(192, 168, 1, 1) : IPAddress();
+}
+
+IPAddress WiFiClass::subnetMask()
+{
+    return status() == WL_CONNECTED ? IPAddress(255, 255, 255, 0) : IPAddress();
+}
+
+IPAddress WiFiClass::dnsIP(uint8_t)
+{
+    return gatewayIP();
+}
+
+uint8_t *WiFiClass::BSSID()
+{
+    return status() == WL_CONNECTED ? apBssid : nullptr;
+}
+
+int32_t WiFiClass::channel()
+{
+    return status() == WL_CONNECTED ? hal::env().wifiChannel : 0;
+}
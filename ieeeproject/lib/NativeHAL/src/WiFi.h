@@ -0,0 +1,82 @@
+// WiFi.h - host stand-in for the ESP32 WiFi station API
+#ifndef NATIVE_WIFI_H
+#define NATIVE_WIFI_H
+
+#include <Arduino.h>
+#include "WiFiClient.h"
+
+typedef enum
+{
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum
+{
+    WIFI_OFF = 0,
+    WIFI_STA = 1
+} wifi_mode_t;
+
+// Only the station disconnect event is ever raised
+typedef enum
+{
+    ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+    ARDUINO_EVENT_WIFI_STA_GOT_IP,
+    ARDUINO_EVENT_MAX
+} arduino_event_id_t;
+
+typedef void (*WiFiEventCb)(arduino_event_id_t event);
+
+// A single access point on hal::env().wifiChannel. Association completes
+// hal::env().wifiAssociateMs after begin(), less wifiScanMs when begin() names
+// the AP's BSSID and channel and less wifiDhcpMs with a static IP from
+// config(). It fails if the AP is down at that point or is not where begin()
+// said; an outage after that drops the link until the next begin().
+class WiFiClass
+{
+private:
+    bool started = false;
+    bool modemSleep = false;
+    bool joined = false;
+    unsigned long beginTime = 0;
+    unsigned long associateMs = 0;
+    IPAddress staticIP;
+
+public:
+    wl_status_t begin(const char *ssid, const char *passphrase = nullptr, int32_t channel = 0,
+                      const uint8_t *bssid = nullptr, bool connect = true);
+    bool config(IPAddress localIP, IPAddress gateway, IPAddress subnet, IPAddress dns1 = IPAddress());
+    bool disconnect(bool wifioff = false);
+    bool mode(wifi_mode_t) { return true; }
+    void persistent(bool) {}
+    bool setAutoReconnect(bool) { return true; }
+    int onEvent(WiFiEventCb cb, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+    wl_status_t status();
+
+    // Charges hal::env().dnsLookupMs unless the name was looked up within
+    // dnsTtlMs; every name resolves to the same address
+    int hostByName(const char *host, IPAddress &result);
+
+    IPAddress localIP();
+    IPAddress gatewayIP();
+    IPAddress subnetMask();
+    IPAddress dnsIP(uint8_t = 0);
+    uint8_t *BSSID();
+    int32_t channel();
+
+    bool setSleep(bool enabled)
+    {
+        modemSleep = enabled;
+        return true;
+    }
+    bool getSleep() const { return modemSleep; }
+};
+
+extern WiFiClass WiFi;
+
+#endif // NATIVE_WIFI_H
@@ -0,0 +1,37 @@
+// WiFiClient.cpp - host stand-in for the ESP32 TCP client
+#include "WiFiClient.h"
+#include "NativeHal.h"
+
+int WiFiClient::connect(const char *, uint16_t)
+{
+    open = true;
+    return 1;
+}
+
+void WiFiClient::stop()
+{
+    open = false;
+    rx.clear();
+    rxPos = 0;
+}
+
+int WiFiClient::read()
+{
+    if (rxPos >= rx.size())
+        return -1;
+    if (byteMicros)
+        hal::advanceMicros(byteMicros);
+    return (unsigned char)rx[rxPos++];
+}
+
+int WiFiClient::peek()
+{
+    return rxPos < rx.size() ? (unsigned char)rx[rxPos] : -1;
+}
+
+void WiFiClient::load(const char *data, size_t size, uint32_t byteMicros)
+{
+    rx.assign(data, size);
+    rxPos = 0;
+    this->byteMicros = byteMicros;
+}
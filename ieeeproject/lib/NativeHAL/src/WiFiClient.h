@@ -0,0 +1,37 @@
+// WiFiClient.h - host stand-in for the ESP32 TCP client
+#ifndef NATIVE_WIFI_CLIENT_H
+#define NATIVE_WIFI_CLIENT_H
+
+#include <Arduino.h>
+#include <string>
+
+// Reads back whatever the stand-in server loaded into it with load(); writes
+// are accepted and dropped. connect() always succeeds at no cost.
+class WiFiClient : public Stream
+{
+protected:
+    std::string rx;
+    size_t rxPos = 0;
+    uint32_t byteMicros = 0;
+    bool open = false;
+
+public:
+    virtual ~WiFiClient() {}
+
+    virtual int connect(const char *host, uint16_t port);
+    uint8_t connected() { return open || available() > 0; }
+    void stop();
+
+    int available() override { return (int)(rx.size() - rxPos); }
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t) override { return open ? 1 : 0; }
+    size_t write(const uint8_t *, size_t size) override { return open ? size : 0; }
+    using Print::write;
+
+    // Host only: make data readable as if it had arrived from the peer,
+    // charging byteMicros of virtual time for each byte read
+    void load(const char *data, size_t size, uint32_t byteMicros = 0);
+};
+
+#endif // NATIVE_WIFI_CLIENT_H
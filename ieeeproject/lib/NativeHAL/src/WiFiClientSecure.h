@@ -0,0 +1,20 @@
+// WiFiClientSecure.h - host stand-in for the ESP32 TLS client
+#ifndef NATIVE_WIFI_CLIENT_SECURE_H
+#define NATIVE_WIFI_CLIENT_SECURE_H
+
+#include "WiFiClient.h"
+
+// connect() charges hal::env().tcpConnectMs and a full tlsHandshakeMs: like
+// arduino-esp32, it keeps no TLS session to resume from. The host name form
+// resolves through WiFi.hostByName() first; the address form takes the host
+// for SNI only. The certificates are ignored, as after setInsecure().
+class WiFiClientSecure : public WiFiClient
+{
+public:
+    int connect(const char *host, uint16_t port) override;
+    int connect(IPAddress ip, uint16_t port, const char *host, const char *CA_cert, const char *cert,
+                const char *private_key);
+    void setInsecure() {}
+};
+
+#endif // NATIVE_WIFI_CLIENT_SECURE_H
@@ -0,0 +1,54 @@
+// Wire.cpp - host stand-in for the ESP32 I2C driver
+#include "Wire.h"
+#include "NativeHal.h"
+
+TwoWire Wire;
+
+bool TwoWire::begin(int, int, uint32_t frequency)
+{
+    if (frequency)
+        this->frequency = frequency;
+    return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency)
+{
+    this->frequency = frequency;
+    return true;
+}
+
+void TwoWire::beginTransmission(uint8_t)
+{
+    inTransmission = true;
+    pendingBytes = 0;
+}
+
+size_t TwoWire::write(uint8_t)
+{
+    if (!inTransmission)
+        return 0;
+    pendingBytes++;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *, size_t size)
+{
+    if (!inTransmission)
+        return 0;
+    pendingBytes += size;
+    return size;
+}
+
+uint8_t TwoWire::endTransmission(bool)
+{
+    if (!inTransmission)
+        return 4;
+    inTransmission = false;
+
+    hal::counters().wireTransactions++;
+    hal::counters().wireBytes += pendingBytes;
+    // Start + address byte + ack + stop is roughly 11 bit times of overhead
+    uint64_t bits = pendingBytes * 9 + 11;
+    hal::advanceMicros(bits * 1000000 / frequency);
+    return 0;
+}
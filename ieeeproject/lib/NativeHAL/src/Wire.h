@@ -0,0 +1,32 @@
+// Wire.h - host stand-in for the ESP32 I2C driver
+#ifndef NATIVE_WIRE_H
+#define NATIVE_WIRE_H
+
+#include <Arduino.h>
+
+// Bytes the ESP32 driver accepts per transaction
+#define I2C_BUFFER_LENGTH 128
+
+// Every byte put on the bus is counted and charged to the virtual clock at the
+// configured SCL frequency (9 bit times per byte, plus start/address/stop)
+class TwoWire
+{
+private:
+    uint32_t frequency = 100000;
+    size_t pendingBytes = 0;
+    bool inTransmission = false;
+
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    bool setClock(uint32_t frequency);
+    uint32_t getClock() const { return frequency; }
+
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t data);
+    size_t write(const uint8_t *data, size_t size);
+    uint8_t endTransmission(bool sendStop = true);
+};
+
+extern TwoWire Wire;
+
+#endif // NATIVE_WIRE_H
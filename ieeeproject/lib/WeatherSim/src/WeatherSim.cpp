@@ -0,0 +1,300 @@
+#include "WeatherSim.h"
+
+// cos(2 pi k / 24) in thousandths: one entry per hour of the day
+static const int16_t HOURLY_COS[24] = {1000, 966,  866,  707,  500,  259,  0,   -259, -500, -707, -866, -966,
+                                       -1000, -966, -866, -707, -500, -259, 0,   259,  500,  707,  866,  966};
+
+// How each sky shapes the hour: share of the clear-sky swing, offset from the
+// daily mean, sunlight reaching the room, forecast chance of precipitation,
+// typical wind and humidity
+struct SkyEffect
+{
+    int16_t swingPermille;
+    int16_t offsetDeciF;
+    int16_t sunPermille;
+    uint8_t chancePercent;
+    uint16_t windDeciMph;
+    int32_t humidityMilli;
+};
+
+static const SkyEffect SKY_EFFECTS[(int)SimSky::Count] = {
+    {1000, 0, 1000, 0, 40, 50000},     // Clear
+    {800, 0, 600, 10, 60, 60000},      // PartlyCloudy
+    {500, -10, 250, 35, 90, 75000},    // Overcast
+    {300, -30, 100, 85, 130, 95000},   // Precipitation
+};
+
+static const uint32_t HOUR_MS = 3600 * 1000UL;
+static const int16_t MAX_ANOMALY_DECI_F = 150;
+static const int32_t START_INDOOR_MICRO_F = 72000000;
+
+// Cosine of a time of day in seconds, in thousandths, linear within the hour
+static int32_t cosPermille(int64_t seconds)
+{
+    int64_t s = seconds % 86400;
+    if (s < 0)
+    {
+        s += 86400;
+    }
+    int k = (int)(s / 3600);
+    int32_t frac = (int32_t)(s % 3600);
+    return HOURLY_COS[k] + (HOURLY_COS[(k + 1) % 24] - HOURLY_COS[k]) * frac / 3600;
+}
+
+static int32_t lerp(int32_t from, int32_t to, uint64_t atMs)
+{
+    return from + (int32_t)((int64_t)(to - from) * (int64_t)(atMs % HOUR_MS) / HOUR_MS);
+}
+
+const RoomModel::Params RoomModel::DEFAULT_PARAMS = {
+    10 * HOUR_MS, // Walls
+    HOUR_MS / 2,  // Window
+    1500,
+    2000,
+    45000,
+};
+
+RoomModel::RoomModel(const Params &params) : params(params), indoor(START_INDOOR_MICRO_F), humidity(params.baseHumidityMilli)
+{
+}
+
+void RoomModel::setParams(const Params &params)
+{
+    this->params = params;
+}
+
+void RoomModel::setIndoor(int32_t microF, int32_t humidityMilli)
+{
+    indoor = microF;
+    humidity = humidityMilli;
+}
+
+void RoomModel::step(uint32_t dtMs, int32_t outdoorMicroF, int32_t outdoorHumidityMilli, int windowDeg,
+                     int sunPermille)
+{
+    int64_t diff = (int64_t)outdoorMicroF - indoor;
+    int64_t open = (int64_t)dtMs * windowDeg;
+    int64_t leak = diff * dtMs / params.wallTauMs + diff * open / (180LL * params.windowTauMs);
+    int64_t gainMilli = params.gainMilliFPerHour + (int64_t)params.sunGainMilliFPerHour * sunPermille / 1000;
+    indoor += (int32_t)(leak + gainMilli * 1000 * dtMs / HOUR_MS);
+
+    // Outdoor air through the window, the room's own level through the walls
+    int64_t toOutdoor = (int64_t)(outdoorHumidityMilli - humidity) * open / (180LL * params.windowTauMs);
+    int64_t toBase = (int64_t)(params.baseHumidityMilli - humidity) * dtMs / params.wallTauMs;
+    humidity += (int32_t)(toOutdoor + toBase);
+    humidity = humidity < 0 ? 0 : humidity > 100000 ? 100000 : humidity;
+}
+
+int32_t RoomModel::indoorMicroF() const
+{
+    return indoor;
+}
+
+int32_t RoomModel::humidityMilli() const
+{
+    return humidity;
+}
+
+// A showery temperate climate: mostly fair, rain spells of a few hours
+const WeatherSim::Params WeatherSim::DEFAULT_PARAMS = {
+    660,
+    100,
+    15,
+    5,
+    {
+        {85, 12, 3, 0},  // From clear
+        {10, 75, 13, 2}, // From partly cloudy
+        {3, 14, 70, 13}, // From overcast
+        {0, 5, 25, 70},  // From rain
+    },
+};
+
+WeatherSim::WeatherSim(uint32_t seed, uint32_t startSecondOfDay, const Params &params) : params(params)
+{
+    reset(seed, startSecondOfDay);
+}
+
+void WeatherSim::reset(uint32_t seed, uint32_t startSecondOfDay)
+{
+    rngState = seed ? seed : 1;
+    startSecond = startSecondOfDay % 86400;
+    nowMs = 0;
+    steps = 0;
+    generated = 0;
+    window = 0;
+    roomModel.setIndoor(START_INDOOR_MICRO_F, RoomModel::DEFAULT_PARAMS.baseHumidityMilli);
+}
+
+uint32_t WeatherSim::nextRandom(uint32_t range)
+{
+    // xorshift32, its own so the caller's random() sequence is left alone
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState % range;
+}
+
+int WeatherSim::randomBetween(int low, int high)
+{
+    return low + (int)nextRandom(high - low + 1);
+}
+
+const WeatherSim::Hour &WeatherSim::hour(uint32_t index)
+{
+    while (generated <= index)
+    {
+        // The first hour draws from partly cloudy, so seeds start differently
+        SimSky from = SimSky::PartlyCloudy;
+        int16_t anomaly = 0;
+        if (generated > 0)
+        {
+            const Hour &previous = hours[(generated - 1) % SIM_HOURS_KEPT];
+            from = previous.sky;
+            anomaly = previous.anomalyDeciF;
+        }
+
+        Hour next;
+        uint32_t roll = nextRandom(100);
+        int sky = 0;
+        while (sky < (int)SimSky::Count - 1 && roll >= params.transitionPercent[(int)from][sky])
+        {
+            roll -= params.transitionPercent[(int)from][sky];
+            sky++;
+        }
+        next.sky = (SimSky)sky;
+
+        // The daily mean wanders, pulled back over a day or so
+        anomaly += randomBetween(-params.wanderDeciF, params.wanderDeciF) - anomaly / 24;
+        next.anomalyDeciF = anomaly < -MAX_ANOMALY_DECI_F ? -MAX_ANOMALY_DECI_F
+                            : anomaly > MAX_ANOMALY_DECI_F ? MAX_ANOMALY_DECI_F
+                                                           : anomaly;
+        next.windDeciMph = SKY_EFFECTS[sky].windDeciMph + randomBetween(-20, 20);
+        next.precipitationCentiMm = next.sky == SimSky::Precipitation ? randomBetween(20, 250) : 0;
+        hours[generated % SIM_HOURS_KEPT] = next;
+        generated++;
+    }
+    uint32_t oldest = generated > SIM_HOURS_KEPT ? generated - SIM_HOURS_KEPT : 0;
+    return hours[(index < oldest ? oldest : index) % SIM_HOURS_KEPT];
+}
+
+// Daily mean, drift and the sky's offset at the start of an hour; the
+// day-night swing is added at the exact time
+int32_t WeatherSim::hourMicroF(uint32_t index)
+{
+    const Hour &h = hour(index);
+    return ((int32_t)params.meanDeciF + h.anomalyDeciF + SKY_EFFECTS[(int)h.sky].offsetDeciF) * 100000;
+}
+
+void WeatherSim::advanceTo(uint64_t atMs)
+{
+    while (nowMs < atMs)
+    {
+        uint32_t dt = atMs - nowMs < STEP_MS ? (uint32_t)(atMs - nowMs) : STEP_MS;
+        roomModel.step(dt, outdoorMicroFAt(nowMs), outdoorHumidityMilliAt(nowMs), window, sunPermilleAt(nowMs));
+        nowMs += dt;
+        steps++;
+    }
+}
+
+uint64_t WeatherSim::now() const
+{
+    return nowMs;
+}
+
+void WeatherSim::setWindow(int deg)
+{
+    window = deg < 0 ? 0 : deg > 180 ? 180 : deg;
+}
+
+RoomModel &WeatherSim::room()
+{
+    return roomModel;
+}
+
+int32_t WeatherSim::outdoorMicroFAt(uint64_t atMs)
+{
+    uint32_t index = (uint32_t)(atMs / HOUR_MS);
+    int32_t base = lerp(hourMicroF(index), hourMicroF(index + 1), atMs);
+    int32_t swing = lerp(SKY_EFFECTS[(int)hour(index).sky].swingPermille,
+                         SKY_EFFECTS[(int)hour(index + 1).sky].swingPermille, atMs);
+    int64_t seconds = startSecond + (int64_t)(atMs / 1000) - params.warmestHour * 3600;
+    return base + (int32_t)((int64_t)params.swingDeciF * 100000 * swing / 1000 * cosPermille(seconds) / 1000);
+}
+
+SimSky WeatherSim::skyAt(uint64_t atMs)
+{
+    return hour((uint32_t)(atMs / HOUR_MS)).sky;
+}
+
+int WeatherSim::wmoCodeAt(uint64_t atMs)
+{
+    const Hour &h = hour((uint32_t)(atMs / HOUR_MS));
+    switch (h.sky)
+    {
+    case SimSky::Clear:
+        return 0;
+    case SimSky::PartlyCloudy:
+        return 2;
+    case SimSky::Overcast:
+        return 3;
+    default:
+        break;
+    }
+    bool heavy = h.precipitationCentiMm > 150;
+    if (outdoorMicroFAt(atMs) < 32000000)
+    {
+        return heavy ? 73 : 71; // Snow
+    }
+    return heavy ? 63 : 61;
+}
+
+uint8_t WeatherSim::precipitationChanceAt(uint64_t atMs)
+{
+    return SKY_EFFECTS[(int)skyAt(atMs)].chancePercent;
+}
+
+uint16_t WeatherSim::precipitationCentiMmAt(uint64_t atMs)
+{
+    return hour((uint32_t)(atMs / HOUR_MS)).precipitationCentiMm;
+}
+
+uint16_t WeatherSim::windDeciMphAt(uint64_t atMs)
+{
+    return hour((uint32_t)(atMs / HOUR_MS)).windDeciMph;
+}
+
+int32_t WeatherSim::outdoorHumidityMilliAt(uint64_t atMs)
+{
+    uint32_t index = (uint32_t)(atMs / HOUR_MS);
+    int32_t humidity = lerp(SKY_EFFECTS[(int)hour(index).sky].humidityMilli,
+                            SKY_EFFECTS[(int)hour(index + 1).sky].humidityMilli, atMs);
+    // Driest in the warmth of the afternoon
+    int64_t seconds = startSecond + (int64_t)(atMs / 1000) - params.warmestHour * 3600;
+    humidity -= 15 * cosPermille(seconds);
+    return humidity < 10000 ? 10000 : humidity > 100000 ? 100000 : humidity;
+}
+
+int WeatherSim::sunPermilleAt(uint64_t atMs)
+{
+    // Up at 7, highest at 13, down at 19
+    int64_t seconds = startSecond + (int64_t)(atMs / 1000) - 13 * 3600;
+    int32_t sun = cosPermille(seconds);
+    if (sun <= 0)
+    {
+        return 0;
+    }
+    uint32_t index = (uint32_t)(atMs / HOUR_MS);
+    int32_t sky = lerp(SKY_EFFECTS[(int)hour(index).sky].sunPermille,
+                       SKY_EFFECTS[(int)hour(index + 1).sky].sunPermille, atMs);
+    return sun * sky / 1000;
+}
+
+uint64_t WeatherSim::getSteps() const
+{
+    return steps;
+}
+
+uint32_t WeatherSim::getHoursGenerated() const
+{
+    return generated;
+}
@@ -0,0 +1,132 @@
+// WeatherSim.h - seeded outdoor weather and the room behind the window
+//
+// Deterministic for a given seed and plausible enough to exercise the
+// controller: temperatures follow the day, shaded and damped by cloud and
+// rain, and the sky moves between states on hourly Markov transitions. The
+// room is a first-order thermal model leaking toward the outdoor air, far
+// faster with the window open. All integer math, so it steps cheaply on the
+// FPU-less C3 and millions of times a second on a host.
+#ifndef WEATHER_SIM_H
+#define WEATHER_SIM_H
+
+#include <cstddef>
+#include <cstdint>
+
+enum class SimSky : uint8_t
+{
+    Clear,
+    PartlyCloudy,
+    Overcast,
+    Precipitation, // Rain, or snow below freezing
+    Count
+};
+
+// Temperatures are in millionths of a degree Fahrenheit ("micro-F") so slow
+// leaks do not vanish in rounding at short steps; humidity in thousandths of
+// a percent.
+class RoomModel
+{
+public:
+    struct Params
+    {
+        uint32_t wallTauMs;           // Time constant toward outdoor with the window shut
+        uint32_t windowTauMs;         // Of the window alone, fully open
+        int32_t gainMilliFPerHour;    // Occupants and appliances
+        int32_t sunGainMilliFPerHour; // Extra at full sun
+        int32_t baseHumidityMilli;    // Where humidity settles with the window shut
+    };
+    static const Params DEFAULT_PARAMS;
+
+    RoomModel(const Params &params = DEFAULT_PARAMS);
+
+    void setParams(const Params &params);
+    void setIndoor(int32_t microF, int32_t humidityMilli);
+
+    // Advance dtMs with the outdoor air, the window at windowDeg (0-180) and
+    // sun in thousandths of full; explicit Euler, so keep dtMs to a minute
+    // or so against the window's time constant
+    void step(uint32_t dtMs, int32_t outdoorMicroF, int32_t outdoorHumidityMilli, int windowDeg,
+              int sunPermille);
+
+    int32_t indoorMicroF() const;
+    int32_t humidityMilli() const;
+
+private:
+    Params params;
+    int32_t indoor;
+    int32_t humidity;
+};
+
+// Outdoor weather from a seed. Hours are generated ahead as they are asked
+// for and the last SIM_HOURS_KEPT kept, so a forecast a day out reads the
+// same hours the sim will later step through.
+#define SIM_HOURS_KEPT 64
+
+class WeatherSim
+{
+public:
+    struct Params
+    {
+        int16_t meanDeciF;      // Daily mean outdoor temperature
+        int16_t swingDeciF;     // Half the clear-sky day-night range
+        uint8_t warmestHour;    // Of a clear day, local time
+        int16_t wanderDeciF;    // Most the daily mean drifts in one hour
+        uint8_t transitionPercent[(int)SimSky::Count][(int)SimSky::Count]; // Hourly, rows sum to 100
+    };
+    static const Params DEFAULT_PARAMS;
+
+    static const uint32_t STEP_MS = 60 * 1000; // Longest room step advanceTo() takes
+
+    // startSecondOfDay is local time of day at sim time 0
+    WeatherSim(uint32_t seed = 1, uint32_t startSecondOfDay = 0, const Params &params = DEFAULT_PARAMS);
+    void reset(uint32_t seed, uint32_t startSecondOfDay);
+
+    // Step the room up to atMs of sim time; earlier times are ignored
+    void advanceTo(uint64_t atMs);
+    uint64_t now() const;
+
+    // Where the room's window is, 0 closed to 180 fully open
+    void setWindow(int deg);
+    RoomModel &room();
+
+    // Outdoor conditions at any time up to a day or so past the newest hour
+    // generated; earlier than the hours kept reads the oldest kept
+    int32_t outdoorMicroFAt(uint64_t atMs);
+    SimSky skyAt(uint64_t atMs);
+    int wmoCodeAt(uint64_t atMs);          // Open-Meteo weather_code
+    uint8_t precipitationChanceAt(uint64_t atMs);
+    uint16_t precipitationCentiMmAt(uint64_t atMs); // Over the hour
+    uint16_t windDeciMphAt(uint64_t atMs);
+    int32_t outdoorHumidityMilliAt(uint64_t atMs);
+    int sunPermilleAt(uint64_t atMs);      // Sunlight reaching the room, of full
+
+    // Whole-sim counters, for soak runs
+    uint64_t getSteps() const;
+    uint32_t getHoursGenerated() const;
+
+private:
+    struct Hour
+    {
+        SimSky sky;
+        int16_t anomalyDeciF; // Drift of the daily mean
+        uint16_t windDeciMph;
+        uint16_t precipitationCentiMm;
+    };
+
+    Params params;
+    uint32_t rngState;
+    uint32_t startSecond;
+    uint64_t nowMs = 0;
+    uint64_t steps = 0;
+    Hour hours[SIM_HOURS_KEPT];
+    uint32_t generated = 0; // Hours generated so far; hour n lives at n % SIM_HOURS_KEPT
+    int window = 0;
+    RoomModel roomModel;
+
+    uint32_t nextRandom(uint32_t range);
+    int randomBetween(int low, int high);
+    const Hour &hour(uint32_t index);
+    int32_t hourMicroF(uint32_t index);
+};
+
+#endif // WEATHER_SIM_H
@@ -0,0 +1,48 @@
+#include "AdaptiveRate.h"
+
+AdaptiveRate::AdaptiveRate(unsigned long minMs, unsigned long maxMs, unsigned long startMs)
+    : minMs(minMs), maxMs(maxMs), intervalMs(constrain(startMs, minMs, maxMs))
+{
+}
+
+void AdaptiveRate::hurry()
+{
+    // Already at the shortest, nothing changes and it is not counted
+    if (intervalMs > minMs)
+    {
+        intervalMs = minMs;
+        hurries++;
+    }
+}
+
+void AdaptiveRate::relax(unsigned long ceilingMs)
+{
+    unsigned long limit = max(min(maxMs, ceilingMs), minMs);
+    intervalMs = intervalMs > limit / 2 ? limit : intervalMs * 2;
+    relaxes++;
+}
+
+unsigned long AdaptiveRate::interval() const
+{
+    return intervalMs;
+}
+
+unsigned long AdaptiveRate::getMin() const
+{
+    return minMs;
+}
+
+unsigned long AdaptiveRate::getMax() const
+{
+    return maxMs;
+}
+
+uint32_t AdaptiveRate::getHurries() const
+{
+    return hurries;
+}
+
+uint32_t AdaptiveRate::getRelaxes() const
+{
+    return relaxes;
+}
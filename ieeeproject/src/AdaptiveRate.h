@@ -0,0 +1,36 @@
+#ifndef ADAPTIVE_RATE_H
+#define ADAPTIVE_RATE_H
+
+#include <Arduino.h>
+#include <climits>
+
+// A polling interval that follows the signal: hurry() drops it to the
+// shortest when something is happening, relax() doubles it up to the longest
+// while nothing is. Polls come in fast while conditions change and thin out
+// while they hold, instead of one fixed rate that is either wasteful or slow.
+class AdaptiveRate
+{
+private:
+    unsigned long minMs;
+    unsigned long maxMs;
+    unsigned long intervalMs;
+    uint32_t hurries = 0;
+    uint32_t relaxes = 0;
+
+public:
+    AdaptiveRate(unsigned long minMs, unsigned long maxMs, unsigned long startMs);
+
+    // Something changed: poll again after the shortest interval
+    void hurry();
+
+    // Nothing did: twice as long, up to the longest or to ceilingMs if lower
+    void relax(unsigned long ceilingMs = ULONG_MAX);
+
+    unsigned long interval() const;
+    unsigned long getMin() const;
+    unsigned long getMax() const;
+    uint32_t getHurries() const; // hurry() calls that shortened the interval
+    uint32_t getRelaxes() const;
+};
+
+#endif // ADAPTIVE_RATE_H
@@ -0,0 +1,127 @@
+#include "CommandParser.h"
+#include <cstdlib>
+#include <cstring>
+
+int CommandParser::poll(Stream &input)
+{
+    int lines = 0;
+    while (input.available() > 0)
+    {
+        int c = input.read();
+        if (c >= 0 && feed((char)c))
+        {
+            lines++;
+        }
+    }
+    return lines;
+}
+
+bool CommandParser::feed(char c)
+{
+    if (c == '\r' || c == '\n')
+    {
+        // CR LF gives an empty second line, which is dropped here
+        bool complete = length > 0 || overflowed;
+        if (overflowed)
+        {
+            Serial.println("Command too long, ignored");
+        }
+        else if (length > 0)
+        {
+            line[length] = '\0';
+            dispatch();
+        }
+        length = 0;
+        overflowed = false;
+        return complete;
+    }
+
+    if (c == '\b' || c == 0x7F)
+    {
+        // Backspace from a terminal
+        if (length > 0)
+        {
+            length--;
+        }
+        return false;
+    }
+
+    if (length < COMMAND_LINE_MAX)
+    {
+        line[length++] = c;
+    }
+    else
+    {
+        overflowed = true;
+    }
+    return false;
+}
+
+void CommandParser::dispatch()
+{
+    // Split "  name   args  " into a name and trimmed arguments, in place
+    char *name = line;
+    while (*name == ' ' || *name == '\t')
+    {
+        name++;
+    }
+    char *end = line + length;
+    while (end > name && (end[-1] == ' ' || end[-1] == '\t'))
+    {
+        *--end = '\0';
+    }
+    if (*name == '\0')
+    {
+        return;
+    }
+
+    char *args = name;
+    while (*args && *args != ' ' && *args != '\t')
+    {
+        args++;
+    }
+    if (*args)
+    {
+        *args++ = '\0';
+        while (*args == ' ' || *args == '\t')
+        {
+            args++;
+        }
+    }
+
+    for (size_t i = 0; i < commandCount; i++)
+    {
+        if (strcmp(name, commands[i].name) == 0)
+        {
+            commands[i].handler(args);
+            return;
+        }
+    }
+    Serial.print("Unknown command: ");
+    Serial.print(name);
+    Serial.println(" (try \"help\")");
+}
+
+void CommandParser::printHelp(Print &out) const
+{
+    for (size_t i = 0; i < commandCount; i++)
+    {
+        out.printf("  %-16s %s\n", commands[i].name, commands[i].help);
+    }
+}
+
+bool parseIntArg(const char *args, long min, long max, long &value)
+{
+    if (*args == '\0')
+    {
+        return false;
+    }
+    char *end;
+    long parsed = strtol(args, &end, 10);
+    if (*end != '\0' || parsed < min || parsed > max)
+    {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
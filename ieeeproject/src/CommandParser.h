@@ -0,0 +1,53 @@
+#ifndef COMMAND_PARSER_H
+#define COMMAND_PARSER_H
+
+#include <Arduino.h>
+
+// Longest command line accepted, terminator excluded
+#define COMMAND_LINE_MAX 48
+
+// A handler gets the rest of the line after the command name, trimmed
+// (empty when there is none)
+typedef void (*CommandHandler)(const char *args);
+
+struct Command
+{
+    const char *name;
+    CommandHandler handler;
+    const char *help;
+};
+
+// Assembles lines one byte at a time into a fixed buffer and dispatches each
+// complete line through a command table. Never waits for input and never
+// allocates, so a half-typed line costs nothing until its newline arrives.
+class CommandParser
+{
+private:
+    const Command *commands;
+    size_t commandCount;
+    char line[COMMAND_LINE_MAX + 1];
+    size_t length = 0;
+    bool overflowed = false;
+
+    void dispatch();
+
+public:
+    template <size_t N>
+    constexpr CommandParser(const Command (&table)[N]) : commands(table), commandCount(N), line()
+    {
+    }
+
+    // Feed every byte that has already arrived; returns the lines dispatched
+    int poll(Stream &input);
+
+    // Feed one byte; returns true when it completed a line
+    bool feed(char c);
+
+    // Print every command with its help text
+    void printHelp(Print &out) const;
+};
+
+// Parse a whole decimal argument within [min, max]
+bool parseIntArg(const char *args, long min, long max, long &value);
+
+#endif // COMMAND_PARSER_H
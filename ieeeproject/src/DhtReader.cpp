@@ -0,0 +1,239 @@
+#include "DhtReader.h"
+#include <cstring>
+#include "trace_capture.h"
+
+#ifdef NATIVE_BUILD
+#include "NativeHal.h"
+#endif
+
+// Datasheet timings, widened for part-to-part spread and RMT rounding
+#define RESPONSE_MIN_US 40 // Response low and high, nominally 80 us each
+#define RESPONSE_MAX_US 120
+#define BIT_LOW_MIN_US 30 // Low before every bit, nominally 50 us
+#define BIT_LOW_MAX_US 90
+#define BIT_HIGH_MIN_US 10 // High of a 0 is 26-28 us, of a 1 70 us
+#define BIT_HIGH_MAX_US 100
+#define BIT_ONE_MIN_US 48
+
+// A capture ends once the line has idled this long, longer than any pulse
+// of a reply; the start signal is cut off into a capture of its own
+#define RMT_IDLE_US 200
+
+static bool inRange(uint16_t us, uint16_t min, uint16_t max)
+{
+    return us >= min && us <= max;
+}
+
+static DhtStatus fail(DhtReading &reading, DhtStatus status)
+{
+    reading.status = status;
+    reading.temperatureC = NAN;
+    reading.humidity = NAN;
+    return status;
+}
+
+DhtStatus dhtDecode(const DhtPulse *pulses, size_t count, uint8_t type, DhtReading &reading)
+{
+    memset(reading.bytes, 0, sizeof(reading.bytes));
+
+    // Skip whatever precedes the response: the end of the start signal, and
+    // the few microseconds the released line sits high
+    size_t i = 0;
+    while (i + 1 < count && !(pulses[i].level == LOW && inRange(pulses[i].us, RESPONSE_MIN_US, RESPONSE_MAX_US) &&
+                              pulses[i + 1].level == HIGH &&
+                              inRange(pulses[i + 1].us, RESPONSE_MIN_US, RESPONSE_MAX_US)))
+    {
+        i++;
+    }
+    if (i + 1 >= count)
+    {
+        return fail(reading, DHT_NO_RESPONSE);
+    }
+    i += 2;
+
+    for (int bit = 0; bit < 40; bit++, i += 2)
+    {
+        if (i + 1 >= count)
+        {
+            return fail(reading, DHT_TRUNCATED);
+        }
+        const DhtPulse &low = pulses[i];
+        const DhtPulse &high = pulses[i + 1];
+        if (low.level != LOW || high.level != HIGH || !inRange(low.us, BIT_LOW_MIN_US, BIT_LOW_MAX_US) ||
+            !inRange(high.us, BIT_HIGH_MIN_US, BIT_HIGH_MAX_US))
+        {
+            return fail(reading, DHT_BAD_TIMING);
+        }
+        reading.bytes[bit / 8] = reading.bytes[bit / 8] << 1 | (high.us >= BIT_ONE_MIN_US);
+    }
+
+    const uint8_t *b = reading.bytes;
+    if (((b[0] + b[1] + b[2] + b[3]) & 0xFF) != b[4])
+    {
+        return fail(reading, DHT_BAD_CHECKSUM);
+    }
+
+    if (type == DHT11)
+    {
+        // Integer and tenths bytes; the sign sits in the tenths of the temperature
+        reading.humidity = b[0] + b[1] * 0.1f;
+        reading.temperatureC = b[2] + (b[3] & 0x7F) * 0.1f;
+        if (b[3] & 0x80)
+        {
+            reading.temperatureC = -reading.temperatureC;
+        }
+    }
+    else
+    {
+        // Tenths in 16 bits, sign and magnitude for the temperature
+        reading.humidity = (b[0] << 8 | b[1]) * 0.1f;
+        reading.temperatureC = ((b[2] & 0x7F) << 8 | b[3]) * 0.1f;
+        if (b[2] & 0x80)
+        {
+            reading.temperatureC = -reading.temperatureC;
+        }
+    }
+    reading.status = DHT_OK;
+    return DHT_OK;
+}
+
+size_t dhtUnpackItems(const uint32_t *items, size_t itemCount, DhtPulse *pulses, size_t maxPulses)
+{
+    // Per item: duration0 in bits 0-14, level0 in bit 15, then the same again
+    size_t count = 0;
+    for (size_t i = 0; i < itemCount; i++)
+    {
+        for (int half = 0; half < 2; half++)
+        {
+            uint16_t bits = items[i] >> (16 * half);
+            if ((bits & 0x7FFF) == 0 || count == maxPulses)
+            {
+                return count;
+            }
+            pulses[count].us = bits & 0x7FFF;
+            pulses[count].level = bits >> 15;
+            count++;
+        }
+    }
+    return count;
+}
+
+const char *dhtStatusLabel(DhtStatus status)
+{
+    static const char *const LABELS[] = {"ok", "no response", "truncated", "bad timing", "bad checksum"};
+    return status <= DHT_BAD_CHECKSUM ? LABELS[status] : "?";
+}
+
+DhtReader::DhtReader(uint8_t pin, uint8_t type) : pin(pin), type(type) {}
+
+bool DhtReader::begin()
+{
+#ifndef NATIVE_BUILD
+    // 1 us ticks, and the input filter drops glitches under ~3 us (255 APB
+    // cycles)
+    rmt = rmtInit(pin, RMT_RX_MODE, RMT_MEM_64);
+    if (!rmt)
+    {
+        return false;
+    }
+    rmtSetTick(rmt, 1000);
+    rmtSetFilter(rmt, true, 255);
+    rmtSetRxThreshold(rmt, RMT_IDLE_US);
+
+    // Open drain leaves the pad's input, and so the RMT, connected while the
+    // start signal is driven; the module's pull-up holds the line high
+    pinMode(pin, OUTPUT_OPEN_DRAIN);
+    digitalWrite(pin, HIGH);
+
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = release;
+    timerArgs.arg = this;
+    timerArgs.name = "dht";
+    if (esp_timer_create(&timerArgs, &releaseTimer) != ESP_OK)
+    {
+        return false;
+    }
+    return rmtRead(rmt, receive, this);
+#else
+    return true;
+#endif
+}
+
+bool DhtReader::start()
+{
+    if (isBusy())
+    {
+        return false;
+    }
+    startedAt = millis();
+    state = HOLDING;
+    digitalWrite(pin, LOW);
+#ifndef NATIVE_BUILD
+    esp_timer_start_once(releaseTimer, START_SIGNAL_MS * 1000);
+#endif
+    return true;
+}
+
+bool DhtReader::isBusy() const
+{
+    uint8_t current = state;
+    return current == HOLDING || current == LISTENING;
+}
+
+// Timer task: end the start signal and let the sensor answer
+void DhtReader::release(void *arg)
+{
+    DhtReader *reader = static_cast<DhtReader *>(arg);
+    reader->state = LISTENING;
+    digitalWrite(reader->pin, HIGH);
+}
+
+// RMT driver task: one capture, ended by RMT_IDLE_US of quiet line
+void DhtReader::receive(uint32_t *items, size_t count, void *arg)
+{
+    DhtReader *reader = static_cast<DhtReader *>(arg);
+    if (reader->state != LISTENING)
+    {
+        return; // The start signal, or noise between reads
+    }
+    DhtPulse pulses[DHT_MAX_PULSES];
+    size_t pulseCount = dhtUnpackItems(items, count, pulses, DHT_MAX_PULSES);
+    dhtDecode(pulses, pulseCount, reader->type, reader->reading);
+    reader->state = DONE;
+}
+
+bool DhtReader::take(DhtReading &out)
+{
+#ifdef NATIVE_BUILD
+    // No timer or RMT task on the host: once the start signal is over, run
+    // the reply the HAL synthesizes through the same path
+    if (state == HOLDING && millis() - startedAt >= START_SIGNAL_MS)
+    {
+        release(this);
+        uint32_t items[DHT_MAX_PULSES / 2];
+        size_t count = hal::dhtCapture(type == DHT11, items, DHT_MAX_PULSES / 2);
+        if (count > 0)
+        {
+            receive(items, count, this);
+        }
+    }
+#endif
+
+    uint8_t current = state;
+    if (current != DONE && (current == IDLE || millis() - startedAt < READ_TIMEOUT_MS))
+    {
+        return false;
+    }
+    // A silent line never ends a capture, so the driver has nothing to say
+    if (current != DONE && state.compare_exchange_strong(current, IDLE))
+    {
+        out = {};
+        fail(out, DHT_NO_RESPONSE);
+        CAPTURE_DHT(startedAt, out);
+        return true;
+    }
+    out = reading;
+    state = IDLE;
+    CAPTURE_DHT(startedAt, out);
+    return true;
+}
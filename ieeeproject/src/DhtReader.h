@@ -0,0 +1,98 @@
+#ifndef DHT_READER_H
+#define DHT_READER_H
+
+#include <Arduino.h>
+#include <atomic>
+
+#ifndef NATIVE_BUILD
+#include <esp_timer.h>
+#include <esp32-hal-rmt.h>
+#endif
+
+#define DHT11 11
+#define DHT22 22
+
+// Pulses in one reply: the line going high on release, the 80 us low/high
+// response, 40 bits of low + high, and the closing low
+#define DHT_MAX_PULSES 96
+
+// One level held on the data line, as the RMT peripheral records it
+struct DhtPulse
+{
+    uint16_t us;
+    uint8_t level;
+};
+
+enum DhtStatus : uint8_t
+{
+    DHT_OK,
+    DHT_NO_RESPONSE,  // No 80 us low/high response in the capture
+    DHT_TRUNCATED,    // Capture ended before all 40 bits
+    DHT_BAD_TIMING,   // A pulse outside the datasheet tolerances (noise, glitch)
+    DHT_BAD_CHECKSUM,
+};
+
+struct DhtReading
+{
+    DhtStatus status;
+    float temperatureC;
+    float humidity;
+    uint8_t bytes[5]; // As received, checksum last
+};
+
+// Decode one captured reply. Pure: no hardware and no clock, so recorded or
+// synthetic traces can be run through it on the host.
+DhtStatus dhtDecode(const DhtPulse *pulses, size_t count, uint8_t type, DhtReading &reading);
+
+// RMT items (two levels and durations per 32-bit word, as the driver hands
+// them over) unpacked into pulses; stops at the zero-length end marker
+size_t dhtUnpackItems(const uint32_t *items, size_t itemCount, DhtPulse *pulses, size_t maxPulses);
+
+const char *dhtStatusLabel(DhtStatus status);
+
+// Reads a DHT11/DHT22 without blocking. start() pulls the line low; a timer
+// releases it START_SIGNAL_MS later and the RMT peripheral records the reply
+// with 1 us timestamps, so nothing waits on the bus and interrupts stay on.
+// The reply is decoded on the RMT driver's task and collected with take().
+class DhtReader
+{
+private:
+    enum State : uint8_t
+    {
+        IDLE,
+        HOLDING,   // Start signal on the line
+        LISTENING, // Line released, reply on its way
+        DONE,      // reading holds a result not yet taken
+    };
+
+    uint8_t pin;
+    uint8_t type;
+    std::atomic<uint8_t> state{IDLE};
+    unsigned long startedAt = 0;
+    DhtReading reading = {};
+#ifndef NATIVE_BUILD
+    rmt_obj_t *rmt = nullptr;
+    esp_timer_handle_t releaseTimer = nullptr;
+#endif
+
+    static void release(void *arg);
+    static void receive(uint32_t *items, size_t count, void *arg);
+
+public:
+    static const unsigned long START_SIGNAL_MS = 20;  // DHT11 wants at least 18
+    static const unsigned long READ_TIMEOUT_MS = 100; // Start to give up on a reply
+
+    DhtReader(uint8_t pin, uint8_t type);
+
+    bool begin();
+
+    // Send the start signal; false if a read is already running
+    bool start();
+    bool isBusy() const;
+
+    // The result of the last read, once: false while it runs. A reply that
+    // never comes shows up as DHT_NO_RESPONSE after READ_TIMEOUT_MS.
+    bool take(DhtReading &out);
+};
+
+#endif // DHT_READER_H
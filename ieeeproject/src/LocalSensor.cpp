@@ -1,43 +1,77 @@
 #include "LocalSensor.h"
+#include "stats.h"
+#include "log.h"
 
 LocalSensor::LocalSensor(uint8_t pin, uint8_t type) : dht(pin, type) {}
 
 void LocalSensor::begin()
 {
-    dht.begin();
-    Serial.println("DHT sensor initialized");
+    if (!dht.begin())
+    {
+        LOG(DHT_NO_CAPTURE);
+        return;
+    }
+    LOG(DHT_READY);
 }
 
-bool LocalSensor::update(bool force)
+SensorResult LocalSensor::update()
 {
-    unsigned long currentMillis = millis();
+    DhtReading reading;
+    if (!dht.take(reading))
+    {
+        if (!dht.isBusy())
+        {
+            dht.start();
+            readStartedAt = micros();
+        }
+        return SENSOR_READING;
+    }
+    STATS_RECORD(PROBE_SENSOR, micros() - readStartedAt);
 
-    if (!force && currentMillis - lastReadTime < READ_INTERVAL)
+    if (reading.status != DHT_OK)
     {
-        return false;
+        LOG(DHT_FAILED, dhtStatusLabel(reading.status));
+        STATS_COUNT(COUNT_DHT_FAILURES);
+        return SENSOR_FAILED;
     }
 
-    float newHumidity = dht.readHumidity();
-    float newTemperature = dht.readTemperature(true); // true = Fahrenheit
+    // Humidity counts as moved at 2 %RH, the DHT11's tolerance is 5
+    float fahrenheit = reading.temperatureC * 9 / 5 + 32;
+    changed = !hasReading || fahrenheit != temperature || fabsf(reading.humidity - humidity) >= 2;
+    humidity = reading.humidity;
+    temperature = fahrenheit;
+    hasReading = true;
+
+    LOG(DHT_READING, temperature, humidity);
 
-    if (isnan(newHumidity) || isnan(newTemperature))
+    return SENSOR_UPDATED;
+}
+
+unsigned long LocalSensor::nextReadInterval(int targetDeci)
+{
+    if (changed)
     {
-        Serial.println("Failed to read from DHT sensor!");
-        return false;
+        readRate.hurry();
     }
+    else if (abs((int)lroundf(temperature * 10) - targetDeci) > OFF_TARGET_DECI)
+    {
+        readRate.relax(OFF_TARGET_INTERVAL);
+    }
+    else
+    {
+        readRate.relax();
+    }
+    return readRate.interval();
+}
 
-    humidity = newHumidity;
-    temperature = newTemperature;
-    lastReadTime = currentMillis;
-
-    Serial.print("Local Temperature: ");
-    Serial.print(temperature);
-    Serial.println(" °F");
-    Serial.print("Local Humidity: ");
-    Serial.print(humidity);
-    Serial.println(" %");
+const AdaptiveRate &LocalSensor::getReadRate() const
+{
+    return readRate;
+}
 
-    return true;
+bool LocalSensor::isValid() const
+{
+    return hasReading;
 }
 
 float LocalSensor::getTemperature() const
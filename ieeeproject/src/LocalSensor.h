@@ -2,21 +2,55 @@
 #define LOCAL_SENSOR_H
 
 #include <Arduino.h>
-#include <DHT.h>
+#include "AdaptiveRate.h"
+#include "DhtReader.h"
+
+// What a call to LocalSensor::update() got done
+enum SensorResult : uint8_t
+{
+    SENSOR_READING, // A read is under way
+    SENSOR_UPDATED,
+    SENSOR_FAILED,
+};
 
 class LocalSensor
 {
 private:
-    DHT dht;
+    DhtReader dht;
     float temperature = 0;
     float humidity = 0;
-    unsigned long lastReadTime = 0;
-    const unsigned long READ_INTERVAL = 30000; // 30 seconds
+    bool hasReading = false;
+    bool changed = false;            // The last update moved the reading
+    unsigned long readStartedAt = 0; // micros()
+    AdaptiveRate readRate{READ_INTERVAL_MIN, READ_INTERVAL_MAX, READ_INTERVAL_MIN};
 
 public:
+    // Between successful reads: the shortest while the reading moves, backing
+    // off to the longest while it holds. The DHT11 reports whole degrees C,
+    // so a room drifting slowly still shows a step every few minutes.
+    static const unsigned long READ_INTERVAL_MIN = 15000;
+    static const unsigned long READ_INTERVAL_MAX = 240000;
+    static const unsigned long OFF_TARGET_INTERVAL = 60000; // Longest while the room is off target
+    static const int OFF_TARGET_DECI = 20;                  // Off target by more than 2 F
+    static const unsigned long RETRY_INTERVAL = 2000; // DHT11 minimum between reads
+    // Start signal plus the ~5 ms reply
+    static const unsigned long POLL_INTERVAL = DhtReader::START_SIGNAL_MS + 10;
+
     LocalSensor(uint8_t pin, uint8_t type);
+
     void begin();
-    bool update(bool force = false);
+
+    // Start a read, or collect the one under way. Never waits on the bus.
+    SensorResult update();
+
+    // After SENSOR_UPDATED: the ms until the next read. Back to the shortest
+    // interval when the reading moved; otherwise stretched, but kept to
+    // OFF_TARGET_INTERVAL while the room is far from targetDeci, where the
+    // window is about to act on it.
+    unsigned long nextReadInterval(int targetDeci);
+    const AdaptiveRate &getReadRate() const;
+
+    bool isValid() const; // False until the first successful read
     float getTemperature() const;
     float getHumidity() const;
 };
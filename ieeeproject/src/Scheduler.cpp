@@ -0,0 +1,228 @@
+#include "Scheduler.h"
+#include <climits>
+#include "power.h"
+#include "stats.h"
+
+Scheduler::Scheduler()
+{
+    for (int i = 0; i < SCHEDULER_SLOTS; i++)
+    {
+        slots[i] = -1;
+    }
+}
+
+void Scheduler::begin()
+{
+    lastMillis = millis();
+    clockMs = lastMillis;
+    nextTick = clockMs / SCHEDULER_TICK_MS;
+#ifndef NATIVE_BUILD
+    loopTask = xTaskGetCurrentTaskHandle();
+#endif
+}
+
+uint64_t Scheduler::now()
+{
+    unsigned long current = millis();
+    clockMs += current - lastMillis; // Unsigned difference survives the millis() wrap
+    lastMillis = current;
+    return clockMs;
+}
+
+JobId Scheduler::add(const char *name, JobFn fn, unsigned long firstRunMs)
+{
+    if (jobCount >= SCHEDULER_MAX_JOBS)
+    {
+        return -1;
+    }
+
+    JobId id = jobCount++;
+    jobs[id] = {name, fn, 0, -1, -1, false, 0};
+    runAfter(id, firstRunMs);
+    return id;
+}
+
+void Scheduler::arm(JobId id, uint64_t deadline)
+{
+    disarm(id);
+
+    // Round up to a whole tick, and never into a tick that already expired
+    uint64_t tick = (deadline + SCHEDULER_TICK_MS - 1) / SCHEDULER_TICK_MS;
+    if (tick < nextTick)
+    {
+        tick = nextTick;
+    }
+
+    Job &job = jobs[id];
+    int8_t &head = slots[tick & (SCHEDULER_SLOTS - 1)];
+    job.deadline = tick * SCHEDULER_TICK_MS;
+    job.prev = -1;
+    job.next = head;
+    if (head >= 0)
+    {
+        jobs[head].prev = id;
+    }
+    head = id;
+    job.armed = true;
+}
+
+void Scheduler::disarm(JobId id)
+{
+    Job &job = jobs[id];
+    if (!job.armed)
+    {
+        return;
+    }
+
+    if (job.prev >= 0)
+    {
+        jobs[job.prev].next = job.next;
+    }
+    else
+    {
+        slots[(job.deadline / SCHEDULER_TICK_MS) & (SCHEDULER_SLOTS - 1)] = job.next;
+    }
+    if (job.next >= 0)
+    {
+        jobs[job.next].prev = job.prev;
+    }
+    job.armed = false;
+}
+
+void Scheduler::runAfter(JobId id, unsigned long delayMs)
+{
+    if (id < 0 || id >= jobCount)
+    {
+        return;
+    }
+
+    if (delayMs == 0)
+    {
+        disarm(id);
+        triggered.fetch_or(1u << id, std::memory_order_relaxed);
+    }
+    else
+    {
+        arm(id, now() + delayMs);
+    }
+}
+
+void Scheduler::trigger(JobId id)
+{
+    if (id < 0 || id >= jobCount)
+    {
+        return;
+    }
+
+    triggered.fetch_or(1u << id, std::memory_order_release);
+#ifndef NATIVE_BUILD
+    // Not from an ISR: driver callbacks run on their own tasks
+    if (loopTask)
+    {
+        xTaskNotifyGive(loopTask);
+    }
+#endif
+}
+
+void Scheduler::run(JobId id)
+{
+    disarm(id);
+    Job &job = jobs[id];
+    job.runs++;
+
+    unsigned long next = job.fn();
+    if (next > 0)
+    {
+        arm(id, now() + next);
+    }
+}
+
+void Scheduler::runDue()
+{
+    uint64_t current = now();
+    uint64_t currentTick = current / SCHEDULER_TICK_MS;
+    uint32_t due = triggered.exchange(0, std::memory_order_acquire);
+
+    // Walk the slots of every tick since the last pass, each slot at most once.
+    // A slot also holds jobs from later turns of the wheel, which stay put.
+    if (currentTick >= nextTick)
+    {
+        uint64_t ticks = currentTick - nextTick + 1;
+        if (ticks > SCHEDULER_SLOTS)
+        {
+            ticks = SCHEDULER_SLOTS;
+        }
+        for (uint64_t tick = nextTick; tick < nextTick + ticks; tick++)
+        {
+            for (int8_t id = slots[tick & (SCHEDULER_SLOTS - 1)]; id >= 0; id = jobs[id].next)
+            {
+                if (jobs[id].deadline <= current)
+                {
+                    due |= 1u << id;
+                }
+            }
+        }
+        nextTick = currentTick + 1;
+    }
+
+    for (JobId id = 0; id < jobCount; id++)
+    {
+        if (due & (1u << id))
+        {
+            run(id);
+        }
+    }
+}
+
+unsigned long Scheduler::msUntilNext()
+{
+    if (triggered.load(std::memory_order_acquire))
+    {
+        return 0;
+    }
+
+    uint64_t current = now();
+    unsigned long wait = ULONG_MAX;
+    for (JobId id = 0; id < jobCount; id++)
+    {
+        if (!jobs[id].armed)
+        {
+            continue;
+        }
+        if (jobs[id].deadline <= current)
+        {
+            return 0;
+        }
+        if (jobs[id].deadline - current < wait)
+        {
+            wait = jobs[id].deadline - current;
+        }
+    }
+    return wait;
+}
+
+void Scheduler::sleepUntilNext()
+{
+    unsigned long wait = msUntilNext();
+    if (wait > 0)
+    {
+#if STATS_ENABLED
+        unsigned long sleepStart = micros();
+#endif
+        // The power module picks how deep; trigger() ends the wait early
+        powerSleep(wait);
+#if STATS_ENABLED
+        // Only a sleep that ran to its deadline says anything about lateness
+        unsigned long slept = micros() - sleepStart;
+        if (slept >= (uint64_t)wait * 1000)
+        {
+            STATS_RECORD(PROBE_WAKE_LATENESS, slept - wait * 1000);
+        }
+#endif
+    }
+}
+
+uint32_t Scheduler::getRuns(JobId id) const
+{
+    return id >= 0 && id < jobCount ? jobs[id].runs : 0;
+}
@@ -0,0 +1,77 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Hashed timer wheel: jobs hang off the slot of their deadline tick, so
+// arming, cancelling and expiring are O(1) and a wakeup only walks the slots
+// for the ticks that passed. The loop task sleeps until the next deadline.
+#define SCHEDULER_MAX_JOBS 8
+#define SCHEDULER_SLOTS 64   // Power of two
+#define SCHEDULER_TICK_MS 10 // Wheel resolution
+
+// A job does its work and returns the milliseconds until it should run again,
+// or 0 to stay parked until trigger() or runAfter()
+typedef unsigned long (*JobFn)();
+typedef int8_t JobId;
+
+class Scheduler
+{
+private:
+    struct Job
+    {
+        const char *name;
+        JobFn fn;
+        uint64_t deadline; // In ms on the scheduler clock
+        int8_t prev;
+        int8_t next;
+        bool armed;
+        uint32_t runs;
+    };
+
+    Job jobs[SCHEDULER_MAX_JOBS];
+    int8_t slots[SCHEDULER_SLOTS];
+    uint8_t jobCount = 0;
+    uint64_t clockMs = 0;        // millis() widened so deadlines never wrap
+    unsigned long lastMillis = 0;
+    uint64_t nextTick = 0;       // First tick not yet expired
+    std::atomic<uint32_t> triggered{0};
+#ifndef NATIVE_BUILD
+    TaskHandle_t loopTask = nullptr;
+#endif
+
+    uint64_t now();
+    void arm(JobId id, uint64_t deadline);
+    void disarm(JobId id);
+    void run(JobId id);
+
+public:
+    Scheduler();
+
+    // Call from the task that will run the jobs
+    void begin();
+
+    // Register a job; it first runs after firstRunMs (0 = on the next pass)
+    JobId add(const char *name, JobFn fn, unsigned long firstRunMs);
+
+    // Move a job's next run to delayMs from now. Loop task only.
+    void runAfter(JobId id, unsigned long delayMs);
+
+    // Run a job on the next pass and cut the current sleep short. Safe from
+    // other tasks and driver callbacks.
+    void trigger(JobId id);
+
+    // Run every job that is due or triggered
+    void runDue();
+
+    // Milliseconds until the earliest armed job, ULONG_MAX if none
+    unsigned long msUntilNext();
+
+    // Sleep until the next deadline or trigger(), through powerSleep()
+    void sleepUntilNext();
+
+    uint32_t getRuns(JobId id) const;
+};
+
+#endif // SCHEDULER_H
@@ -0,0 +1,210 @@
+#include "ServoMotion.h"
+#include "trace_capture.h"
+
+// Integer square root; the C3 has no FPU, and a plan needs one at most
+static uint32_t isqrt(uint64_t value)
+{
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+MotionPlan planMotion(int from, int to, int32_t maxSpeed, int32_t accel)
+{
+    MotionPlan plan = {};
+    plan.fromMdeg = from * 1000;
+    plan.toMdeg = to * 1000;
+    plan.accel = accel;
+    int64_t distance = abs(to - from) * 1000;
+    if (distance == 0)
+    {
+        return plan;
+    }
+
+    // Covered while speeding up at accel for t ms: accel * t^2 / 2000 mdeg
+    plan.rampMs = maxSpeed * 1000 / accel;
+    int64_t rampMdeg = (int64_t)accel * plan.rampMs * plan.rampMs / 2000;
+    if (2 * rampMdeg >= distance)
+    {
+        // Triangular: turn around halfway, before reaching maxSpeed
+        plan.rampMs = isqrt(distance * 1000 / accel);
+        plan.peakMdegPerS = accel * plan.rampMs;
+        return plan;
+    }
+    plan.peakMdegPerS = maxSpeed * 1000;
+    plan.cruiseMs = (distance - 2 * rampMdeg) * 1000 / plan.peakMdegPerS;
+    return plan;
+}
+
+int32_t motionPositionAt(const MotionPlan &plan, uint32_t t)
+{
+    uint32_t total = motionDurationMs(plan);
+    if (t >= total)
+    {
+        return plan.toMdeg;
+    }
+    // Acceleration from the start and deceleration into the end are
+    // measured from their own ends, so the move lands on the target exactly
+    int32_t accel = plan.accel;
+    int64_t travelled;
+    if (t < plan.rampMs)
+    {
+        travelled = (int64_t)accel * t * t / 2000;
+    }
+    else if (t < plan.rampMs + plan.cruiseMs)
+    {
+        travelled = (int64_t)accel * plan.rampMs * plan.rampMs / 2000 +
+                    (int64_t)plan.peakMdegPerS * (t - plan.rampMs) / 1000;
+    }
+    else
+    {
+        uint32_t left = total - t;
+        int32_t remaining = (int64_t)accel * left * left / 2000;
+        return plan.toMdeg > plan.fromMdeg ? plan.toMdeg - remaining : plan.toMdeg + remaining;
+    }
+    return plan.toMdeg > plan.fromMdeg ? plan.fromMdeg + travelled : plan.fromMdeg - travelled;
+}
+
+uint32_t motionDurationMs(const MotionPlan &plan)
+{
+    return 2 * plan.rampMs + plan.cruiseMs;
+}
+
+ServoMotion::ServoMotion(uint8_t pin) : pin(pin) {}
+
+void ServoMotion::attach()
+{
+    servo.attach(pin);
+    servo.write(position);
+    attachedAt = millis();
+}
+
+void ServoMotion::begin(int angle)
+{
+    position = target = constrain(angle, 0, 180);
+    attach();
+    state = HOLDING;
+    startedAt = millis();
+}
+
+void ServoMotion::moveTo(int angle)
+{
+    angle = constrain(angle, 0, 180);
+    if (angle == target && state != DETACHED)
+    {
+        return;
+    }
+    if (state == MOVING)
+    {
+        stats.movingMs += millis() - startedAt;
+    }
+    else if (state == DETACHED)
+    {
+        if (angle == position)
+        {
+            return;
+        }
+        attach();
+    }
+
+    target = angle;
+    plan = planMotion(position, target, MAX_SPEED, ACCEL);
+    startedAt = millis();
+    state = MOVING;
+    stats.moves++;
+    stats.degrees += abs(target - position);
+}
+
+unsigned long ServoMotion::update()
+{
+    unsigned long elapsed = millis() - startedAt;
+    switch (state)
+    {
+    case MOVING:
+    {
+        int angle = (motionPositionAt(plan, elapsed) + 500) / 1000;
+        if (angle != position)
+        {
+            position = angle;
+            servo.write(angle);
+        }
+        if (elapsed < motionDurationMs(plan))
+        {
+            return STEP_MS;
+        }
+        stats.movingMs += elapsed;
+        state = HOLDING;
+        startedAt = millis();
+        return HOLD_MS;
+    }
+    case HOLDING:
+        if (elapsed < HOLD_MS)
+        {
+            return HOLD_MS - elapsed;
+        }
+        servo.detach();
+        CAPTURE_REST(position);
+        stats.detaches++;
+        stats.attachedMs += millis() - attachedAt;
+        state = DETACHED;
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+bool ServoMotion::isMoving() const
+{
+    return state == MOVING;
+}
+
+int ServoMotion::getPosition() const
+{
+    return position;
+}
+
+int ServoMotion::getTarget() const
+{
+    return target;
+}
+
+unsigned long ServoMotion::settledFor() const
+{
+    if (state == MOVING)
+    {
+        return 0;
+    }
+    // A detached arm has been settled since its hold started
+    return millis() - startedAt;
+}
+
+const ServoMotionStats &ServoMotion::getStats()
+{
+    reported = stats;
+    if (state == MOVING)
+    {
+        reported.movingMs += millis() - startedAt;
+    }
+    if (state != DETACHED)
+    {
+        reported.attachedMs += millis() - attachedAt;
+    }
+    return reported;
+}
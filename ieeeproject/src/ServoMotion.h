@@ -0,0 +1,97 @@
+#ifndef SERVO_MOTION_H
+#define SERVO_MOTION_H
+
+#include <Arduino.h>
+#include <Servo.h>
+
+// A trapezoidal move: accelerate to at most the peak speed, cruise, and
+// decelerate to rest on the target. Moves too short to reach full speed turn
+// triangular. Integer only, positions in millidegrees and times in ms.
+struct MotionPlan
+{
+    int32_t fromMdeg;
+    int32_t toMdeg;
+    uint32_t rampMs;   // Each of the acceleration and deceleration phases
+    uint32_t cruiseMs;
+    int32_t peakMdegPerS;
+    int32_t accel;     // deg/s^2, which is also mdeg/s per ms
+};
+
+// Plan a move between two angles, in degrees, degrees/s and degrees/s^2.
+// Pure, like motionPositionAt(), so trajectories can be checked on the host.
+MotionPlan planMotion(int from, int to, int32_t maxSpeed, int32_t accel);
+
+// Where a plan puts the arm t ms after it started, in millidegrees
+int32_t motionPositionAt(const MotionPlan &plan, uint32_t t);
+
+uint32_t motionDurationMs(const MotionPlan &plan);
+
+struct ServoMotionStats
+{
+    uint32_t moves;      // Moves started
+    uint32_t detaches;   // Times the PWM was released after holding a target
+    uint32_t degrees;    // Planned travel, summed over all moves
+    uint64_t movingMs;   // Time spent following a plan
+    uint64_t attachedMs; // Time with the PWM driving, moving or holding
+};
+
+// Drives a hobby servo along planned moves without blocking. update() writes
+// the next point of the plan once per PWM frame and says when to call it
+// again; once a target has been held for HOLD_MS the PWM is detached, so the
+// servo stops drawing holding current and stops hunting around the target.
+// The window's own friction keeps it where it is.
+class ServoMotion
+{
+private:
+    enum State : uint8_t
+    {
+        DETACHED,
+        MOVING,
+        HOLDING, // On target, PWM still driving
+    };
+
+    Servo servo;
+    uint8_t pin;
+    State state = DETACHED;
+    int position = 0; // Last angle written
+    int target = 0;
+    MotionPlan plan = {};
+    unsigned long startedAt = 0;  // Of the move, or of the hold
+    unsigned long attachedAt = 0;
+    ServoMotionStats stats = {};
+    ServoMotionStats reported = {};
+
+    void attach();
+
+public:
+    static const int32_t MAX_SPEED = 90;       // deg/s; a full 180 degree swing takes 2.5 s
+    static const int32_t ACCEL = 180;          // deg/s^2, to full speed in 0.5 s
+    static const unsigned long STEP_MS = 20;   // One 50 Hz PWM frame
+    static const unsigned long HOLD_MS = 500;  // On target before the PWM is released
+
+    ServoMotion(uint8_t pin);
+
+    // Attach and put the servo at an angle. Its position at power-up is
+    // unknown, so this first write is the one move that is not planned.
+    void begin(int angle);
+
+    // Start a move from wherever the arm is now; a move already running is
+    // replaced, starting again from rest
+    void moveTo(int angle);
+
+    // Step the move or finish the hold; the ms until the next call, or 0 once
+    // detached with nothing to do
+    unsigned long update();
+
+    bool isMoving() const;
+    int getPosition() const;
+    int getTarget() const;
+
+    // ms the arm has been at rest on its target, 0 while it moves
+    unsigned long settledFor() const;
+
+    // Counters, with the current move or hold brought up to date
+    const ServoMotionStats &getStats();
+};
+
+#endif // SERVO_MOTION_H
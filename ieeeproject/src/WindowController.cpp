@@ -1,110 +1,100 @@
 #include "WindowController.h"
+#include "stats.h"
+#include "log.h"
 
-WindowController::WindowController(uint8_t servoPin) : pin(servoPin) {}
-
-void WindowController::begin()
+// Temperatures are compared as whole tenths of a degree; the C3 has no FPU
+static int toDeciDegrees(float fahrenheit)
 {
-    servo.attach(pin);
-    setPosition(0); // Start with window closed
-    Serial.println("Window controller initialized");
+    return (int)lroundf(fahrenheit * 10);
 }
 
-void WindowController::performInitialTest()
-{
-    Serial.println("Testing window controller...");
-
-    // Close window
-    setPosition(0);
-    delay(1000);
+// Stops of the test sweep: closed, halfway, fully open, closed
+static const int TEST_POSITIONS[] = {0, 90, 180, 0};
+static const int8_t TEST_STOPS = sizeof(TEST_POSITIONS) / sizeof(TEST_POSITIONS[0]);
 
-    // Open window halfway
-    setPosition(90);
-    delay(1000);
+WindowController::WindowController(uint8_t servoPin) : motion(servoPin), policy(defaultWindowPolicy()) {}
 
-    // Open window fully
-    setPosition(180);
-    delay(1000);
+void WindowController::begin(void (*wake)())
+{
+    this->wake = wake;
+    motion.begin(0); // Start with window closed
+    LOG(WINDOW_READY);
+}
 
-    // Return to closed position
-    setPosition(0);
-    delay(1000);
+void WindowController::performInitialTest()
+{
+    LOG(WINDOW_TEST_START);
+    testStep = 0;
+    wake();
+}
 
-    Serial.println("Window controller test complete");
+bool WindowController::isTesting() const
+{
+    return testStep >= 0;
 }
 
 void WindowController::adjustBasedOnTemperature(float indoorTemp, const WeatherData &outdoorWeather)
 {
-    unsigned long currentMillis = millis();
-
-    // Only adjust at certain intervals to prevent constant servo movement
-    if (currentMillis - lastAdjustTime < ADJUST_INTERVAL)
+    // Nothing to decide on until the first weather snapshot arrives, and the
+    // test sweep has the servo until it is done
+    if (!outdoorWeather.isValid || isTesting())
     {
         return;
     }
 
-    lastAdjustTime = currentMillis;
-
-    // Calculate temperature difference from target
-    float tempDifference = indoorTemp - TARGET_TEMP;
-
-    // Decision logic for window position - only fully open or fully closed
-    int newPosition = currentPosition;
-
-    // Check for bad weather first - always close window
-    if (outdoorWeather.weatherType.indexOf("Rain") >= 0 ||
-        outdoorWeather.weatherType.indexOf("Snow") >= 0 ||
-        outdoorWeather.weatherType.indexOf("Thunder") >= 0)
-    {
-        newPosition = 0; // Fully closed
-        Serial.println("Closing window due to bad weather");
-    }
-    // If indoor temp is too high
-    else if (tempDifference > 1.0)
+    // With neither a fetch nor a cached forecast, the weather is simulated:
+    // fine for the display, no reason to move the window. Close it and wait.
+    if (!outdoorWeather.isRealData)
     {
-        // Check if outdoor temp is cooler than indoor
-        if (outdoorWeather.temperatureF < indoorTemp)
-        {
-            // Open window fully to let cool air in
-            newPosition = 180; // Fully open
-            Serial.println("Opening window fully to cool room");
-        }
-        else
+        if (currentPosition != 0)
         {
-            // Outdoor is warmer, close window
-            newPosition = 0; // Fully closed
-            Serial.println("Closing window to keep heat out");
+            LOG(WINDOW_NO_WEATHER);
+            setPosition(0);
         }
+        decided = false;
+        return;
     }
-    // If indoor temp is too low
-    else if (tempDifference < -1.0)
+
+    // Bad weather closes the window without asking the budget
+    if (isBadWeather(outdoorWeather.weatherCode))
     {
-        // Check if outdoor temp is warmer than indoor
-        if (outdoorWeather.temperatureF > indoorTemp)
-        {
-            // Open window fully to let warm air in
-            newPosition = 180; // Fully open
-            Serial.println("Opening window fully to warm room");
-        }
-        else
+        if (currentPosition != 0)
         {
-            // Outdoor is colder, close window
-            newPosition = 0; // Fully closed
-            Serial.println("Closing window to keep cold out");
+            LOG(WINDOW_BAD_WEATHER);
+            setPosition(0);
         }
+        return;
     }
-    // If temperature is in acceptable range
-    else
+
+    unsigned long now = millis();
+    PolicyInput input;
+    input.indoorDeci = toDeciDegrees(indoorTemp);
+    input.outdoorDeci = toDeciDegrees(outdoorWeather.temperatureF);
+    input.targetDeci = TARGET_TEMP_DECI;
+    input.position = currentPosition;
+    input.dtMs = decided ? now - lastDecisionAt : 0;
+    lastDecisionAt = now;
+    decided = true;
+
+    int position = constrain(policy->decide(input), 0, 180);
+    if (position == currentPosition)
     {
-        // Close window when temperature is in acceptable range
-        newPosition = 0; // Fully closed
-        Serial.println("Closing window - temperature is in acceptable range");
+        deferredPosition = -1;
+        return;
     }
-
-    // Apply the new position if it changed
-    if (newPosition != currentPosition)
+    if (!budget.allows(currentPosition, position, now))
     {
-        setPosition(newPosition);
+        if (position != deferredPosition)
+        {
+            deferredPosition = position;
+            LOG(WINDOW_DEFERRED, currentPosition, position);
+        }
+        return;
     }
+    deferredPosition = -1;
+    LOG(WINDOW_DECISION, policy->name(), currentPosition, position, input.indoorDeci / 10.0f,
+        input.outdoorDeci / 10.0f);
+    setPosition(position);
 }
 
 int WindowController::getCurrentPosition() const
@@ -112,17 +102,81 @@ int WindowController::getCurrentPosition() const
     return currentPosition;
 }
 
+int WindowController::getTargetDeci() const
+{
+    return TARGET_TEMP_DECI;
+}
+
 void WindowController::setPosition(int position)
 {
+    STATS_PROBE_CYCLES(PROBE_WINDOW);
     // Ensure position is within valid range
     position = constrain(position, 0, 180);
 
     // Update current position
+    if (position != currentPosition && !isTesting())
+    {
+        budget.record(millis());
+    }
     currentPosition = position;
 
-    // Move servo
-    servo.write(position);
+    // Plan the move; updateMotion() steps it
+    motion.moveTo(position);
+    wake();
 
-    Serial.print("Window position set to: ");
-    Serial.println(position);
+    LOG(WINDOW_POSITION, position);
+}
+
+unsigned long WindowController::updateMotion()
+{
+    unsigned long wait = motion.update();
+    if (!isTesting() || motion.isMoving())
+    {
+        return wait;
+    }
+
+    // Between stops of the test sweep
+    unsigned long settled = motion.settledFor();
+    if (settled < TEST_DWELL_MS)
+    {
+        unsigned long dwell = TEST_DWELL_MS - settled;
+        return wait ? min(wait, dwell) : dwell;
+    }
+    if (testStep == TEST_STOPS)
+    {
+        testStep = -1;
+        LOG(WINDOW_TEST_DONE);
+        return wait;
+    }
+    setPosition(TEST_POSITIONS[testStep++]);
+    wait = motion.update();
+    return wait ? wait : ServoMotion::STEP_MS; // Already there: on to the next stop
+}
+
+void WindowController::setPolicy(WindowPolicy *policy)
+{
+    this->policy = policy;
+    policy->reset();
+    decided = false;
+    LOG(WINDOW_POLICY, policy->name());
+}
+
+WindowPolicy *WindowController::getPolicy() const
+{
+    return policy;
+}
+
+ActuationBudget &WindowController::getBudget()
+{
+    return budget;
+}
+
+int WindowController::getServoPosition() const
+{
+    return motion.getPosition();
+}
+
+const ServoMotionStats &WindowController::getMotionStats()
+{
+    return motion.getStats();
 }
@@ -2,26 +2,59 @@
 #define WINDOW_CONTROLLER_H
 
 #include <Arduino.h>
-#include <Servo.h>
+#include "ServoMotion.h"
+#include "WindowPolicy.h"
 #include "weather.h"
 
 class WindowController
 {
 private:
-    Servo servo;
-    uint8_t pin;
-    int currentPosition = 0;        // 0 = closed, 180 = fully open
-    const float TARGET_TEMP = 75.0; // Target temperature in Fahrenheit
-    unsigned long lastAdjustTime = 0;
-    const unsigned long ADJUST_INTERVAL = 5 * 1000; // 5 sec between adjustments
+    ServoMotion motion;
+    void (*wake)() = nullptr;
+    int currentPosition = 0;          // Target; 0 = closed, 180 = fully open
+    int8_t testStep = -1;             // Next stop of the test sweep, -1 when none runs
+    const int TARGET_TEMP_DECI = 750; // Target temperature in tenths of a degree Fahrenheit
+    WindowPolicy *policy;
+    ActuationBudget budget;
+    unsigned long lastDecisionAt = 0;
+    bool decided = false;             // lastDecisionAt is set
+    int deferredPosition = -1;        // Last move the budget held back, logged once
 
 public:
+    static const unsigned long ADJUST_INTERVAL = 5 * 1000; // 5 sec between adjustments
+    static const unsigned long TEST_DWELL_MS = 1000;       // Pause at each stop of the test sweep
+
     WindowController(uint8_t servoPin);
-    void begin();
+
+    // Close the window. wake is called whenever a move starts and
+    // updateMotion() should run again; it must be safe from the loop task.
+    void begin(void (*wake)());
+
+    // Sweep closed, half, fully open and closed again, pausing at each stop.
+    // Runs from updateMotion(); temperature decisions wait until it is done.
     void performInitialTest();
+    bool isTesting() const;
+
+    // Ask the policy where the window should be, and move it there if the
+    // actuation budget allows. Bad weather closes it regardless, and so does
+    // simulated weather, when there is no real data to go on.
     void adjustBasedOnTemperature(float indoorTemp, const WeatherData &outdoorWeather);
     int getCurrentPosition() const;
+    int getTargetDeci() const;
+
+    // Start a move; it runs from updateMotion(). Every move outside the test
+    // sweep is charged to the budget, so a manual one holds for the dwell.
     void setPosition(int position);
+
+    void setPolicy(WindowPolicy *policy);
+    WindowPolicy *getPolicy() const;
+    ActuationBudget &getBudget();
+
+    // Step the servo; the ms until the next call, 0 when nothing is moving
+    unsigned long updateMotion();
+
+    int getServoPosition() const;
+    const ServoMotionStats &getMotionStats();
 };
 
 #endif // WINDOW_CONTROLLER_H
@@ -0,0 +1,171 @@
+#include "WindowPolicy.h"
+
+int windowDemandDeci(const PolicyInput &in)
+{
+    int error = in.indoorDeci - in.targetDeci;
+    if (in.outdoorDeci < in.indoorDeci)
+    {
+        return error; // Outdoor air cools: useful when the room is warm
+    }
+    if (in.outdoorDeci > in.indoorDeci)
+    {
+        return -error; // Outdoor air warms: useful when the room is cold
+    }
+    return 0;
+}
+
+int BangBangPolicy::decide(const PolicyInput &in)
+{
+    return windowDemandDeci(in) > BAND_DECI ? 180 : 0;
+}
+
+int HysteresisPolicy::decide(const PolicyInput &in)
+{
+    int demand = windowDemandDeci(in);
+    if (demand >= OPEN_AT_DECI)
+    {
+        return 180;
+    }
+    if (demand <= CLOSE_AT_DECI)
+    {
+        return 0;
+    }
+    return in.position;
+}
+
+int ProportionalPolicy::decide(const PolicyInput &in)
+{
+    int demand = constrain(windowDemandDeci(in), 0, FULL_OPEN_DECI);
+    int position = demand * 180 / FULL_OPEN_DECI;
+    return (position + STEP_DEG / 2) / STEP_DEG * STEP_DEG;
+}
+
+int PidPolicy::decide(const PolicyInput &in)
+{
+    int32_t demand = windowDemandDeci(in);
+    int32_t previous = filteredMilli;
+    if (!primed || in.dtMs == 0)
+    {
+        filteredMilli = previous = demand * 1000;
+        primed = true;
+    }
+    else
+    {
+        // First-order low-pass, time constant FILTER_MS
+        uint32_t dt = min(in.dtMs, (unsigned long)FILTER_MS);
+        filteredMilli += (int64_t)(demand * 1000 - filteredMilli) * dt / FILTER_MS;
+    }
+
+    // All three terms work on the filtered demand; the trend is in
+    // thousandths of a tenth per second
+    int64_t trend = in.dtMs ? (int64_t)(filteredMilli - previous) * 1000 / (int64_t)in.dtMs : 0;
+    int64_t output = (int64_t)KP * filteredMilli / 1000 + integral + KD * trend / 1000;
+
+    // Conditional integration: hold the integral while the output is pinned
+    // at the end the error pushes toward, then keep it within the range
+    bool pinnedHigh = output >= 180000 && filteredMilli > 0;
+    bool pinnedLow = output <= 0 && filteredMilli < 0;
+    if (!pinnedHigh && !pinnedLow)
+    {
+        integral += (int64_t)KI * filteredMilli / 1000 * (int64_t)in.dtMs / 1000;
+        integral = constrain(integral, 0, 180000);
+    }
+
+    int position = constrain(output, 0, 180000) / 1000;
+    return (position + STEP_DEG / 2) / STEP_DEG * STEP_DEG;
+}
+
+void PidPolicy::reset()
+{
+    integral = 0;
+    primed = false;
+}
+
+const ActuationLimits ActuationBudget::DEFAULT_LIMITS = {10 * 60 * 1000UL, 4, 20};
+
+ActuationBudget::ActuationBudget(const ActuationLimits &limits)
+{
+    setLimits(limits);
+}
+
+void ActuationBudget::setLimits(const ActuationLimits &limits)
+{
+    this->limits = limits;
+    this->limits.maxMovesPerHour = min(limits.maxMovesPerHour, (uint8_t)ACTUATION_MAX_MOVES_PER_HOUR);
+    next = count = 0;
+}
+
+const ActuationLimits &ActuationBudget::getLimits() const
+{
+    return limits;
+}
+
+bool ActuationBudget::allows(int from, int to, unsigned long now)
+{
+    bool allowed = true;
+    if (count > 0)
+    {
+        unsigned long last = moves[(next + ACTUATION_MAX_MOVES_PER_HOUR - 1) % ACTUATION_MAX_MOVES_PER_HOUR];
+        allowed = now - last >= limits.minDwellMs;
+    }
+    if (limits.maxMovesPerHour > 0 && count == limits.maxMovesPerHour)
+    {
+        // The oldest of the last maxMovesPerHour moves has to be an hour old
+        unsigned long oldest = moves[(next + ACTUATION_MAX_MOVES_PER_HOUR - count) % ACTUATION_MAX_MOVES_PER_HOUR];
+        allowed = allowed && now - oldest >= 60 * 60 * 1000UL;
+    }
+    if (to != 0 && to != 180 && abs(to - from) < limits.minStepDeg)
+    {
+        allowed = false;
+    }
+    denied += !allowed;
+    return allowed;
+}
+
+void ActuationBudget::record(unsigned long now)
+{
+    moves[next] = now;
+    next = (next + 1) % ACTUATION_MAX_MOVES_PER_HOUR;
+    if (count < max(limits.maxMovesPerHour, (uint8_t)1))
+    {
+        count++;
+    }
+}
+
+uint32_t ActuationBudget::getDenied() const
+{
+    return denied;
+}
+
+static BangBangPolicy bangBang;
+static HysteresisPolicy hysteresis;
+static ProportionalPolicy proportional;
+static PidPolicy pid;
+static WindowPolicy *const POLICIES[] = {&bangBang, &hysteresis, &proportional, &pid};
+
+WindowPolicy *defaultWindowPolicy()
+{
+    return &hysteresis;
+}
+
+size_t windowPolicyCount()
+{
+    return sizeof(POLICIES) / sizeof(POLICIES[0]);
+}
+
+WindowPolicy *windowPolicy(size_t index)
+{
+    return index < windowPolicyCount() ? POLICIES[index] : nullptr;
+}
+
+WindowPolicy *findWindowPolicy(const char *name)
+{
+    for (WindowPolicy *policy : POLICIES)
+    {
+        if (strcmp(policy->name(), name) == 0)
+        {
+            return policy;
+        }
+    }
+    return nullptr;
+}
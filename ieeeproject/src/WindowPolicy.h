@@ -0,0 +1,141 @@
+#ifndef WINDOW_POLICY_H
+#define WINDOW_POLICY_H
+
+#include <Arduino.h>
+
+// What a policy sees at each decision. Temperatures are whole tenths of a
+// degree Fahrenheit; the C3 has no FPU.
+struct PolicyInput
+{
+    int indoorDeci;
+    int outdoorDeci;
+    int targetDeci;
+    int position;       // Where the window is headed now, 0-180
+    unsigned long dtMs; // Since the previous decision, 0 on the first
+};
+
+// How far the room is off target, signed the way opening the window acts on
+// it: positive when letting outdoor air in would bring the room toward the
+// target, negative when it would push the room away. 0 when indoor and
+// outdoor are level, since the window can do nothing either way.
+int windowDemandDeci(const PolicyInput &in);
+
+// Turns the room's state into a window position. Policies keep whatever state
+// they need between decisions; the controller calls reset() when something
+// else has moved the window.
+class WindowPolicy
+{
+public:
+    virtual ~WindowPolicy() {}
+    virtual const char *name() const = 0;
+    virtual int decide(const PolicyInput &in) = 0; // 0-180
+    virtual void reset() {}
+};
+
+// Fully open while the demand is more than BAND_DECI, otherwise closed; the
+// original rule, and the one that chatters when a reading sits on the band
+class BangBangPolicy : public WindowPolicy
+{
+public:
+    static const int BAND_DECI = 10;
+
+    const char *name() const override { return "bangbang"; }
+    int decide(const PolicyInput &in) override;
+};
+
+// Fully open once the demand reaches OPEN_AT_DECI, closed again only when it
+// falls to CLOSE_AT_DECI, a little past the target. The gap is wider than
+// the DHT11's 1 C (1.8 F) step, so one step of sensor noise cannot flip it.
+class HysteresisPolicy : public WindowPolicy
+{
+public:
+    static const int OPEN_AT_DECI = 20;
+    static const int CLOSE_AT_DECI = -5;
+
+    const char *name() const override { return "hysteresis"; }
+    int decide(const PolicyInput &in) override;
+};
+
+// Opening proportional to the demand, fully open at FULL_OPEN_DECI, in
+// STEP_DEG steps so small changes in the reading do not move the servo
+class ProportionalPolicy : public WindowPolicy
+{
+public:
+    static const int FULL_OPEN_DECI = 40;
+    static const int STEP_DEG = 45;
+
+    const char *name() const override { return "proportional"; }
+    int decide(const PolicyInput &in) override;
+};
+
+// PID on the demand, output in millidegrees of opening. The integral only
+// grows while the output is not pinned at the end it pushes toward, and is
+// kept within the output range, so a long spell with nothing to do does not
+// wind it up. All terms see the demand through a FILTER_MS low-pass: raw
+// DHT11 steps would turn P into 1.8 F jumps and D into spikes. Even so the
+// output crosses STEP_DEG boundaries often; it wants the actuation budget.
+class PidPolicy : public WindowPolicy
+{
+private:
+    int32_t integral = 0;     // mdeg
+    int32_t filteredMilli = 0; // Demand in thousandths of a tenth
+    bool primed = false;
+
+public:
+    static const int32_t KP = 3000;            // mdeg per tenth of a degree: fully open at 6 F
+    static const int32_t KI = 3;               // mdeg per tenth per second: 1 F for 100 min opens fully
+    static const int32_t KD = 300000;          // mdeg per tenth per second of trend
+    static const uint32_t FILTER_MS = 5 * 60 * 1000;
+    static const int STEP_DEG = 30;
+
+    const char *name() const override { return "pid"; }
+    int decide(const PolicyInput &in) override;
+    void reset() override;
+};
+
+// Limits on how often the controller may move the window: no move within
+// minDwellMs of the last one, at most maxMovesPerHour in any hour, and none
+// smaller than minStepDeg unless it fully opens or closes. 0 turns a limit
+// off.
+struct ActuationLimits
+{
+    unsigned long minDwellMs;
+    uint8_t maxMovesPerHour;
+    int minStepDeg;
+};
+
+#define ACTUATION_MAX_MOVES_PER_HOUR 8 // Most the budget can track
+
+class ActuationBudget
+{
+private:
+    ActuationLimits limits;
+    unsigned long moves[ACTUATION_MAX_MOVES_PER_HOUR]; // Times of recent moves, a ring
+    uint8_t next = 0;
+    uint8_t count = 0; // Entries in the ring, up to maxMovesPerHour
+    uint32_t denied = 0;
+
+public:
+    static const ActuationLimits DEFAULT_LIMITS;
+
+    ActuationBudget(const ActuationLimits &limits = DEFAULT_LIMITS);
+    void setLimits(const ActuationLimits &limits);
+    const ActuationLimits &getLimits() const;
+
+    // Whether a move fits the limits at time now; a refusal is counted
+    bool allows(int from, int to, unsigned long now);
+
+    // Charge a move made at time now, whoever made it
+    void record(unsigned long now);
+
+    uint32_t getDenied() const;
+};
+
+// Every policy, by name. The default is hysteresis, which held comfort with
+// the fewest moves in the replay benchmark.
+WindowPolicy *defaultWindowPolicy();
+size_t windowPolicyCount();
+WindowPolicy *windowPolicy(size_t index);
+WindowPolicy *findWindowPolicy(const char *name);
+
+#endif // WINDOW_POLICY_H
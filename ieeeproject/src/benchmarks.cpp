@@ -0,0 +1,737 @@
+// benchmarks.cpp - host-only benchmarks, run with `program --bench NAME`
+#ifdef NATIVE_BUILD
+
+#include <Arduino.h>
+#include <Adafruit_SSD1306.h>
+#include <ArduinoJson.h>
+#include <HTTPClient.h>
+#include <Preferences.h>
+#include <WiFi.h>
+#include <chrono>
+#include <cstdio>
+#include "NativeHal.h"
+#include <WeatherSim.h>
+#include "DhtReader.h"
+#include "ServoMotion.h"
+#include "WindowController.h"
+#include "WindowPolicy.h"
+#include "LocalSensor.h"
+#include "display.h"
+#include "history.h"
+#include "network.h"
+#include "power.h"
+#include "weather.h"
+
+// The panel driver instance from display.cpp
+extern Adafruit_SSD1306 display;
+
+// The DHT from main.cpp
+extern LocalSensor localSensor;
+
+// The firmware entry points from main.cpp
+void setup();
+void loop();
+
+namespace
+{
+    typedef std::chrono::steady_clock BenchClock;
+
+    // Heap allocations and peak heap growth over a measured section
+    struct HeapProbe
+    {
+        uint64_t allocsBefore;
+        uint64_t inUseBefore;
+
+        HeapProbe()
+        {
+            hal::resetCounters();
+            allocsBefore = hal::counters().heapAllocs;
+            inUseBefore = hal::heapInUse();
+        }
+        uint64_t allocs() const { return hal::counters().heapAllocs - allocsBefore; }
+        uint64_t peakBytes() const { return hal::counters().heapPeak - inUseBefore; }
+    };
+
+    double microsSince(BenchClock::time_point start)
+    {
+        return std::chrono::duration<double, std::micro>(BenchClock::now() - start).count();
+    }
+
+    // One canned API response from the HTTPClient stand-in
+    String fetchSampleWeatherBody()
+    {
+        WiFi.begin("bench");
+        hal::advanceMicros((uint64_t)hal::env().wifiAssociateMs * 1000);
+        HTTPClient http;
+        http.begin("https://api.open-meteo.com/v1/forecast");
+        http.GET();
+        String body = http.getString();
+        http.end();
+        return body;
+    }
+
+    // Let a background fetch finish and get published
+    void waitForWeatherFetch()
+    {
+        while (isWeatherFetchInProgress())
+        {
+            hal::advanceMicros(250000);
+            updateWeather();
+        }
+    }
+}
+
+HAL_BENCHMARK(weather_json, "Open-Meteo decode: String + DynamicJsonDocument vs streamed + filtered")
+{
+    const int iterations = 20000;
+    String body = fetchSampleWeatherBody();
+    WiFiClient stream;
+    float before = 0;
+    float after = 0;
+
+    // Previous path: http.getString() copy, then a heap document big enough
+    // for the whole body
+    uint64_t oldAllocs = 0;
+    uint64_t oldPeak = 0;
+    double oldMicros = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        HeapProbe probe;
+        BenchClock::time_point start = BenchClock::now();
+        {
+            String payload = body;
+            DynamicJsonDocument doc(8192);
+            deserializeJson(doc, payload);
+            before = doc["current"]["temperature_2m"];
+        }
+        oldMicros += microsSince(start);
+        oldAllocs += probe.allocs();
+        oldPeak = max(oldPeak, probe.peakBytes());
+    }
+
+    // Current path: parse off the stream through the filter into static storage
+    uint64_t newAllocs = 0;
+    uint64_t newPeak = 0;
+    double newMicros = 0;
+    WeatherData weather = {};
+    WeatherForecast hourly = {};
+    int failures = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        stream.load(body.c_str(), body.length());
+        HeapProbe probe;
+        BenchClock::time_point start = BenchClock::now();
+        failures += !parseWeatherResponse(stream, weather, hourly);
+        newMicros += microsSince(start);
+        newAllocs += probe.allocs();
+        newPeak = max(newPeak, probe.peakBytes());
+        after = weather.temperatureF;
+    }
+
+    // Figures from a parse that dropped fields would flatter the filter
+    if (failures || hourly.hours != FORECAST_HOURS)
+    {
+        printf("streamed parse failed %d times, %u forecast hours read: no figures\n", failures,
+               (unsigned)hourly.hours);
+        return;
+    }
+    printf("body: %u bytes, %d iterations, temperature %.1f / %.1f\n", body.length(), iterations, before, after);
+    printf("%-28s %12s %12s %12s\n", "", "allocs/fetch", "peak heap B", "parse us");
+    printf("%-28s %12.2f %12llu %12.2f\n", "String + DynamicJsonDocument", (double)oldAllocs / iterations,
+           (unsigned long long)oldPeak, oldMicros / iterations);
+    printf("%-28s %12.2f %12llu %12.2f\n", "stream + filter + static", (double)newAllocs / iterations,
+           (unsigned long long)newPeak, newMicros / iterations);
+}
+
+HAL_BENCHMARK(display_flush, "OLED update cost per frame: unchanged, one field changing, full redraw")
+{
+    const int frames = 1000;
+    displayInit();
+    WeatherData weather = {72.0, 5.5, WeatherCode::PartlyCloudy, 0.0, 0, true, true, 0, false};
+
+    struct Case
+    {
+        const char *name;
+        int changeEvery; // Change the indoor reading every N frames, 0 = never
+    } cases[] = {{"unchanged frame", 0}, {"indoor temp every 30th", 30}, {"indoor temp every frame", 1}};
+
+    printf("%-24s %14s %14s %14s\n", "", "bytes/frame", "I2C ms/frame", "skipped");
+    for (const Case &c : cases)
+    {
+        displayWeather(weather, 70, 45);
+        DisplayFlushStats before = getDisplayFlushStats();
+        uint64_t clockBefore = hal::nowMicros();
+        for (int i = 0; i < frames; i++)
+        {
+            float indoor = c.changeEvery ? 60 + (i / c.changeEvery) % 30 : 70;
+            displayWeather(weather, indoor, 45);
+        }
+        const DisplayFlushStats &after = getDisplayFlushStats();
+        printf("%-24s %14.1f %14.3f %14lu\n", c.name, (double)(after.totalBytes - before.totalBytes) / frames,
+               (hal::nowMicros() - clockBefore) / 1000.0 / frames, after.skipped - before.skipped);
+    }
+
+    // Reference: what every frame cost before, a full framebuffer push
+    uint64_t clockBefore = hal::nowMicros();
+    uint64_t bytesBefore = hal::counters().wireBytes;
+    display.display();
+    printf("%-24s %14llu %14.3f\n", "full display()", (unsigned long long)(hal::counters().wireBytes - bytesBefore),
+           (hal::nowMicros() - clockBefore) / 1000.0);
+}
+
+HAL_BENCHMARK(power, "Wakeups per hour and estimated supply current over a simulated day")
+{
+    const double hours = 24;
+    setup();
+    uint64_t start = hal::nowMicros();
+    while (hal::nowMicros() - start < (uint64_t)(hours * 3600e6))
+    {
+        loop();
+    }
+
+    const PowerStats &power = getPowerStats();
+    uint64_t totalMs = 0;
+    for (int state = 0; state < POWER_STATE_COUNT; state++)
+    {
+        totalMs += power.stateMs[state];
+    }
+    printf("%g h simulated, WiFi %s\n", hours, WiFi.status() == WL_CONNECTED ? "associated" : "down");
+    printf("wakeups/h %.1f (timer %.1f, event %.1f), light sleeps/h %.1f\n", power.wakeups / hours,
+           power.timerWakes / hours, power.eventWakes / hours, power.lightSleeps / hours);
+    for (int state = 0; state < POWER_STATE_COUNT; state++)
+    {
+        printf("  %-17s %7.3f%%  x %6.2f mA\n", powerStateLabel((PowerState)state),
+               100.0 * power.stateMs[state] / totalMs, powerStateCurrentMa((PowerState)state));
+    }
+
+    // Same timeline with the radio kept up and no light sleep, the previous
+    // behaviour, for comparison. The 1 s polling loop woke 3600 times an hour.
+    double awakeCharge = power.stateMs[POWER_ACTIVE] * powerStateCurrentMa(POWER_ACTIVE) +
+                         power.stateMs[POWER_RADIO] * powerStateCurrentMa(POWER_RADIO);
+    uint64_t restMs = totalMs - power.stateMs[POWER_ACTIVE] - power.stateMs[POWER_RADIO];
+    printf("average current: %.2f mA, without light sleep %.2f mA\n", estimateAverageCurrentMa(),
+           (awakeCharge + restMs * powerStateCurrentMa(POWER_MODEM_SLEEP)) / totalMs);
+}
+
+HAL_BENCHMARK(wifi_connect, "Time to a WiFi link: cold boot, cached AP and lease, AP on a new channel")
+{
+    struct Case
+    {
+        const char *name;
+        bool clearCache;
+        int32_t channel;
+    } cases[] = {{"cold boot, empty cache", true, 6},
+                 {"reboot, cached AP + lease", false, 6},
+                 {"reboot, AP moved channel", false, 11},
+                 {"reboot after the rescan", false, 11}};
+
+    printf("%-28s %10s %10s %12s %10s\n", "", "attempts", "link ms", "associate ms", "NVS writes");
+    for (const Case &c : cases)
+    {
+        if (c.clearCache)
+        {
+            Preferences prefs;
+            prefs.begin("wifi");
+            prefs.clear();
+            prefs.end();
+        }
+        hal::env().wifiChannel = c.channel;
+        WiFi.disconnect();
+        hal::resetCounters();
+
+        // Same as the network job: run, then sleep for as long as it asks
+        networkInit(nullptr);
+        unsigned long start = millis();
+        while (getNetworkStats().state != NETWORK_CONNECTED && millis() - start < 60000)
+        {
+            hal::advanceMicros((uint64_t)updateNetwork() * 1000);
+        }
+
+        const NetworkStats &network = getNetworkStats();
+        printf("%-28s %10lu %10lu %12lu %10llu\n", c.name, network.attempts, network.bootConnectMs - start,
+               network.lastAssociateMs, (unsigned long long)hal::counters().nvsWrites);
+    }
+
+    // Before, setup() blocked in a 500 ms polling loop for every cold connect
+    // and never tried again after a failure
+    unsigned long coldMs = hal::env().wifiAssociateMs;
+    printf("previous: setup() blocked %lu ms on a cold connect, up to 10000 ms without an AP\n",
+           (coldMs + 499) / 500 * 500);
+}
+
+HAL_BENCHMARK(weather_cache, "Weather fetches per day and offline hours on real data with the forecast cache")
+{
+    struct Phase
+    {
+        const char *name;
+        bool wifi;
+        double hours;
+    } phases[] = {{"online", true, 24}, {"WiFi down", false, 30}};
+
+    WiFi.begin("bench");
+    hal::advanceMicros((uint64_t)hal::env().wifiAssociateMs * 1000);
+    configTzTime(WEATHER_TIMEZONE, "pool.ntp.org");
+    weatherInit();
+
+    printf("forecast cache: %u bytes in NVS for %d hours\n", (unsigned)sizeof(WeatherForecast), FORECAST_HOURS);
+    printf("%-12s %8s %12s %14s %14s\n", "", "hours", "fetches", "real data h", "fake snapshots");
+    for (const Phase &phase : phases)
+    {
+        hal::env().wifiAvailable = phase.wifi;
+        hal::resetCounters();
+        uint64_t realMs = 0;
+        unsigned long fakeSnapshots = 0;
+        unsigned long lastPublished = getWeather().updatedAt;
+        unsigned long start = millis();
+        while (millis() - start < phase.hours * 3600000)
+        {
+            unsigned long wait = min(updateWeather(), 60000UL);
+            if (getWeather().updatedAt != lastPublished && !getWeather().isRealData)
+            {
+                fakeSnapshots++;
+            }
+            lastPublished = getWeather().updatedAt;
+            if (getWeather().isRealData)
+            {
+                realMs += wait;
+            }
+            hal::advanceMicros((uint64_t)wait * 1000);
+        }
+        printf("%-12s %8.0f %12llu %14.1f %14lu\n", phase.name, phase.hours,
+               (unsigned long long)hal::counters().httpRequests, realMs / 3600000.0, fakeSnapshots);
+    }
+    printf("previous: %d fetches a day online, fake data from the first minute offline\n", 24 * 12);
+}
+
+HAL_BENCHMARK(weather_fetch, "Where a weather fetch spends its time, by gap since the previous fetch")
+{
+    const int fetches = 8;
+    const unsigned long gapsMs[] = {60000, 5 * 60000, 3 * 3600000UL};
+
+    WiFi.begin("bench");
+    hal::advanceMicros((uint64_t)hal::env().wifiAssociateMs * 1000);
+    configTzTime(WEATHER_TIMEZONE, "pool.ntp.org");
+    weatherInit();
+    waitForWeatherFetch();
+
+    printf("%-10s %8s %10s %14s %14s %8s %10s\n", "gap", "DNS ms", "TLS/fetch", "connect+TLS ms", "first byte ms",
+           "body ms", "total ms");
+    for (unsigned long gap : gapsMs)
+    {
+        hal::resetCounters();
+        unsigned long dns = 0, connect = 0, firstByte = 0, body = 0;
+        for (int i = 0; i < fetches; i++)
+        {
+            hal::advanceMicros((uint64_t)gap * 1000);
+            refreshWeather();
+            waitForWeatherFetch();
+            const WeatherFetchTiming &timing = getWeatherFetchTiming();
+            dns += timing.dnsMs;
+            connect += timing.connectMs;
+            firstByte += timing.firstByteMs;
+            body += timing.bodyMs;
+        }
+        printf("%-10.1f %8lu %10.2f %14lu %14lu %8lu %10lu\n", gap / 60000.0, dns / fetches,
+               (double)hal::counters().tlsHandshakes / fetches, connect / fetches, firstByte / fetches,
+               body / fetches, (dns + connect + firstByte + body) / fetches);
+    }
+    printf("gap in minutes; no TLS session resumption in the core, so every fetch pays a full handshake\n");
+}
+
+namespace
+{
+    // A reply as dhtUnpackItems() gives it
+    struct DhtTrace
+    {
+        DhtPulse pulses[DHT_MAX_PULSES];
+        size_t count;
+    };
+
+    DhtTrace encodeDhtTrace(const uint8_t *bytes, uint8_t jitterUs)
+    {
+        uint32_t items[DHT_MAX_PULSES / 2];
+        DhtTrace trace;
+        size_t itemCount = hal::dhtEncode(bytes, items, DHT_MAX_PULSES / 2, jitterUs);
+        trace.count = dhtUnpackItems(items, itemCount, trace.pulses, DHT_MAX_PULSES);
+        return trace;
+    }
+}
+
+// Which captures decode to what is checked in test/test_dht_decode
+HAL_BENCHMARK(dht_decode, "DHT replies decoded from RMT captures: decode time, and the stand-in's replies by status")
+{
+    const uint8_t dht11Bytes[] = {45, 0, 23, 0, 68}; // 45 %, 23 C
+    const DhtTrace traces[] = {encodeDhtTrace(dht11Bytes, 0), encodeDhtTrace(dht11Bytes, 12)};
+
+    const int iterations = 200000;
+    DhtReading reading;
+    BenchClock::time_point start = BenchClock::now();
+    for (int i = 0; i < iterations; i++)
+        dhtDecode(traces[i % 2].pulses, traces[i % 2].count, DHT11, reading);
+    printf("decode: %.0f ns per reply, on the RMT driver's task instead of ~5 ms with interrupts off\n",
+           microsSince(start) * 1000 / iterations);
+
+    // The stand-in's own replies, the way a host run sees them
+    const int reads = 3000;
+    int tally[DHT_BAD_CHECKSUM + 1] = {};
+    hal::env().dhtErrorPercent = 10;
+    for (int i = 0; i < reads; i++)
+    {
+        uint32_t items[DHT_MAX_PULSES / 2];
+        DhtPulse pulses[DHT_MAX_PULSES];
+        size_t count = dhtUnpackItems(items, hal::dhtCapture(true, items, DHT_MAX_PULSES / 2), pulses,
+                                      DHT_MAX_PULSES);
+        tally[dhtDecode(pulses, count, DHT11, reading)]++;
+    }
+    hal::env().dhtErrorPercent = 0;
+    printf("%d stand-in replies at 10%% corrupted:", reads);
+    for (int status = DHT_OK; status <= DHT_BAD_CHECKSUM; status++)
+        printf(" %s %d%s", dhtStatusLabel((DhtStatus)status), tally[status], status < DHT_BAD_CHECKSUM ? "," : "\n");
+}
+
+// The trajectories themselves are checked in test/test_servo_motion
+HAL_BENCHMARK(servo_motion, "Servo trajectories: planned timing against the analytic profile, steps, idle release")
+{
+    const double speed = ServoMotion::MAX_SPEED;
+    const double accel = ServoMotion::ACCEL;
+    struct
+    {
+        int from;
+        int to;
+    } moves[] = {{0, 180}, {180, 0}, {0, 90}, {45, 55}, {90, 91}, {30, 30}};
+
+    printf("%-10s %-5s %7s %7s %8s %8s %9s %7s\n", "move", "shape", "ramp ms", "cruise", "total ms", "expected",
+           "peak d/s", "frames");
+    for (auto &move : moves)
+    {
+        MotionPlan plan = planMotion(move.from, move.to, ServoMotion::MAX_SPEED, ServoMotion::ACCEL);
+        double distance = abs(move.to - move.from);
+        double expected = distance >= speed * speed / accel ? (distance / speed + speed / accel) * 1000
+                                                            : 2 * sqrt(distance / accel) * 1000;
+
+        // PWM frames update() writes for it
+        uint32_t total = motionDurationMs(plan);
+        int frames = (total + ServoMotion::STEP_MS - 1) / ServoMotion::STEP_MS;
+        char name[12];
+        snprintf(name, sizeof(name), "%d-%d", move.from, move.to);
+        printf("%-10s %-5s %7u %7u %8u %8.1f %9.1f %7d\n", name, plan.cruiseMs ? "trap" : total ? "tri" : "-", plan.rampMs,
+               plan.cruiseMs, total, expected, plan.peakMdegPerS / 1000.0, frames);
+    }
+
+    // The whole path on the virtual clock: the controller's job stepping a
+    // full swing, holding, and letting go of the PWM
+    WindowController controller(3);
+    controller.begin([]() {});
+    hal::resetCounters();
+    uint64_t start = hal::nowMicros();
+    uint64_t arrivedUs = 0;
+    int calls = 0;
+    controller.setPosition(180);
+    for (unsigned long wait = controller.updateMotion(); wait != 0; wait = controller.updateMotion())
+    {
+        calls++;
+        if (arrivedUs == 0 && controller.getServoPosition() == 180)
+        {
+            arrivedUs = hal::nowMicros() - start;
+        }
+        hal::advanceMicros((uint64_t)wait * 1000);
+    }
+    const ServoMotionStats &stats = controller.getMotionStats();
+    printf("0-180 on the scheduler: at target after %.0f ms, released after %.0f ms, %d job runs, %llu servo "
+           "writes\n",
+           arrivedUs / 1000.0, (hal::nowMicros() - start) / 1000.0, calls,
+           (unsigned long long)hal::counters().servoWrites);
+    printf("PWM on %.2f s in total over %lu moves, %lu releases\n", stats.attachedMs / 1000.0,
+           (unsigned long)stats.moves, (unsigned long)stats.detaches);
+}
+
+HAL_BENCHMARK(window_policy, "Window policies replayed over three simulated days: comfort error and servo moves")
+{
+    // The simulator's room model with its defaults: heat from the sun and
+    // the occupants, a 10 h leak through the walls and 30 min through the
+    // open window, under clear skies; outdoor air follows the HAL's daily
+    // wave. The controller sees it through a DHT11, whole degrees C, read
+    // every 30 s, and decides every ADJUST_INTERVAL like the window job.
+    const double days = 3;
+    const double targetF = 75.0;
+    const unsigned long stepMs = WindowController::ADJUST_INTERVAL;
+    const unsigned long sensorMs = 30 * 1000;
+    auto sunPermille = [](double hourOfDay) {
+        double sun = sin((hourOfDay - 7) / 12 * M_PI); // Up at 7, down at 19
+        return sun > 0 ? (int)lround(sun * 1000) : 0;
+    };
+
+    struct
+    {
+        const char *label;
+        ActuationLimits limits;
+    } budgets[] = {{"none", {0, 0, 0}}, {"default", ActuationBudget::DEFAULT_LIMITS}};
+
+    // A mild spell, 58-74 F outside: warm enough to need the window by day,
+    // cool enough that it cannot stay open all night
+    hal::env().outdoorBaseF = 66;
+    hal::env().outdoorSwingF = 8;
+
+    printf("%-13s %-8s %9s %9s %9s %9s %9s\n", "policy", "budget", "|err| F", "out h/d", "moves/d", "deg/d",
+           "held back");
+    for (size_t p = 0; p < windowPolicyCount(); p++)
+    {
+        for (auto &budget : budgets)
+        {
+            WindowController controller(3);
+            controller.begin([]() {});
+            controller.setPolicy(windowPolicy(p));
+            controller.getBudget().setLimits(budget.limits);
+
+            WeatherData weather = {};
+            weather.weatherCode = WeatherCode::ClearSky;
+            weather.isValid = true;
+            RoomModel room;
+            room.setIndoor((int32_t)(targetF * 1e6), RoomModel::DEFAULT_PARAMS.baseHumidityMilli);
+            double indoorF = targetF;
+            float readingF = 0;
+            double errorSum = 0;
+            double outsideHours = 0;
+            int moves = 0;
+            int degrees = 0;
+            int position = controller.getCurrentPosition();
+            uint64_t startMs = hal::nowMicros() / 1000;
+            uint64_t steps = (uint64_t)(days * 86400000 / stepMs);
+            for (uint64_t step = 0; step < steps; step++)
+            {
+                uint64_t elapsedMs = step * stepMs;
+                double outdoorF = hal::outdoorTemperatureAtF(startMs + elapsedMs);
+                if (elapsedMs % sensorMs == 0)
+                {
+                    readingF = lround((indoorF - 32) / 1.8) * 1.8f + 32;
+                }
+                weather.temperatureF = outdoorF;
+                controller.adjustBasedOnTemperature(readingF, weather);
+                if (controller.getCurrentPosition() != position)
+                {
+                    moves++;
+                    degrees += abs(controller.getCurrentPosition() - position);
+                    position = controller.getCurrentPosition();
+                }
+
+                double hours = stepMs / 3600000.0;
+                room.step(stepMs, (int32_t)(outdoorF * 1e6), 50000, position,
+                          sunPermille(fmod(elapsedMs / 3600000.0, 24)));
+                indoorF = room.indoorMicroF() / 1e6;
+                errorSum += fabs(indoorF - targetF);
+                outsideHours += fabs(indoorF - targetF) > 1 ? hours : 0;
+                hal::advanceMicros((uint64_t)stepMs * 1000);
+            }
+            printf("%-13s %-8s %9.2f %9.2f %9.1f %9.0f %9lu\n", windowPolicy(p)->name(), budget.label,
+                   errorSum / steps, outsideHours / days, moves / days, degrees / days,
+                   (unsigned long)controller.getBudget().getDenied());
+        }
+    }
+    printf("|err|: mean distance from %.0f F; out h/d: hours a day more than 1 F off\n", targetF);
+}
+
+HAL_BENCHMARK(adaptive_rate, "DHT reads and forecast fetches with adaptive rates: a quiet day, rain coming, a jump indoors")
+{
+    auto runFor = [](double hours) {
+        uint64_t end = hal::nowMicros() + (uint64_t)(hours * 3600e6);
+        while (hal::nowMicros() < end)
+        {
+            loop();
+        }
+    };
+    // What the fixed rates did: a read every 30 s, a fetch every 3 h
+    const double fixedReadsPerHour = 120;
+    const double fixedFetchesPerHour = 1 / 3.0;
+
+    setup();
+    runFor(1);
+    printf("%-28s %7s %10s %10s %10s %10s\n", "phase", "hours", "reads/h", "fixed", "fetches/h", "fixed");
+    auto phase = [&](const char *name, double hours) {
+        hal::resetCounters();
+        runFor(hours);
+        printf("%-28s %7.0f %10.1f %10.1f %10.2f %10.2f\n", name, hours, hal::counters().dhtReads / hours,
+               fixedReadsPerHour, hal::counters().httpRequests / hours, fixedFetchesPerHour);
+    };
+
+    phase("quiet day", 24);
+
+    // Rain 20 h out: the forecast shows it from the next fetch on, and the
+    // refresh tightens once it comes within the lookahead
+    hal::env().rainAtMs = hal::nowMillis() + 20 * 3600000LL;
+    phase("rain 20 h to 6 h out", 14);
+    phase("rain 6 h out to arrival", 6);
+    phase("raining", 3);
+    hal::env().rainAtMs = -1;
+    phase("dry again", 12);
+
+    // The room jumps 4 F: how long until a reading shows it, and how fast
+    // the reads come while it settles
+    const AdaptiveRate &rate = localSensor.getReadRate();
+    unsigned long intervalBefore = rate.interval();
+    float before = localSensor.getTemperature();
+    hal::env().indoorBaseF += 4;
+    uint64_t start = hal::nowMicros();
+    while (fabsf(localSensor.getTemperature() - before) < 3 && hal::nowMicros() - start < 3600e6)
+    {
+        loop();
+    }
+    printf("indoor +4 F: seen after %.0f s (read interval was %lu s, fixed 30 s), now reading every %lu s\n",
+           (hal::nowMicros() - start) / 1e6, intervalBefore / 1000, rate.interval() / 1000);
+    printf("DHT rate sped up %lu times, backed off %lu; forecast refresh now %lu min\n",
+           (unsigned long)rate.getHurries(), (unsigned long)rate.getRelaxes(),
+           getForecastRefresh().interval() / 60000);
+}
+
+// What comes back out is checked in test/test_history
+HAL_BENCHMARK(history, "Sample history over a simulated week: flash bytes per sample, query times, reload")
+{
+    // A sample every 30 s, the sensor job's pace; slow drifts with a little
+    // noise, roughly what the channels look like
+    const uint32_t interval = 30;
+    const uint32_t samples = 7 * 86400 / interval;
+    const uint32_t startTime = 1775347200; // 2026-04-05 00:00 UTC
+    auto sampleAt = [](uint32_t i, int16_t values[HISTORY_CHANNELS]) {
+        uint32_t noise = i * 2654435761u;
+        values[HISTORY_INDOOR_TEMP] = 700 + 40 * sin(i / 2880.0 * 2 * M_PI) + (int)(noise >> 30);
+        values[HISTORY_HUMIDITY] = 450 + (int)(noise >> 28 & 7);
+        values[HISTORY_OUTDOOR_TEMP] = i % 480 < 20 ? HISTORY_MISSING : 600 + 150 * sin(i / 2880.0 * 2 * M_PI);
+        values[HISTORY_WINDOW] = i / 240 % 3 * 450;
+    };
+
+    historyInit();
+    hal::setEpochSeconds(startTime);
+    uint64_t fsBytesBefore = hal::counters().fsBytesWritten;
+    BenchClock::time_point start = BenchClock::now();
+    for (uint32_t i = 0; i < samples; i++)
+    {
+        int16_t values[HISTORY_CHANNELS];
+        sampleAt(i, values);
+        historyAdd(values);
+        hal::setEpochSeconds(startTime + (i + 1) * interval);
+    }
+    double addMicros = microsSince(start) / samples;
+
+    const HistoryStats &stats = getHistoryStats();
+    const size_t rawBytes = 4 + 2 * HISTORY_CHANNELS;
+    printf("%lu samples of %u channels, %lu blocks in %u segments\n", (unsigned long)stats.samples, HISTORY_CHANNELS,
+           (unsigned long)stats.blocks, stats.segmentsInUse);
+    printf("flash: %.2f bytes per sample (raw %zu), %.1f KB per day, %.2f us per add\n",
+           (double)stats.flashBytes / stats.samples, rawBytes, stats.flashBytes / 7 / 1024.0, addMicros);
+    printf("LittleFS: %llu bytes written including headers, %llu commits\n",
+           (unsigned long long)(hal::counters().fsBytesWritten - fsBytesBefore),
+           (unsigned long long)hal::counters().fsWrites);
+    printf("RAM: raw ring %zu B, minute and hour rollups %zu B\n", HISTORY_RAW_SAMPLES * rawBytes,
+           (size_t)(HISTORY_MINUTES + HISTORY_HOURS) * (4 + 8 * HISTORY_CHANNELS));
+
+    uint32_t end = startTime + samples * interval;
+    HistoryPoint points[HISTORY_QUERY_MAX_POINTS];
+
+    struct
+    {
+        const char *name;
+        uint32_t span;
+        uint32_t step;
+    } queries[] = {{"1 h raw from RAM", 3600, 30},
+                   {"2 h raw from flash", 7200, 30},
+                   {"2 h by 10 min", 7200, 600},
+                   {"24 h by hour", 86400, 3600},
+                   {"7 d by 6 h", 7 * 86400, 6 * 3600}};
+    printf("%-20s %8s %12s %12s\n", "query", "points", "host us", "virtual ms");
+    for (auto &query : queries)
+    {
+        uint32_t from = end - query.span;
+        if (query.step == 30 && query.span == 7200)
+        {
+            from = startTime + 3 * 86400;
+        }
+        from -= from % query.step;
+        uint64_t virtualBefore = hal::nowMicros();
+        start = BenchClock::now();
+        size_t count = historyQuery(HISTORY_INDOOR_TEMP, from, from + query.span, query.step, points,
+                                    HISTORY_QUERY_MAX_POINTS);
+        printf("%-20s %8zu %12.1f %12.2f\n", query.name, count, microsSince(start),
+               (hal::nowMicros() - virtualBefore) / 1000.0);
+    }
+
+    // Rebuilding the rollups after a reboot
+    uint64_t virtualBefore = hal::nowMicros();
+    historyInit();
+    printf("reload: %.1f ms virtual, %u segments\n", (hal::nowMicros() - virtualBefore) / 1000.0,
+           getHistoryStats().segmentsInUse);
+}
+
+// Determinism per seed and the local time of day are checked in test/test_weather_sim
+HAL_BENCHMARK(weather_sim, "Seeded weather and room simulator: step rate, a simulated year of weather, the room shut and open")
+{
+    // Step rate: a year of room steps at the longest step
+    WeatherSim sim(1);
+    BenchClock::time_point start = BenchClock::now();
+    sim.advanceTo(365ULL * 86400000);
+    double seconds = microsSince(start) / 1e6;
+    printf("%llu steps for a year in %.3f s: %.1f M steps/s, %.0f sim days/s\n", (unsigned long long)sim.getSteps(),
+           seconds, sim.getSteps() / seconds / 1e6, 365 / seconds);
+
+    // A year of weather, hour by hour: how the sky is spent, how long rain
+    // lasts, and the day-night range
+    const char *skyNames[] = {"clear", "partly cloudy", "overcast", "precipitation"};
+    uint32_t skyHours[(int)SimSky::Count] = {};
+    uint32_t spells = 0;
+    double dailyRange = 0;
+    double dailyLow = 0;
+    double dailyHigh = 0;
+    WeatherSim year(7);
+    SimSky previous = SimSky::Clear;
+    for (uint32_t day = 0; day < 365; day++)
+    {
+        int32_t low = INT32_MAX;
+        int32_t high = INT32_MIN;
+        for (uint32_t hour = 0; hour < 24; hour++)
+        {
+            uint64_t ms = (day * 24ULL + hour) * 3600000;
+            SimSky sky = year.skyAt(ms);
+            skyHours[(int)sky]++;
+            spells += sky == SimSky::Precipitation && previous != SimSky::Precipitation;
+            previous = sky;
+            for (uint64_t at = ms; at < ms + 3600000; at += 600000)
+            {
+                int32_t t = year.outdoorMicroFAt(at);
+                low = min(low, t);
+                high = max(high, t);
+            }
+        }
+        dailyRange += (high - low) / 1e6 / 365;
+        dailyLow += low / 1e6 / 365;
+        dailyHigh += high / 1e6 / 365;
+    }
+    for (int sky = 0; sky < (int)SimSky::Count; sky++)
+    {
+        printf("%-14s %5.1f%% of hours\n", skyNames[sky], skyHours[sky] * 100.0 / (365 * 24));
+    }
+    printf("precipitation: %u spells, %.1f h each on average\n", (unsigned)spells,
+           spells ? (double)skyHours[(int)SimSky::Precipitation] / spells : 0.0);
+    printf("outdoor: mean daily low %.1f F, high %.1f F, range %.1f F\n", dailyLow, dailyHigh, dailyRange);
+
+    // The room over three days with the window shut and fully open
+    printf("%-12s %9s %9s %9s\n", "window deg", "mean F", "low F", "high F");
+    for (int window : {0, 90, 180})
+    {
+        WeatherSim day(3);
+        day.setWindow(window);
+        double sum = 0;
+        int32_t low = INT32_MAX;
+        int32_t high = INT32_MIN;
+        int samples = 0;
+        for (uint64_t ms = 86400000; ms <= 4 * 86400000ULL; ms += 600000)
+        {
+            day.advanceTo(ms);
+            int32_t t = day.room().indoorMicroF();
+            sum += t / 1e6;
+            low = min(low, t);
+            high = max(high, t);
+            samples++;
+        }
+        printf("%-12d %9.1f %9.1f %9.1f\n", window, sum / samples, low / 1e6, high / 1e6);
+    }
+}
+
+#endif // NATIVE_BUILD
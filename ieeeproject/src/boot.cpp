@@ -0,0 +1,50 @@
+// boot.cpp
+#include "boot.h"
+
+struct BootMark
+{
+    const char *phase;
+    uint32_t atMicros;
+};
+
+static BootMark marks[BOOT_MAX_MARKS];
+static uint8_t markCount = 0;
+static bool finished = false;
+
+void bootMark(const char *phase)
+{
+    // micros() only wraps after 71 minutes, long after startup is over
+    if (markCount < BOOT_MAX_MARKS)
+    {
+        marks[markCount++] = {phase, (uint32_t)micros()};
+    }
+}
+
+void bootFinish(const char *phase)
+{
+    if (finished)
+    {
+        return;
+    }
+    finished = true;
+    bootMark(phase);
+    printBootTimeline(Serial);
+}
+
+bool isBootFinished()
+{
+    return finished;
+}
+
+void printBootTimeline(Print &out)
+{
+    out.println("\n=== Startup timeline ===");
+    uint32_t previous = 0;
+    for (uint8_t i = 0; i < markCount; i++)
+    {
+        out.printf("%8.1f ms  +%7.1f ms  %s\n", marks[i].atMicros / 1000.0, (marks[i].atMicros - previous) / 1000.0,
+                   marks[i].phase);
+        previous = marks[i].atMicros;
+    }
+    out.println("========================\n");
+}
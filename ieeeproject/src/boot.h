@@ -0,0 +1,21 @@
+// boot.h
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <Arduino.h>
+
+#define BOOT_MAX_MARKS 16
+
+// Record that a startup phase just ended, in microseconds since the app
+// started. The label is kept by pointer, so pass a string literal.
+void bootMark(const char *phase);
+
+// Mark the phase that ends startup and print the timeline once; later calls
+// do nothing. Phases marked after it still show in printBootTimeline().
+void bootFinish(const char *phase);
+bool isBootFinished();
+
+// One line per phase: when it ended and how long it took
+void printBootTimeline(Print &out);
+
+#endif
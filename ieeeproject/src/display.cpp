@@ -3,6 +3,8 @@
 #include <Wire.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
+#include "stats.h"
+#include "log.h"
 
 // OLED display settings
 #define SCREEN_WIDTH 128    // OLED display width, in pixels
@@ -18,18 +20,115 @@
 #define YELLOW_SECTION_HEIGHT 16 // Top 16 pixels are yellow
 #define BLUE_SECTION_START 16    // Blue section starts at pixel 16
 
+// I2C clock, kept at fast mode so our partial updates don't drop to 100 kHz
+#define I2C_CLOCK 400000
+
+// Framebuffer layout: one byte = 8 vertical pixels, one page = 8 rows
+#define SCREEN_PAGES (SCREEN_HEIGHT / 8)
+
+// A changed column run costs an addressing transaction (address, control and
+// 6 command bytes) before its data, so runs closer than this are merged
+#define RUN_MERGE_GAP 8
+
 // Create display object
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET, I2C_CLOCK, I2C_CLOCK);
+
+// What the panel currently shows, so updates only send what changed
+static uint8_t shadowBuffer[SCREEN_WIDTH * SCREEN_PAGES];
+static bool shadowValid = false;
+static DisplayFlushStats flushStats = {};
+
+// Send columns [first, last] of one page straight from the framebuffer
+static size_t sendPageRun(uint8_t page, uint8_t first, uint8_t last, const uint8_t *pageData)
+{
+    const uint8_t addressing[] = {SSD1306_PAGEADDR, page, page, SSD1306_COLUMNADDR, first, last};
+    Wire.beginTransmission(SCREEN_ADDRESS);
+    Wire.write((uint8_t)0x00); // Command stream
+    Wire.write(addressing, sizeof(addressing));
+    Wire.endTransmission();
+    size_t sent = sizeof(addressing) + 1;
+
+    for (uint8_t col = first; col <= last;)
+    {
+        size_t chunk = min((size_t)(last - col + 1), (size_t)(I2C_BUFFER_LENGTH - 1));
+        Wire.beginTransmission(SCREEN_ADDRESS);
+        Wire.write((uint8_t)0x40); // Data stream
+        Wire.write(pageData + col, chunk);
+        Wire.endTransmission();
+        sent += chunk + 1;
+        col += chunk;
+    }
+    return sent;
+}
+
+// Push the framebuffer to the panel, sending only changed column runs of
+// changed pages, and nothing at all if the frame is unchanged
+static void flushDisplay()
+{
+    STATS_PROBE(PROBE_DISPLAY);
+    const uint8_t *buffer = display.getBuffer();
+    size_t sent = 0;
+
+    if (!shadowValid)
+    {
+        display.display();
+        memcpy(shadowBuffer, buffer, sizeof(shadowBuffer));
+        shadowValid = true;
+        sent = sizeof(shadowBuffer);
+    }
+    else
+    {
+        for (uint8_t page = 0; page < SCREEN_PAGES; page++)
+        {
+            const uint8_t *pageData = buffer + page * SCREEN_WIDTH;
+            uint8_t *shadow = shadowBuffer + page * SCREEN_WIDTH;
+            int col = 0;
+
+            while (col < SCREEN_WIDTH)
+            {
+                // Find the next changed run, extended over short unchanged gaps
+                while (col < SCREEN_WIDTH && pageData[col] == shadow[col])
+                    col++;
+                if (col == SCREEN_WIDTH)
+                    break;
+                int first = col;
+                int last = col;
+                for (int gap = 0; col < SCREEN_WIDTH && gap < RUN_MERGE_GAP; col++)
+                {
+                    if (pageData[col] != shadow[col])
+                    {
+                        last = col;
+                        gap = 0;
+                    }
+                    else
+                    {
+                        gap++;
+                    }
+                }
+
+                sent += sendPageRun(page, first, last, pageData);
+                memcpy(shadow + first, pageData + first, last - first + 1);
+                col = last + 1;
+            }
+        }
+    }
+
+    flushStats.frames++;
+    if (sent == 0)
+        flushStats.skipped++;
+    flushStats.lastBytes = sent;
+    flushStats.totalBytes += sent;
+}
 
 bool displayInit()
 {
     // Initialize I2C with the specified pins
-    Wire.begin(SDA_PIN, SCL_PIN);
+    Wire.begin(SDA_PIN, SCL_PIN, I2C_CLOCK);
 
     // Initialize the OLED display
     if (!display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS))
     {
-        Serial.println(F("SSD1306 allocation failed"));
+        LOG(DISPLAY_FAILED);
         return false;
     }
 
@@ -45,9 +144,9 @@ bool displayInit()
     // Use blue section for status
     display.setCursor(0, BLUE_SECTION_START + 4);
     display.println(F("Initializing..."));
-    display.display();
+    flushDisplay();
 
-    Serial.println("OLED display initialized successfully");
+    LOG(DISPLAY_READY);
     return true;
 }
 
@@ -61,7 +160,7 @@ void displayWeather(const WeatherData &weather, float indoorTemp, float indoorHu
     display.setCursor(0, 0);
     display.print(weather.isRealData ? "LIVE" : "SIM");
     display.print(" - ");
-    display.println(weather.weatherType);
+    display.println(weatherLabel(weather.weatherCode));
 
     // Indoor temperature and humidity
     display.setCursor(0, 8);
@@ -108,10 +207,10 @@ void displayWeather(const WeatherData &weather, float indoorTemp, float indoorHu
     display.print((char)247); // Degree symbol
     display.print("F");
 
-    display.display();
+    flushDisplay();
 }
 
-void displayMessage(const String &line1, const String &line2, const String &line3, const String &line4)
+void displayMessage(const char *line1, const char *line2, const char *line3, const char *line4)
 {
     display.clearDisplay();
     display.setTextSize(1);
@@ -124,31 +223,36 @@ void displayMessage(const String &line1, const String &line2, const String &line
     // Use blue section for remaining lines
     int yPos = BLUE_SECTION_START + 4;
 
-    if (line2.length() > 0)
+    if (line2[0] != '\0')
     {
         display.setCursor(0, yPos);
         display.println(line2);
         yPos += 10;
     }
 
-    if (line3.length() > 0)
+    if (line3[0] != '\0')
     {
         display.setCursor(0, yPos);
         display.println(line3);
         yPos += 10;
     }
 
-    if (line4.length() > 0)
+    if (line4[0] != '\0')
     {
         display.setCursor(0, yPos);
         display.println(line4);
     }
 
-    display.display();
+    flushDisplay();
 }
 
 void clearDisplay()
 {
     display.clearDisplay();
-    display.display();
+    flushDisplay();
+}
+
+const DisplayFlushStats &getDisplayFlushStats()
+{
+    return flushStats;
 }
@@ -5,6 +5,15 @@
 #include <Arduino.h>
 #include "weather.h"
 
+// Counters for display updates; only changed parts of a frame go over I2C
+struct DisplayFlushStats
+{
+    unsigned long frames;     // Display updates requested
+    unsigned long skipped;    // Updates where nothing had changed
+    unsigned long lastBytes;  // I2C payload bytes sent by the last update
+    unsigned long totalBytes; // I2C payload bytes sent since boot
+};
+
 // Initialize the OLED display
 bool displayInit();
 
@@ -12,9 +21,12 @@ bool displayInit();
 void displayWeather(const WeatherData &weather, float indoorTemp = 68.0, float indoorHumidity = 0.0);
 
 // Display a message on the OLED
-void displayMessage(const String &line1, const String &line2 = "", const String &line3 = "", const String &line4 = "");
+void displayMessage(const char *line1, const char *line2 = "", const char *line3 = "", const char *line4 = "");
 
 // Clear the display
 void clearDisplay();
 
+// Get display update counters
+const DisplayFlushStats &getDisplayFlushStats();
+
 #endif
@@ -0,0 +1,571 @@
+// history.cpp
+#include "history.h"
+#include <LittleFS.h>
+#include <cstring>
+#include "weather.h"
+#include "log.h"
+
+// Segment files start with the magic and a sequence number that grows with
+// every new segment, so the oldest one is the next to be reused. Records
+// follow: a type byte, the body length (2 bytes), the body.
+#define SEGMENT_MAGIC 0x31545348 // "HST1"; bump with any record layout change
+#define SEGMENT_HEADER_BYTES 8
+#define RECORD_HEADER_BYTES 3
+#define RECORD_SAMPLES 1 // Block of delta-encoded samples
+#define RECORD_HOUR 2    // One closed hour rollup
+
+// Sample block body: count, first and last time, the first sample's values,
+// then per further sample the time's delta-of-delta and each value's delta as
+// zigzag varints. At one sample per 30 s both are 0 or close, one byte each.
+#define BLOCK_HEADER_BYTES (1 + 4 + 4 + 2 * HISTORY_CHANNELS)
+#define BLOCK_MAX_BYTES (BLOCK_HEADER_BYTES + HISTORY_BLOCK_SAMPLES * 3 * (1 + HISTORY_CHANNELS))
+
+struct Sample
+{
+    uint32_t time;
+    int16_t values[HISTORY_CHANNELS];
+};
+
+// A closed minute or hour; count per channel, since channels can be missing
+struct Rollup
+{
+    uint32_t start; // 0 = empty slot
+    uint16_t count[HISTORY_CHANNELS];
+    int16_t min[HISTORY_CHANNELS];
+    int16_t max[HISTORY_CHANNELS];
+    int16_t avg[HISTORY_CHANNELS];
+};
+
+// The minute or hour still collecting samples
+struct Accumulator
+{
+    uint32_t start;
+    uint16_t count[HISTORY_CHANNELS];
+    int16_t min[HISTORY_CHANNELS];
+    int16_t max[HISTORY_CHANNELS];
+    int32_t sum[HISTORY_CHANNELS];
+};
+
+struct Segment
+{
+    uint32_t sequence; // 0 = unused
+    uint32_t size;
+};
+
+static Sample raw[HISTORY_RAW_SAMPLES];
+static uint32_t rawCount = 0;   // Samples ever added; the newest is raw[(rawCount - 1) % size]
+static uint32_t rawFlushed = 0; // Samples before this one have gone to flash
+static Rollup minutes[HISTORY_MINUTES];
+static Rollup hours[HISTORY_HOURS];
+static Accumulator openMinute = {};
+static Accumulator openHour = {};
+static uint32_t firstMinute = 0; // Start of the first minute since boot
+static Segment segments[HISTORY_SEGMENTS];
+static uint8_t currentSegment = 0;
+static bool mounted = false;
+static HistoryStats stats = {};
+
+static int32_t querySums[HISTORY_QUERY_MAX_POINTS];
+
+static const Sample &rawAt(uint32_t index)
+{
+    return raw[index & (HISTORY_RAW_SAMPLES - 1)];
+}
+
+static void segmentPath(uint8_t slot, char *path, size_t size)
+{
+    snprintf(path, size, "/history/%u.seg", slot);
+}
+
+static uint8_t *putVarint(uint8_t *p, int32_t value)
+{
+    uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    while (zigzag >= 0x80)
+    {
+        *p++ = zigzag | 0x80;
+        zigzag >>= 7;
+    }
+    *p++ = zigzag;
+    return p;
+}
+
+static bool getVarint(const uint8_t *&p, const uint8_t *end, int32_t &value)
+{
+    uint32_t zigzag = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        if (p == end)
+        {
+            return false;
+        }
+        uint8_t byte = *p++;
+        zigzag |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            value = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+static size_t encodeBlock(uint32_t first, uint32_t count, uint8_t *out)
+{
+    const Sample &head = rawAt(first);
+    const Sample &tail = rawAt(first + count - 1);
+    uint8_t *p = out;
+    *p++ = count;
+    memcpy(p, &head.time, 4);
+    memcpy(p + 4, &tail.time, 4);
+    memcpy(p + 8, head.values, sizeof(head.values));
+    p += 8 + sizeof(head.values);
+
+    int32_t lastDelta = 0;
+    for (uint32_t i = first + 1; i < first + count; i++)
+    {
+        const Sample &previous = rawAt(i - 1);
+        const Sample &sample = rawAt(i);
+        int32_t delta = sample.time - previous.time;
+        p = putVarint(p, delta - lastDelta);
+        lastDelta = delta;
+        for (int ch = 0; ch < HISTORY_CHANNELS; ch++)
+        {
+            p = putVarint(p, (int32_t)sample.values[ch] - previous.values[ch]);
+        }
+    }
+    return p - out;
+}
+
+// Calls fn(sample) for every sample of a block body; false if it is damaged
+template <typename Fn>
+static bool decodeBlock(const uint8_t *body, size_t length, Fn fn)
+{
+    if (length < BLOCK_HEADER_BYTES)
+    {
+        return false;
+    }
+    const uint8_t *end = body + length;
+    uint8_t count = body[0];
+    Sample sample;
+    memcpy(&sample.time, body + 1, 4);
+    memcpy(sample.values, body + 9, sizeof(sample.values));
+    const uint8_t *p = body + BLOCK_HEADER_BYTES;
+    fn(sample);
+
+    int32_t delta = 0;
+    for (int i = 1; i < count; i++)
+    {
+        int32_t value;
+        if (!getVarint(p, end, value))
+        {
+            return false;
+        }
+        delta += value;
+        sample.time += delta;
+        for (int ch = 0; ch < HISTORY_CHANNELS; ch++)
+        {
+            if (!getVarint(p, end, value))
+            {
+                return false;
+            }
+            sample.values[ch] += value;
+        }
+        fn(sample);
+    }
+    return true;
+}
+
+static bool writeRecord(uint8_t type, const uint8_t *body, size_t length)
+{
+    if (!mounted)
+    {
+        return false;
+    }
+
+    // Move on to the oldest segment once this one is full; recreating it
+    // drops a day of the oldest samples
+    Segment *segment = &segments[currentSegment];
+    if (segment->sequence == 0 || segment->size + RECORD_HEADER_BYTES + length > HISTORY_SEGMENT_BYTES)
+    {
+        uint32_t sequence = 0;
+        uint8_t oldest = 0;
+        for (uint8_t slot = 0; slot < HISTORY_SEGMENTS; slot++)
+        {
+            sequence = max(sequence, segments[slot].sequence);
+            if (segments[slot].sequence < segments[oldest].sequence)
+            {
+                oldest = slot;
+            }
+        }
+        char path[24];
+        segmentPath(oldest, path, sizeof(path));
+        File file = LittleFS.open(path, FILE_WRITE);
+        uint32_t header[2] = {SEGMENT_MAGIC, sequence + 1};
+        if (!file || file.write((const uint8_t *)header, sizeof(header)) != sizeof(header))
+        {
+            return false;
+        }
+        file.close();
+        if (segments[oldest].sequence == 0)
+        {
+            stats.segmentsInUse++;
+        }
+        currentSegment = oldest;
+        segment = &segments[oldest];
+        segment->sequence = sequence + 1;
+        segment->size = SEGMENT_HEADER_BYTES;
+    }
+
+    char path[24];
+    segmentPath(currentSegment, path, sizeof(path));
+    File file = LittleFS.open(path, FILE_APPEND);
+    uint8_t header[RECORD_HEADER_BYTES] = {type, (uint8_t)(length & 0xFF), (uint8_t)(length >> 8)};
+    bool ok = file && file.write(header, sizeof(header)) == sizeof(header) && file.write(body, length) == length;
+    file.close();
+    if (ok)
+    {
+        segment->size += RECORD_HEADER_BYTES + length;
+        stats.flashBytes += RECORD_HEADER_BYTES + length;
+    }
+    return ok;
+}
+
+static void flushBlock()
+{
+    uint8_t body[BLOCK_MAX_BYTES];
+    size_t length = encodeBlock(rawFlushed, HISTORY_BLOCK_SAMPLES, body);
+    if (writeRecord(RECORD_SAMPLES, body, length))
+    {
+        stats.blocks++;
+    }
+    rawFlushed += HISTORY_BLOCK_SAMPLES;
+}
+
+static void storeHour(const Rollup &hour)
+{
+    Rollup &slot = hours[hour.start / 3600 % HISTORY_HOURS];
+    if (hour.start > slot.start)
+    {
+        slot = hour;
+    }
+}
+
+static void closeRollup(Accumulator &acc, Rollup *ring, size_t size, uint32_t period)
+{
+    Rollup &slot = ring[acc.start / period % size];
+    slot.start = acc.start;
+    for (int ch = 0; ch < HISTORY_CHANNELS; ch++)
+    {
+        slot.count[ch] = acc.count[ch];
+        slot.min[ch] = acc.min[ch];
+        slot.max[ch] = acc.max[ch];
+        slot.avg[ch] = acc.count[ch] ? (acc.sum[ch] + (int32_t)acc.count[ch] / 2) / acc.count[ch] : HISTORY_MISSING;
+    }
+    if (ring == hours)
+    {
+        writeRecord(RECORD_HOUR, (const uint8_t *)&slot, sizeof(slot));
+    }
+}
+
+static void addToRollup(Accumulator &acc, Rollup *ring, size_t size, uint32_t period, const Sample &sample)
+{
+    uint32_t start = sample.time - sample.time % period;
+    if (acc.start != start)
+    {
+        if (acc.start != 0)
+        {
+            closeRollup(acc, ring, size, period);
+        }
+        acc = {};
+        acc.start = start;
+    }
+    for (int ch = 0; ch < HISTORY_CHANNELS; ch++)
+    {
+        int16_t value = sample.values[ch];
+        if (value == HISTORY_MISSING)
+        {
+            continue;
+        }
+        if (acc.count[ch] == 0 || value < acc.min[ch])
+        {
+            acc.min[ch] = value;
+        }
+        if (acc.count[ch] == 0 || value > acc.max[ch])
+        {
+            acc.max[ch] = value;
+        }
+        acc.sum[ch] += value;
+        acc.count[ch]++;
+    }
+}
+
+// Walk the records of every segment, oldest first. fn(type, file, length)
+// either reads the body or leaves it; the walk seeks past it either way.
+template <typename Fn>
+static void forEachRecord(Fn fn)
+{
+    uint8_t order[HISTORY_SEGMENTS];
+    uint8_t used = 0;
+    for (uint8_t slot = 0; slot < HISTORY_SEGMENTS; slot++)
+    {
+        if (segments[slot].sequence == 0)
+        {
+            continue;
+        }
+        uint8_t at = used++;
+        while (at > 0 && segments[order[at - 1]].sequence > segments[slot].sequence)
+        {
+            order[at] = order[at - 1];
+            at--;
+        }
+        order[at] = slot;
+    }
+
+    for (uint8_t i = 0; i < used; i++)
+    {
+        char path[24];
+        segmentPath(order[i], path, sizeof(path));
+        File file = LittleFS.open(path, FILE_READ);
+        size_t position = SEGMENT_HEADER_BYTES;
+        uint8_t header[RECORD_HEADER_BYTES];
+        while (file && file.seek(position) && file.read(header, sizeof(header)) == sizeof(header))
+        {
+            size_t length = header[1] | header[2] << 8;
+            position += RECORD_HEADER_BYTES + length;
+            if (position > file.size())
+            {
+                break;
+            }
+            fn(header[0], file, length);
+        }
+        file.close();
+    }
+}
+
+bool historyInit()
+{
+    // Start from what flash holds, as after a reboot
+    rawCount = rawFlushed = 0;
+    memset(minutes, 0, sizeof(minutes));
+    memset(hours, 0, sizeof(hours));
+    openMinute = openHour = {};
+    firstMinute = 0;
+    currentSegment = 0;
+    stats = {};
+
+    mounted = LittleFS.begin(true);
+    if (!mounted)
+    {
+        LOG(HISTORY_NO_FS);
+        return false;
+    }
+    LittleFS.mkdir("/history");
+
+    for (uint8_t slot = 0; slot < HISTORY_SEGMENTS; slot++)
+    {
+        char path[24];
+        segmentPath(slot, path, sizeof(path));
+        segments[slot] = {};
+        File file = LittleFS.open(path, FILE_READ);
+        uint32_t header[2];
+        if (file && file.read((uint8_t *)header, sizeof(header)) == sizeof(header) && header[0] == SEGMENT_MAGIC)
+        {
+            segments[slot] = {header[1], (uint32_t)file.size()};
+            stats.segmentsInUse++;
+            if (header[1] > segments[currentSegment].sequence)
+            {
+                currentSegment = slot;
+            }
+        }
+        file.close();
+    }
+
+    // Only the block headers and the hour records are read here
+    uint16_t hoursLoaded = 0;
+    forEachRecord([&](uint8_t type, File &file, size_t length) {
+        uint8_t head[9];
+        Rollup hour;
+        if (type == RECORD_HOUR && length == sizeof(hour) && file.read((uint8_t *)&hour, sizeof(hour)) == length)
+        {
+            storeHour(hour);
+            hoursLoaded++;
+        }
+        else if (type == RECORD_SAMPLES && stats.oldestTime == 0 && length >= BLOCK_HEADER_BYTES &&
+                 file.read(head, sizeof(head)) == sizeof(head))
+        {
+            memcpy(&stats.oldestTime, head + 1, 4);
+        }
+    });
+    LOG(HISTORY_LOADED, stats.segmentsInUse, hoursLoaded);
+    return true;
+}
+
+void historyAdd(const int16_t values[HISTORY_CHANNELS])
+{
+    // A clock stepped back by SNTP would break the deltas; wait it out
+    uint32_t now = weatherClock();
+    if (now == 0 || (rawCount > 0 && now <= rawAt(rawCount - 1).time))
+    {
+        stats.skipped++;
+        return;
+    }
+
+    Sample &sample = raw[rawCount & (HISTORY_RAW_SAMPLES - 1)];
+    sample.time = now;
+    memcpy(sample.values, values, sizeof(sample.values));
+    rawCount++;
+    stats.samples++;
+    if (stats.oldestTime == 0)
+    {
+        stats.oldestTime = now;
+    }
+    if (firstMinute == 0)
+    {
+        firstMinute = now - now % 60;
+    }
+
+    addToRollup(openMinute, minutes, HISTORY_MINUTES, 60, sample);
+    addToRollup(openHour, hours, HISTORY_HOURS, 3600, sample);
+    if (rawCount - rawFlushed >= HISTORY_BLOCK_SAMPLES)
+    {
+        flushBlock();
+    }
+}
+
+namespace
+{
+    struct Query
+    {
+        uint32_t from;
+        uint32_t to;
+        uint32_t step;
+        HistoryPoint *out;
+        size_t points;
+
+        void add(uint32_t time, int16_t min, int16_t max, int32_t sum, uint16_t count) const
+        {
+            if (count == 0 || time < from || time >= to)
+            {
+                return;
+            }
+            size_t i = (time - from) / step;
+            if (i >= points)
+            {
+                return;
+            }
+            HistoryPoint &point = out[i];
+            if (point.count == 0 || min < point.min)
+            {
+                point.min = min;
+            }
+            if (point.count == 0 || max > point.max)
+            {
+                point.max = max;
+            }
+            point.count += count;
+            querySums[i] += sum;
+        }
+
+        void add(const Sample &sample, HistoryChannel channel) const
+        {
+            int16_t value = sample.values[channel];
+            if (value != HISTORY_MISSING)
+            {
+                add(sample.time, value, value, value, 1);
+            }
+        }
+
+        void add(const Rollup &rollup, HistoryChannel channel) const
+        {
+            add(rollup.start, rollup.min[channel], rollup.max[channel],
+                (int32_t)rollup.avg[channel] * rollup.count[channel], rollup.count[channel]);
+        }
+
+        void add(const Accumulator &acc, HistoryChannel channel) const
+        {
+            add(acc.start, acc.min[channel], acc.max[channel], acc.sum[channel], acc.count[channel]);
+        }
+    };
+}
+
+size_t historyQuery(HistoryChannel channel, uint32_t from, uint32_t to, uint32_t stepSeconds, HistoryPoint *out,
+                    size_t maxPoints)
+{
+    if (channel >= HISTORY_CHANNELS || stepSeconds == 0 || to <= from || maxPoints == 0)
+    {
+        return 0;
+    }
+    size_t points = min((size_t)((to - from + stepSeconds - 1) / stepSeconds), maxPoints);
+    points = min(points, (size_t)HISTORY_QUERY_MAX_POINTS);
+    for (size_t i = 0; i < points; i++)
+    {
+        out[i] = {from + (uint32_t)i * stepSeconds, 0, HISTORY_MISSING, HISTORY_MISSING, HISTORY_MISSING};
+        querySums[i] = 0;
+    }
+    Query query = {from, to, stepSeconds, out, points};
+
+    uint32_t newestMinute = openMinute.start;
+    uint32_t minuteReach = newestMinute >= (HISTORY_MINUTES - 1) * 60 ? newestMinute - (HISTORY_MINUTES - 1) * 60 : 0;
+    if (stepSeconds % 3600 == 0)
+    {
+        for (const Rollup &hour : hours)
+        {
+            query.add(hour, channel);
+        }
+        query.add(openHour, channel);
+    }
+    else if (stepSeconds % 60 == 0 && firstMinute != 0 && from >= max(firstMinute, minuteReach))
+    {
+        for (const Rollup &minute : minutes)
+        {
+            query.add(minute, channel);
+        }
+        query.add(openMinute, channel);
+    }
+    else
+    {
+        // Flash only holds what RAM no longer does
+        uint32_t oldest = rawCount > HISTORY_RAW_SAMPLES ? rawCount - HISTORY_RAW_SAMPLES : 0;
+        uint32_t first = rawFlushed;
+        if (rawCount == 0 || from < rawAt(oldest).time)
+        {
+            forEachRecord([&](uint8_t type, File &file, size_t length) {
+                uint8_t body[BLOCK_MAX_BYTES];
+                uint32_t span[2];
+                if (type != RECORD_SAMPLES || length < BLOCK_HEADER_BYTES || length > sizeof(body) ||
+                    file.read(body, 9) != 9)
+                {
+                    return;
+                }
+                memcpy(span, body + 1, sizeof(span));
+                if (span[1] < from || span[0] >= to || file.read(body + 9, length - 9) != length - 9)
+                {
+                    return;
+                }
+                decodeBlock(body, length, [&](const Sample &sample) { query.add(sample, channel); });
+            });
+        }
+        else
+        {
+            first = oldest;
+        }
+        for (uint32_t i = max(first, oldest); i < rawCount; i++)
+        {
+            query.add(rawAt(i), channel);
+        }
+    }
+
+    for (size_t i = 0; i < points; i++)
+    {
+        if (out[i].count > 0)
+        {
+            out[i].avg = (querySums[i] + (int32_t)out[i].count / 2) / out[i].count;
+        }
+    }
+    return points;
+}
+
+const HistoryStats &getHistoryStats()
+{
+    return stats;
+}
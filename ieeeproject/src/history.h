@@ -0,0 +1,73 @@
+// history.h
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <Arduino.h>
+
+// Recent samples stay raw in RAM. Every HISTORY_BLOCK_SAMPLES of them are
+// delta encoded into a block and appended to a LittleFS segment; the segments
+// are reused oldest first, so flash wear spreads over all of them. Minute and
+// hour rollups (min, max, average) are kept in RAM for the ranges a display
+// or a serial dump usually asks for; the hour rollups also go into the
+// segments and are reloaded at boot.
+#define HISTORY_RAW_SAMPLES 128       // RAM ring, power of two; 32 min to 8 h as the read rate adapts
+#define HISTORY_BLOCK_SAMPLES 64      // Samples per flash block
+#define HISTORY_MINUTES 120           // Minute rollups kept in RAM
+#define HISTORY_HOURS 168             // Hour rollups kept in RAM, a week
+#define HISTORY_SEGMENTS 8            // Segment files on LittleFS
+#define HISTORY_SEGMENT_BYTES 16384   // Start a new segment past this size; about a day of samples each
+#define HISTORY_QUERY_MAX_POINTS 240  // Buckets one query fills at most
+
+// A channel with no value at a sample, e.g. outdoor temperature before any
+// weather has arrived
+#define HISTORY_MISSING INT16_MIN
+
+// Values are stored in tenths: 0.1 F, 0.1 % RH, 0.1 degree of servo travel
+enum HistoryChannel : uint8_t
+{
+    HISTORY_INDOOR_TEMP,
+    HISTORY_HUMIDITY,
+    HISTORY_OUTDOOR_TEMP,
+    HISTORY_WINDOW,
+    HISTORY_CHANNELS
+};
+
+// One bucket of a query; count is 0 when no sample fell into it
+struct HistoryPoint
+{
+    uint32_t time; // Bucket start, Unix time
+    uint16_t count;
+    int16_t min;
+    int16_t max;
+    int16_t avg;
+};
+
+struct HistoryStats
+{
+    uint32_t samples;      // Added since boot
+    uint32_t skipped;      // Offered before the clock was set
+    uint32_t blocks;       // Written to flash since boot
+    uint32_t flashBytes;   // Written to flash since boot
+    uint32_t oldestTime;   // Oldest sample anywhere, 0 if none
+    uint8_t segmentsInUse;
+};
+
+// Mount LittleFS (formatting it if it will not mount) and reload the hour
+// rollups from the segments
+bool historyInit();
+
+// Record one sample per channel, in tenths. Samples wait for a valid wall
+// clock, since they have to line up across reboots.
+void historyAdd(const int16_t values[HISTORY_CHANNELS]);
+
+// min/max/avg of one channel per stepSeconds bucket from `from` up to `to`,
+// oldest first, at most maxPoints buckets. Hour steps are answered from the
+// hour rollups, minute steps from the minute rollups while they reach back
+// far enough, anything else from the raw samples in RAM and on flash (blocks
+// outside the range are skipped unread). Loop task only.
+size_t historyQuery(HistoryChannel channel, uint32_t from, uint32_t to, uint32_t stepSeconds, HistoryPoint *out,
+                    size_t maxPoints);
+
+const HistoryStats &getHistoryStats();
+
+#endif
@@ -0,0 +1,262 @@
+// log.cpp
+#include "log.h"
+#include <atomic>
+
+#ifdef NATIVE_BUILD
+#include "NativeHal.h"
+#endif
+
+static const char *const MESSAGE_FORMATS[] = {
+#define LOG_MESSAGE(name, level, format) format,
+#include "log_messages.h"
+#undef LOG_MESSAGE
+};
+
+// Bounded multi-producer ring: a producer claims a slot by advancing
+// enqueuePos, fills it and publishes it through the slot's sequence number;
+// the drain task is the only consumer. Sequence numbers are kept relative to
+// the slot index so that the zeroed ring is already valid: slot i is free for
+// position p when sequence + i == p and holds position p when it is p + 1.
+struct LogSlot
+{
+    std::atomic<uint32_t> sequence;
+    uint32_t timeMs;
+    LogId id;
+    uint8_t size;
+    uint8_t payload[LOG_PAYLOAD_BYTES];
+};
+
+static LogSlot ring[LOG_RING_SLOTS];
+static std::atomic<uint32_t> enqueuePos(0);
+static uint32_t dequeuePos = 0; // Drain task only
+static std::atomic<uint32_t> written(0);
+static std::atomic<uint32_t> dropped(0);
+static uint32_t droppedReported = 0; // Drain task only
+
+#ifndef NATIVE_BUILD
+static TaskHandle_t logTaskHandle = nullptr;
+static const uint32_t LOG_TASK_STACK = 3072;
+#endif
+
+void logPack(LogPayload &payload, const void *value, size_t size)
+{
+    if (payload.size + size <= LOG_PAYLOAD_BYTES)
+    {
+        memcpy(payload.bytes + payload.size, value, size);
+        payload.size += size;
+    }
+}
+
+void logPack(LogPayload &payload, const char *text)
+{
+    // Always terminated; an over-long string loses its tail
+    size_t room = LOG_PAYLOAD_BYTES - payload.size;
+    if (room == 0)
+    {
+        return;
+    }
+    size_t length = strnlen(text ? text : "", room - 1);
+    memcpy(payload.bytes + payload.size, text ? text : "", length);
+    payload.bytes[payload.size + length] = '\0';
+    payload.size += length + 1;
+}
+
+// Claim a slot and fill it; false when the ring is full
+static bool tryLogSubmit(LogId id, const LogPayload &payload)
+{
+    uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+    LogSlot *slot;
+    for (;;)
+    {
+        uint32_t index = pos & (LOG_RING_SLOTS - 1);
+        slot = &ring[index];
+        int32_t lag = (int32_t)(slot->sequence.load(std::memory_order_acquire) + index - pos);
+        if (lag < 0)
+        {
+            // The drain task has not got this far round yet
+            return false;
+        }
+        if (lag == 0 && enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+            break;
+        }
+        if (lag > 0)
+        {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->timeMs = millis();
+    slot->id = id;
+    slot->size = payload.size;
+    memcpy(slot->payload, payload.bytes, payload.size);
+    slot->sequence.store(pos + 1 - (pos & (LOG_RING_SLOTS - 1)), std::memory_order_release);
+    written.fetch_add(1, std::memory_order_relaxed);
+
+#ifndef NATIVE_BUILD
+    if (logTaskHandle)
+    {
+        xTaskNotifyGive(logTaskHandle);
+    }
+#endif
+    return true;
+}
+
+void logSubmit(LogId id, const LogPayload &payload)
+{
+    if (!tryLogSubmit(id, payload))
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void logSubmitWaiting(LogId id, const LogPayload &payload)
+{
+    while (!tryLogSubmit(id, payload))
+    {
+#ifdef NATIVE_BUILD
+        logDrain();
+#else
+        vTaskDelay(1);
+#endif
+    }
+}
+
+#if LOG_BINARY
+
+static void writeRecord(LogId id, uint32_t timeMs, const uint8_t *payload, uint8_t size)
+{
+    uint8_t header[7] = {LOG_FRAME_MARKER, id, size, (uint8_t)timeMs, (uint8_t)(timeMs >> 8),
+                         (uint8_t)(timeMs >> 16), (uint8_t)(timeMs >> 24)};
+    Serial.write(header, sizeof(header));
+    Serial.write(payload, size);
+}
+
+#else
+
+// printf one conversion at a time, taking each argument from the payload in
+// the type the conversion asks for
+static void writeRecord(LogId id, uint32_t, const uint8_t *payload, uint8_t size)
+{
+    char line[160];
+    size_t used = 0;
+    size_t offset = 0;
+    for (const char *f = MESSAGE_FORMATS[id]; *f && used < sizeof(line) - 1;)
+    {
+        if (*f != '%' || f[1] == '%')
+        {
+            line[used++] = *f;
+            f += *f == '%' ? 2 : 1;
+            continue;
+        }
+
+        // Copy flags, width and precision; drop length modifiers
+        char spec[16];
+        size_t specLength = 0;
+        spec[specLength++] = *f++;
+        while (*f && strchr("-+ #0123456789.", *f) && specLength < sizeof(spec) - 3)
+        {
+            spec[specLength++] = *f++;
+        }
+        while (*f && strchr("hlz", *f))
+        {
+            f++;
+        }
+        char conversion = *f ? *f++ : 'd';
+        spec[specLength++] = conversion;
+        spec[specLength] = '\0';
+
+        size_t room = sizeof(line) - used;
+        int n = 0;
+        if (conversion == 's')
+        {
+            const char *text = offset < size ? (const char *)payload + offset : "";
+            n = snprintf(line + used, room, spec, text);
+            offset += strnlen(text, size - min(offset, (size_t)size)) + 1;
+        }
+        else
+        {
+            uint32_t raw = 0;
+            if (offset + sizeof(raw) <= size)
+            {
+                memcpy(&raw, payload + offset, sizeof(raw));
+            }
+            offset += sizeof(raw);
+            if (strchr("eEfFgG", conversion))
+            {
+                float number;
+                memcpy(&number, &raw, sizeof(number));
+                n = snprintf(line + used, room, spec, (double)number);
+            }
+            else if (strchr("di", conversion))
+            {
+                n = snprintf(line + used, room, spec, (int)(int32_t)raw);
+            }
+            else
+            {
+                n = snprintf(line + used, room, spec, (unsigned)raw);
+            }
+        }
+        used += n < 0 ? 0 : min((size_t)n, room - 1);
+    }
+    line[used++] = '\n';
+    Serial.write((const uint8_t *)line, used);
+}
+
+#endif // LOG_BINARY
+
+void logDrain()
+{
+    for (;;)
+    {
+        uint32_t index = dequeuePos & (LOG_RING_SLOTS - 1);
+        LogSlot &slot = ring[index];
+        if (slot.sequence.load(std::memory_order_acquire) + index != dequeuePos + 1)
+        {
+            break;
+        }
+        writeRecord(slot.id, slot.timeMs, slot.payload, slot.size);
+        slot.sequence.store(dequeuePos + LOG_RING_SLOTS - index, std::memory_order_release);
+        dequeuePos++;
+    }
+
+    // Say how many went missing once the backlog is out, so the gap shows
+    // where it happened
+    uint32_t lost = dropped.load(std::memory_order_relaxed);
+    if (lost != droppedReported)
+    {
+        LogPayload payload = {};
+        logPack(payload, lost - droppedReported);
+        writeRecord(LOG_DROPPED, millis(), payload.bytes, payload.size);
+        droppedReported = lost;
+    }
+}
+
+#ifndef NATIVE_BUILD
+static void logTask(void *)
+{
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        logDrain();
+    }
+}
+#endif
+
+void logInit()
+{
+#ifdef NATIVE_BUILD
+    // No tasks on the host: drain whenever the firmware blocks, off the
+    // clock, which is when the low-priority task would get the CPU
+    hal::setIdleTask(logDrain);
+#else
+    // Below the loop and weather tasks: it only runs when they wait
+    xTaskCreate(logTask, "log", LOG_TASK_STACK, nullptr, tskIDLE_PRIORITY, &logTaskHandle);
+    xTaskNotifyGive(logTaskHandle);
+#endif
+}
+
+LogStats getLogStats()
+{
+    return {written.load(std::memory_order_relaxed), dropped.load(std::memory_order_relaxed)};
+}
@@ -0,0 +1,113 @@
+// log.h
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+#include <type_traits>
+
+#define LOG_LEVEL_ERROR 0
+#define LOG_LEVEL_WARN 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_DEBUG 3
+
+// Messages above this level compile out entirely, arguments and all
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// 1: the drain task writes raw records for tools/log_decode.py instead of
+// formatting text on the device
+#ifndef LOG_BINARY
+#define LOG_BINARY 0
+#endif
+
+#define LOG_RING_SLOTS 64    // Power of two
+#define LOG_PAYLOAD_BYTES 28 // Packed arguments per record
+
+// Binary records go out as LOG_FRAME_MARKER, ID, payload size, the timestamp
+// in milliseconds (4 bytes, little-endian), then the payload. The marker
+// never appears in the text the firmware prints.
+#define LOG_FRAME_MARKER 0x1E
+
+enum LogId : uint8_t
+{
+#define LOG_MESSAGE(name, level, format) LOG_##name,
+#include "log_messages.h"
+#undef LOG_MESSAGE
+    LOG_MESSAGE_COUNT
+};
+
+constexpr uint8_t LOG_MESSAGE_LEVELS[] = {
+#define LOG_MESSAGE(name, level, format) LOG_LEVEL_##level,
+#include "log_messages.h"
+#undef LOG_MESSAGE
+};
+
+// Arguments packed back to back in the order the format reads them
+struct LogPayload
+{
+    uint8_t size;
+    uint8_t bytes[LOG_PAYLOAD_BYTES];
+};
+
+void logPack(LogPayload &payload, const void *value, size_t size);
+void logPack(LogPayload &payload, const char *text);
+
+template <typename T>
+inline void logPack(LogPayload &payload, T value)
+{
+    static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "log arguments are numbers or strings");
+    if constexpr (std::is_floating_point<T>::value)
+    {
+        float number = value;
+        logPack(payload, &number, sizeof(number));
+    }
+    else
+    {
+        int32_t number = (int32_t)value;
+        logPack(payload, &number, sizeof(number));
+    }
+}
+
+// Queue a record without waiting; when the ring is full it is dropped and
+// counted instead. Safe from any task, not from an ISR.
+void logSubmit(LogId id, const LogPayload &payload);
+
+// Queue a record, waiting for the drain task to make room instead of
+// dropping it. For records that are useless with gaps (trace capture); not
+// from an ISR.
+void logSubmitWaiting(LogId id, const LogPayload &payload);
+
+template <LogId id, typename... Args>
+inline void logMessage(Args... args)
+{
+    if constexpr (LOG_MESSAGE_LEVELS[id] <= LOG_LEVEL)
+    {
+        LogPayload payload;
+        payload.size = 0;
+        (logPack(payload, args), ...);
+        logSubmit(id, payload);
+    }
+}
+
+// LOG(WIFI_LOST) or LOG(WINDOW_POSITION, position): the name of a message
+// in log_messages.h and its arguments. The caller only packs a few bytes;
+// formatting and the UART happen on the drain task.
+#define LOG(name, ...) logMessage<LOG_##name>(__VA_ARGS__)
+
+// Start the drain task. Records queued before this wait for it.
+void logInit();
+
+// Write out everything queued so far. The drain task calls it; the host runs
+// it whenever the firmware blocks.
+void logDrain();
+
+// Records queued and dropped since boot
+struct LogStats
+{
+    uint32_t written;
+    uint32_t dropped;
+};
+LogStats getLogStats();
+
+#endif
@@ -0,0 +1,55 @@
+// log_messages.h - every log message, expanded by whoever defines LOG_MESSAGE
+//
+// LOG_MESSAGE(name, level, format): the message ID is its position in this
+// list and is all that travels in a binary record, so only ever append, and
+// keep each entry on one line for tools/log_decode.py. Formats take %d %i %u
+// %x %X %c %e %f %g and %s, with the usual flags, width and precision; numbers
+// travel as 32 bits, strings are copied into the record and cut to fit.
+
+LOG_MESSAGE(DROPPED, WARN, "[log] %u messages dropped, ring full")
+LOG_MESSAGE(DHT_READY, INFO, "DHT sensor initialized")
+LOG_MESSAGE(DHT_FAILED, WARN, "Failed to read from DHT sensor: %s")
+LOG_MESSAGE(DHT_READING, INFO, "Local Temperature: %.2f °F, Humidity: %.2f %%")
+LOG_MESSAGE(WINDOW_READY, INFO, "Window controller initialized")
+LOG_MESSAGE(WINDOW_TEST_START, INFO, "Testing window controller...")
+LOG_MESSAGE(WINDOW_TEST_DONE, INFO, "Window controller test complete")
+LOG_MESSAGE(WINDOW_BAD_WEATHER, INFO, "Closing window due to bad weather")
+LOG_MESSAGE(WINDOW_COOL_ROOM, INFO, "Opening window fully to cool room")
+LOG_MESSAGE(WINDOW_KEEP_HEAT_OUT, INFO, "Closing window to keep heat out")
+LOG_MESSAGE(WINDOW_WARM_ROOM, INFO, "Opening window fully to warm room")
+LOG_MESSAGE(WINDOW_KEEP_COLD_OUT, INFO, "Closing window to keep cold out")
+LOG_MESSAGE(WINDOW_IN_RANGE, INFO, "Closing window - temperature is in acceptable range")
+LOG_MESSAGE(WINDOW_POSITION, INFO, "Window position set to: %d")
+LOG_MESSAGE(DISPLAY_FAILED, ERROR, "SSD1306 allocation failed")
+LOG_MESSAGE(DISPLAY_READY, INFO, "OLED display initialized successfully")
+LOG_MESSAGE(WIFI_CACHED_AP, INFO, "WiFi: cached AP %02x:%02x:%02x:%02x:%02x:%02x on channel %u")
+LOG_MESSAGE(WIFI_CONNECTING, INFO, "Connecting to WiFi network: %s")
+LOG_MESSAGE(WIFI_CONNECTED, INFO, "WiFi connected in %lu ms (%s)")
+LOG_MESSAGE(WIFI_ADDRESS, INFO, "WiFi IP %u.%u.%u.%u")
+LOG_MESSAGE(WIFI_FAILED, WARN, "WiFi connect failed, retrying in %lu s")
+LOG_MESSAGE(WIFI_LOST, WARN, "WiFi link lost, reconnecting")
+LOG_MESSAGE(WEATHER_FETCHING, INFO, "--- Fetching weather data ---")
+LOG_MESSAGE(WEATHER_DNS_FAILED, ERROR, "DNS lookup failed for api.open-meteo.com")
+LOG_MESSAGE(WEATHER_CONNECT_FAILED, ERROR, "Could not connect to api.open-meteo.com")
+LOG_MESSAGE(WEATHER_REQUEST, DEBUG, "Sending GET request to api.open-meteo.com")
+LOG_MESSAGE(WEATHER_HTTP_CODE, DEBUG, "HTTP response code: %d")
+LOG_MESSAGE(WEATHER_HTTP_FAILED, WARN, "HTTP request failed with error code: %d")
+LOG_MESSAGE(WEATHER_JSON_FAILED, ERROR, "JSON parsing failed: %s")
+LOG_MESSAGE(WEATHER_CURRENT, INFO, "Weather: %.1f °F, wind %.1f MPH, %s")
+LOG_MESSAGE(WEATHER_PRECIPITATION, INFO, "Precipitation: %.2f mm, chance %d%%")
+LOG_MESSAGE(WEATHER_TIMING, INFO, "Fetched in: DNS %u ms, connect + TLS %u ms, first byte %u ms, body %u ms")
+LOG_MESSAGE(WEATHER_FAKE, INFO, "Fake weather: %.1f °F, wind %.1f MPH, %s")
+LOG_MESSAGE(WEATHER_FAKE_PRECIPITATION, INFO, "Fake precipitation: %.2f in, chance %d%%")
+LOG_MESSAGE(DHT_NO_CAPTURE, ERROR, "DHT capture failed to start (RMT channel or timer)")
+LOG_MESSAGE(HISTORY_NO_FS, ERROR, "History: LittleFS would not mount, keeping RAM only")
+LOG_MESSAGE(HISTORY_LOADED, INFO, "History: %u segments, %u hour rollups reloaded")
+LOG_MESSAGE(WINDOW_DECISION, INFO, "Window %s: %d -> %d, indoor %.1f °F, outdoor %.1f °F")
+LOG_MESSAGE(WINDOW_DEFERRED, DEBUG, "Window move %d -> %d held back by the actuation budget")
+LOG_MESSAGE(WINDOW_POLICY, INFO, "Window policy: %s")
+LOG_MESSAGE(WINDOW_NO_WEATHER, INFO, "Closing window until real weather data arrives")
+LOG_MESSAGE(TRACE_DHT, INFO, "Trace: DHT read started at %u ms: status %u, bytes %u %u %u %u %u")
+LOG_MESSAGE(TRACE_HTTP, INFO, "Trace: weather HTTP %d, fetch started at %u ms, clock %u")
+LOG_MESSAGE(TRACE_HTTP_BODY, INFO, "Trace: weather body %s")
+LOG_MESSAGE(TRACE_SERIAL, INFO, "Trace: serial input %s")
+LOG_MESSAGE(TRACE_REST, INFO, "Trace: servo released at %d")
+LOG_MESSAGE(WEATHER_FILTER_OVERFLOWED, ERROR, "JSON filter does not fit in its document")
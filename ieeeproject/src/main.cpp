@@ -1,8 +1,19 @@
 #include <Arduino.h>
+#include <WiFi.h>
+#include <time.h>
 #include "weather.h"
+#include "network.h"
 #include "display.h"
 #include "LocalSensor.h"
 #include "WindowController.h"
+#include "Scheduler.h"
+#include "power.h"
+#include "CommandParser.h"
+#include "boot.h"
+#include "stats.h"
+#include "log.h"
+#include "history.h"
+#include "trace_capture.h"
 
 // DHT sensor setup
 #define DHTPIN 9
@@ -14,146 +25,561 @@
 // Create instances
 LocalSensor localSensor(DHTPIN, DHTTYPE);
 WindowController windowController(SERVOPIN);
+Scheduler scheduler;
 
-void setup()
-{
-  // Initialize Serial communication
-  Serial.begin(115200);
+// Jobs run from loop() by the scheduler
+JobId networkJob;
+JobId sensorJob;
+JobId weatherJob;
+JobId windowJob;
+JobId motionJob;
+JobId displayJob;
+JobId serialJob;
+
+// Scheduler jobs, defined after loop()
+unsigned long maintainNetwork();
+unsigned long readLocalSensor();
+unsigned long refreshWeatherData();
+unsigned long adjustWindow();
+unsigned long moveWindow();
+unsigned long updateDisplay();
+unsigned long handleSerialCommands();
+
+// Serial commands, defined after the jobs
+void commandWeather(const char *args);
+void commandLocal(const char *args);
+void commandWindow(const char *args);
+void commandPolicy(const char *args);
+void commandPower(const char *args);
+void commandNetwork(const char *args);
+void commandBoot(const char *args);
+void commandHistory(const char *args);
+#if STATS_ENABLED
+void commandStats(const char *args);
+#endif
+void commandHelp(const char *args);
 
-  // WAIT FOR SERIAL MONITOR TO OPEN
-  // TODO: REMOVE THIS IN PROD
-  while (!Serial)
+constexpr Command COMMANDS[] = {
+  {"weather", commandWeather, "Show the weather and start a refresh"},
+  {"local", commandLocal, "Last DHT reading, and read it again now"},
+  {"window", commandWindow, "[0-180|test]  Servo state, move the window, or sweep it"},
+  {"policy", commandPolicy, "[name]  Window control policy and actuation budget"},
+  {"power", commandPower, "Wake counts and estimated current"},
+  {"network", commandNetwork, "WiFi link state and connect times"},
+  {"boot", commandBoot, "Startup timeline"},
+  {"history", commandHistory, "[hours]  Indoor and outdoor trend, 2 h by default"},
+#if STATS_ENABLED
+  {"stats", commandStats, "[reset]  Timing histograms and counters"},
+#endif
+  {"help", commandHelp, "This list"},
+};
+CommandParser commandParser(COMMANDS);
+
+// Short description of the window opening for the status line
+const char *describeWindowPosition(int position)
+{
+  if (position == 0)
+  {
+    return "Closed";
+  }
+  else if (position < 45)
+  {
+    return "Barely Open";
+  }
+  else if (position < 90)
+  {
+    return "Partly Open";
+  }
+  else if (position < 135)
+  {
+    return "Mostly Open";
+  }
+  else
   {
-    ; // wait for serial port to connect. Needed for native USB port only
+    return "Fully Open";
   }
+}
+
+// One history sample per DHT reading, in tenths
+void recordHistory()
+{
+  const WeatherData &weather = getWeather();
+  int16_t values[HISTORY_CHANNELS];
+  values[HISTORY_INDOOR_TEMP] = lroundf(localSensor.getTemperature() * 10);
+  values[HISTORY_HUMIDITY] = lroundf(localSensor.getHumidity() * 10);
+  values[HISTORY_OUTDOOR_TEMP] = weather.isValid ? lroundf(weather.temperatureF * 10) : HISTORY_MISSING;
+  values[HISTORY_WINDOW] = windowController.getCurrentPosition() * 10;
+  historyAdd(values);
+}
 
-  delay(1000); // Give serial monitor time to start
+void setup()
+{
+  // Initialize Serial communication. Boot does not wait for a serial monitor;
+  // the startup timeline can be printed again later with "boot".
+  Serial.begin(115200);
+#if !defined(NATIVE_BUILD) && ARDUINO_USB_CDC_ON_BOOT && ARDUINO_USB_MODE
+  // With no USB host listening, drop output instead of blocking on it
+  Serial.setTxTimeoutMs(0);
+#endif
+  // Everything but command replies goes through the log ring from here
+  logInit();
+  bootMark("serial");
+
+  // Radio first: the association runs in the WiFi task while the display and
+  // sensors come up
+  networkInit([]() { scheduler.trigger(networkJob); });
+  bootMark("wifi started");
 
   Serial.println("\n\n=== ESP32 Smart Window Controller ===");
   Serial.println("Initializing...");
 
-  // Initialize display
+  // Initialize display; its splash screen stays up until the first real frame
   if (!displayInit())
   {
     Serial.println("Failed to initialize display!");
   }
-  else
-  {
-    displayMessage("Smart Window", "Initializing...");
-  }
+  bootMark("display");
 
-  // Initialize DHT sensor
+  // Initialize DHT sensor and window controller
   localSensor.begin();
-
-  // Initialize window controller
-  windowController.begin();
+  windowController.begin([]() { scheduler.trigger(motionJob); });
+  bootMark("sensor + servo");
 
   // Initialize weather module
   weatherInit();
+  bootMark("weather");
+
+  // Modem sleep for the radio, light sleep between jobs
+  powerInit();
+  bootMark("power");
+
+  // Mount flash and reload the hour rollups before the first sample arrives
+  historyInit();
+  bootMark("history");
 
-  // Get initial local sensor readings
-  localSensor.update(true);
+  // Everything periodic runs from the scheduler; the display and the command
+  // handler only run when something asks for them
+  scheduler.begin();
+  networkJob = scheduler.add("network", maintainNetwork, 0);
+  sensorJob = scheduler.add("sensor", readLocalSensor, 0);
+  weatherJob = scheduler.add("weather", refreshWeatherData, 0);
+  windowJob = scheduler.add("window", adjustWindow, 0);
+  motionJob = scheduler.add("motion", moveWindow, 0);
+  displayJob = scheduler.add("display", updateDisplay, 0);
+  serialJob = scheduler.add("serial", handleSerialCommands, 0);
 
-  // Display startup message
-  displayMessage("Smart Window", "Ready!", "Monitoring temp...");
+  // Wake the loop as soon as command bytes arrive instead of polling for them
+#if !defined(NATIVE_BUILD) && ARDUINO_USB_CDC_ON_BOOT && ARDUINO_USB_MODE
+  // Serial is the C3's USB Serial/JTAG port here, which reports RX as an event
+  Serial.onEvent(ARDUINO_HW_CDC_RX_EVENT, [](void *, esp_event_base_t, int32_t, void *) { scheduler.trigger(serialJob); });
+#else
+  Serial.onReceive([]() { scheduler.trigger(serialJob); });
+#endif
+  bootMark("scheduler");
 }
 
 void loop()
 {
-  // Update local sensor readings
-  localSensor.update();
+  // Run whatever is due, then sleep until the next deadline or serial input
+  {
+    STATS_PROBE(PROBE_LOOP);
+    scheduler.runDue();
+  }
+  scheduler.sleepUntilNext();
+}
 
-  // Get current weather data
-  WeatherData weather = getWeather();
+unsigned long maintainNetwork()
+{
+  unsigned long connects = getNetworkStats().connects;
+  unsigned long wait = updateNetwork();
+  if (getNetworkStats().connects != connects)
+  {
+    if (connects == 0)
+    {
+      bootMark("wifi link");
+    }
+    // Fresh link: swap the fake weather for real data now
+    scheduler.runAfter(weatherJob, 0);
+  }
+  return wait;
+}
 
-  // Update display with weather and window information
-  String windowStatus = "Window: ";
-  int position = windowController.getCurrentPosition();
-  if (position == 0)
+unsigned long readLocalSensor()
+{
+  bool first = !localSensor.isValid();
+  switch (localSensor.update())
   {
-    windowStatus += "Closed";
+  case SENSOR_READING:
+    return LocalSensor::POLL_INTERVAL;
+  case SENSOR_FAILED:
+    return LocalSensor::RETRY_INTERVAL;
+  default:
+    break;
   }
-  else if (position < 45)
+  if (first)
   {
-    windowStatus += "Barely Open";
+    bootMark("first DHT reading");
+    scheduler.runAfter(windowJob, 0);
   }
-  else if (position < 90)
+  recordHistory();
+  scheduler.runAfter(displayJob, 0);
+  return localSensor.nextReadInterval(windowController.getTargetDeci());
+}
+
+unsigned long refreshWeatherData()
+{
+  unsigned long publishedAt = getWeather().updatedAt;
+  unsigned long wait = updateWeather();
+  if (getWeather().updatedAt != publishedAt)
   {
-    windowStatus += "Partly Open";
+    static bool hadRealWeather = false;
+    if (getWeather().isRealData && !hadRealWeather)
+    {
+      hadRealWeather = true;
+      bootMark("real weather");
+    }
+    scheduler.runAfter(displayJob, 0);
   }
-  else if (position < 135)
+  return wait;
+}
+
+unsigned long adjustWindow()
+{
+  // Nothing to go on until the DHT has been read; the sensor job brings us
+  // back as soon as it has
+  if (!localSensor.isValid())
   {
-    windowStatus += "Mostly Open";
+    return WindowController::ADJUST_INTERVAL;
   }
-  else
+
+  // Adjust window based on temperature
+  int position = windowController.getCurrentPosition();
+  windowController.adjustBasedOnTemperature(localSensor.getTemperature(), getWeather());
+  if (windowController.getCurrentPosition() != position)
+  {
+    scheduler.runAfter(displayJob, 0);
+  }
+  if (getWeather().isValid)
   {
-    windowStatus += "Fully Open";
+    bootFinish("first window decision");
   }
+  return WindowController::ADJUST_INTERVAL;
+}
 
-  displayMessage(
-      "In: " + String(localSensor.getTemperature()) + "F Out: " + String(weather.temperatureF) + "F",
-      windowStatus,
-      weather.weatherType);
+unsigned long moveWindow()
+{
+  // One step per PWM frame while moving, then the hold before the servo is
+  // released; parked after that until the next move
+  return windowController.updateMotion();
+}
 
-  // Adjust window based on temperature
-  windowController.adjustBasedOnTemperature(localSensor.getTemperature(), weather);
+unsigned long updateDisplay()
+{
+  const WeatherData &weather = getWeather();
 
-  // Process any serial commands
-  if (Serial.available())
-  {
-    String command = Serial.readStringUntil('\n');
-    command.trim();
+  // Update display with weather and window information, formatted in place
+  char tempLine[32];
+  char statusLine[24];
+  snprintf(tempLine, sizeof(tempLine), "In: %.2fF Out: %.2fF", localSensor.getTemperature(), weather.temperatureF);
+  snprintf(statusLine, sizeof(statusLine), "Window: %s", describeWindowPosition(windowController.getCurrentPosition()));
 
-    if (command == "weather")
+  // Indoor range over the last 24 hours, straight from the hour rollups
+  char trendLine[24] = "";
+  uint32_t now = weatherClock();
+  HistoryPoint day;
+  if (now != 0)
+  {
+    uint32_t from = now - now % 3600 - 23 * 3600;
+    if (historyQuery(HISTORY_INDOOR_TEMP, from, from + 86400, 86400, &day, 1) == 1 && day.count > 0)
     {
-      Serial.println("Manual weather update requested");
-      refreshWeather();
-      weather = getWeather();
-
-      // Display weather info
-      Serial.println("\n=== Weather Conditions ===");
-      Serial.print("Data Source: ");
-      Serial.println(weather.isRealData ? "Real (API)" : "Simulated");
-      Serial.print("Temperature: ");
-      Serial.print(weather.temperatureF);
-      Serial.println(" °F");
-      Serial.print("Wind Speed: ");
-      Serial.print(weather.windSpeedMPH);
-      Serial.println(" MPH");
-      Serial.print("Weather: ");
-      Serial.println(weather.weatherType);
-      Serial.print("Precipitation: ");
-      Serial.print(weather.precipitationAmount);
-      Serial.println(weather.isRealData ? " mm" : " in");
-      Serial.print("Precipitation Chance: ");
-      Serial.print(weather.precipitationChance);
-      Serial.println("%");
-      Serial.println("==========================\n");
+      snprintf(trendLine, sizeof(trendLine), "24h: %.1f-%.1fF", day.min / 10.0f, day.max / 10.0f);
     }
-    else if (command == "local")
+  }
+
+  displayMessage(tempLine, statusLine, weatherLabel(weather.weatherCode), trendLine);
+  return 0;
+}
+
+unsigned long handleSerialCommands()
+{
+  // Take whatever bytes have arrived; a partial line just waits in the buffer
+  CAPTURE_STREAM(input, Serial, TRACE_SERIAL);
+  commandParser.poll(input);
+  return 0;
+}
+
+void commandWeather(const char *)
+{
+  const WeatherData &weather = getWeather();
+
+  Serial.println("Manual weather update requested");
+  refreshWeather();
+  scheduler.runAfter(weatherJob, 0);
+
+  // Display weather info; a real fetch finishes in the background
+  Serial.println("\n=== Weather Conditions ===");
+  Serial.print("Data Source: ");
+  Serial.println(!weather.isRealData ? "Simulated" : weather.isForecast ? "Forecast (cached)" : "Real (API)");
+  Serial.print("Age: ");
+  Serial.print(getWeatherAge() / 1000);
+  Serial.println(isWeatherFetchInProgress() ? " s (refresh in progress)" : " s");
+  Serial.print("Temperature: ");
+  Serial.print(weather.temperatureF);
+  Serial.println(" °F");
+  Serial.print("Wind Speed: ");
+  Serial.print(weather.windSpeedMPH);
+  Serial.println(" MPH");
+  Serial.print("Weather: ");
+  Serial.println(weatherLabel(weather.weatherCode));
+  Serial.print("Precipitation: ");
+  Serial.print(weather.precipitationAmount);
+  Serial.println(weather.isRealData ? " mm" : " in");
+  Serial.print("Precipitation Chance: ");
+  Serial.print(weather.precipitationChance);
+  Serial.println("%");
+  const WeatherForecast &forecast = getForecast();
+  uint32_t now = weatherClock();
+  if (forecast.hours > 0 && now >= forecast.fetchedAt)
+  {
+    const AdaptiveRate &refresh = getForecastRefresh();
+    Serial.printf("Forecast: %u hours cached, fetched %lu min ago, refetched every %lu min\n", forecast.hours,
+                  (unsigned long)(now - forecast.fetchedAt) / 60, refresh.interval() / 60000);
+  }
+  const WeatherFetchTiming &timing = getWeatherFetchTiming();
+  if (timing.httpCode == WEATHER_ERROR_DNS_FAILED)
+  {
+    Serial.println("Last fetch: DNS lookup failed");
+  }
+  else if (timing.httpCode != 0)
+  {
+    Serial.printf("Last fetch: HTTP %d, DNS %u ms, connect + TLS %u ms, first byte %u ms, body %u ms\n",
+                  timing.httpCode, timing.dnsMs, timing.connectMs, timing.firstByteMs, timing.bodyMs);
+  }
+  Serial.println("==========================\n");
+}
+
+void commandLocal(const char *)
+{
+  // The read takes a few tens of ms; the sensor job logs it and refreshes
+  // the display when it is in
+  scheduler.runAfter(sensorJob, 0);
+
+  // Display local sensor readings
+  Serial.println("\n=== Local Sensor Readings ===");
+  Serial.print("Temperature: ");
+  Serial.print(localSensor.getTemperature());
+  Serial.println(" °F");
+  Serial.print("Humidity: ");
+  Serial.print(localSensor.getHumidity());
+  Serial.println(" %");
+  const AdaptiveRate &rate = localSensor.getReadRate();
+  Serial.printf("Reading every %lu s (%lu-%lu s), sped up %lu times, backed off %lu\n", rate.interval() / 1000,
+                rate.getMin() / 1000, rate.getMax() / 1000, (unsigned long)rate.getHurries(),
+                (unsigned long)rate.getRelaxes());
+  Serial.println("============================\n");
+}
+
+void commandWindow(const char *args)
+{
+  if (args[0] == '\0')
+  {
+    const ServoMotionStats &motion = windowController.getMotionStats();
+    Serial.println("\n=== Window ===");
+    Serial.printf("Position: %d, target %d%s\n", windowController.getServoPosition(),
+                  windowController.getCurrentPosition(), windowController.isTesting() ? " (test sweep)" : "");
+    Serial.printf("Moves: %lu, %lu degrees, %.1f s moving\n", (unsigned long)motion.moves,
+                  (unsigned long)motion.degrees, motion.movingMs / 1000.0);
+    Serial.printf("PWM on for %.1f s, released %lu times\n", motion.attachedMs / 1000.0,
+                  (unsigned long)motion.detaches);
+    Serial.println("==============\n");
+    return;
+  }
+  if (strcmp(args, "test") == 0)
+  {
+    windowController.performInitialTest();
+    return;
+  }
+
+  long pos;
+  if (!parseIntArg(args, 0, 180, pos))
+  {
+    Serial.println("Usage: window [0-180|test]");
+    return;
+  }
+
+  // Manual window control
+  Serial.print("Manual window position: ");
+  Serial.println(pos);
+  windowController.setPosition(pos);
+  scheduler.runAfter(displayJob, 0);
+}
+
+void commandPolicy(const char *args)
+{
+  if (args[0] != '\0')
+  {
+    WindowPolicy *policy = findWindowPolicy(args);
+    if (!policy)
     {
-      // Force update of local sensor readings
-      localSensor.update(true);
-
-      // Display local sensor readings
-      Serial.println("\n=== Local Sensor Readings ===");
-      Serial.print("Temperature: ");
-      Serial.print(localSensor.getTemperature());
-      Serial.println(" °F");
-      Serial.print("Humidity: ");
-      Serial.print(localSensor.getHumidity());
-      Serial.println(" %");
-      Serial.println("============================\n");
+      Serial.printf("No policy \"%s\"\n", args);
+      return;
     }
-    else if (command.startsWith("window "))
+    windowController.setPolicy(policy);
+    scheduler.runAfter(windowJob, 0);
+  }
+
+  ActuationBudget &budget = windowController.getBudget();
+  const ActuationLimits &limits = budget.getLimits();
+  Serial.print("Policies:");
+  for (size_t i = 0; i < windowPolicyCount(); i++)
+  {
+    WindowPolicy *policy = windowPolicy(i);
+    Serial.printf(policy == windowController.getPolicy() ? " [%s]" : " %s", policy->name());
+  }
+  Serial.println();
+  Serial.printf("Budget: %lu min between moves, %u moves per hour, steps of %d degrees or more; %lu moves "
+                "held back\n",
+                limits.minDwellMs / 60000, limits.maxMovesPerHour, limits.minStepDeg,
+                (unsigned long)budget.getDenied());
+}
+
+void commandPower(const char *)
+{
+  // Wake counts and where the time went since boot
+  const PowerStats &power = getPowerStats();
+  uint64_t totalMs = 0;
+  for (int state = 0; state < POWER_STATE_COUNT; state++)
+  {
+    totalMs += power.stateMs[state];
+  }
+
+  Serial.println("\n=== Power ===");
+  Serial.printf("Wakeups: %lu (timer %lu, event %lu), %lu in light sleep\n", power.wakeups,
+                power.timerWakes, power.eventWakes, power.lightSleeps);
+  Serial.printf("Wakeups per hour: %.1f\n", totalMs ? power.wakeups * 3600000.0 / totalMs : 0.0);
+  for (int state = 0; state < POWER_STATE_COUNT; state++)
+  {
+    Serial.printf("%-17s %6.2f%%  (%.2f mA)\n", powerStateLabel((PowerState)state),
+                  totalMs ? 100.0 * power.stateMs[state] / totalMs : 0.0,
+                  powerStateCurrentMa((PowerState)state));
+  }
+  Serial.printf("Estimated average current: %.2f mA\n", estimateAverageCurrentMa());
+  Serial.println("=============\n");
+}
+
+void commandNetwork(const char *)
+{
+  const NetworkStats &network = getNetworkStats();
+
+  Serial.println("\n=== Network ===");
+  Serial.print("State: ");
+  Serial.println(networkStateLabel(network.state));
+  Serial.print("IP address: ");
+  Serial.println(WiFi.localIP());
+  Serial.printf("Attempts: %lu, connects: %lu (%lu from cache), failures: %lu, drops: %lu\n", network.attempts,
+                network.connects, network.fastConnects, network.failures, network.drops);
+  Serial.printf("First link up %lu ms after boot, last association took %lu ms\n", network.bootConnectMs,
+                network.lastAssociateMs);
+  if (network.state == NETWORK_BACKOFF)
+  {
+    Serial.printf("Next attempt within %lu s\n", network.backoffMs / 1000);
+  }
+  Serial.println("===============\n");
+}
+
+void commandBoot(const char *)
+{
+  printBootTimeline(Serial);
+}
+
+// A history value in tenths, or dashes when a bucket has none
+void printTenths(int16_t value, uint16_t count)
+{
+  if (count == 0 || value == HISTORY_MISSING)
+  {
+    Serial.print("     --");
+    return;
+  }
+  Serial.printf("%7.1f", value / 10.0f);
+}
+
+void commandHistory(const char *args)
+{
+  long hours = 2;
+  if (args[0] != '\0' && !parseIntArg(args, 1, HISTORY_HOURS, hours))
+  {
+    Serial.printf("Usage: history [1-%d]\n", HISTORY_HOURS);
+    return;
+  }
+  uint32_t now = weatherClock();
+  if (now == 0)
+  {
+    Serial.println("History starts once the clock is set");
+    return;
+  }
+
+  // Ten minute rows from the minute rollups for short spans, whole hours
+  // beyond that, at most a day's worth of rows either way
+  const uint32_t MAX_ROWS = 24;
+  uint32_t step = hours <= 2 ? 600 : 3600 * ((hours + 23) / 24);
+  uint32_t rows = min((uint32_t)(hours * 3600 + step - 1) / step, MAX_ROWS);
+  uint32_t to = now - now % step + step;
+  uint32_t from = to - rows * step;
+
+  HistoryPoint points[HISTORY_CHANNELS][MAX_ROWS];
+  for (int channel = 0; channel < HISTORY_CHANNELS; channel++)
+  {
+    historyQuery((HistoryChannel)channel, from, to, step, points[channel], rows);
+  }
+
+  Serial.printf("\n=== History, last %ld h (UTC) ===\n", hours);
+  Serial.println("Time          In F    min    max   RH %  Out F Window");
+  for (uint32_t row = 0; row < rows; row++)
+  {
+    const HistoryPoint &indoor = points[HISTORY_INDOOR_TEMP][row];
+    time_t start = indoor.time;
+    struct tm utc;
+    gmtime_r(&start, &utc);
+    Serial.printf("%02d-%02d %02d:%02d", utc.tm_mon + 1, utc.tm_mday, utc.tm_hour, utc.tm_min);
+    printTenths(indoor.avg, indoor.count);
+    printTenths(indoor.min, indoor.count);
+    printTenths(indoor.max, indoor.count);
+    for (int channel = HISTORY_HUMIDITY; channel < HISTORY_CHANNELS; channel++)
     {
-      // Manual window control
-      int pos = command.substring(7).toInt();
-      Serial.print("Manual window position: ");
-      Serial.println(pos);
-      windowController.setPosition(pos);
+      printTenths(points[channel][row].avg, points[channel][row].count);
     }
+    Serial.println();
   }
 
-  delay(1000); // Small delay to prevent CPU hogging
+  const HistoryStats &history = getHistoryStats();
+  Serial.printf("Samples: %lu (%lu before the clock was set), flash: %lu blocks, %lu bytes in %u segments\n",
+                (unsigned long)history.samples, (unsigned long)history.skipped, (unsigned long)history.blocks,
+                (unsigned long)history.flashBytes, history.segmentsInUse);
+  Serial.println("====================================\n");
+}
+
+#if STATS_ENABLED
+void commandStats(const char *args)
+{
+  if (strcmp(args, "reset") == 0)
+  {
+    statsReset();
+    Serial.println("Stats cleared");
+    return;
+  }
+  printStats(Serial);
+  LogStats log = getLogStats();
+  Serial.printf("Log: %lu records, %lu dropped\n", (unsigned long)log.written, (unsigned long)log.dropped);
+  // I2C payload actually sent to the OLED, against 1024 bytes for a full frame
+  const DisplayFlushStats &display = getDisplayFlushStats();
+  Serial.printf("Display: %lu updates, %lu unchanged, %lu bytes/update mean, %lu last, %lu since boot\n",
+                display.frames, display.skipped, display.frames ? display.totalBytes / display.frames : 0UL,
+                display.lastBytes, display.totalBytes);
+}
+#endif
+
+void commandHelp(const char *)
+{
+  Serial.println("Commands:");
+  commandParser.printHelp(Serial);
 }
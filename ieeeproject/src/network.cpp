@@ -0,0 +1,291 @@
+// network.cpp
+#include "network.h"
+#include <WiFi.h>
+#include <Preferences.h>
+#include <cstring>
+#include "log.h"
+#include "weather.h"
+
+// WiFi credentials
+static const char *ssid = "Noah";
+static const char *password = "11111111";
+
+// A directed attempt (cached BSSID and channel, so no scan) joins in well
+// under a second; a full one scans every channel and waits for DHCP
+#define FAST_CONNECT_TIMEOUT_MS 3000
+#define FULL_CONNECT_TIMEOUT_MS 10000
+#define CONNECT_POLL_MS 100
+
+// The disconnect event normally reports a lost link; this catches a missed one
+#define LINK_CHECK_MS 60000
+
+// Between failed rounds, doubling up to the cap
+#define BACKOFF_MIN_MS 2000
+#define BACKOFF_MAX_MS 300000
+
+// Reusing the cached address skips DHCP, but the router never hears about it,
+// so every few fast connects take a fresh lease instead
+#define LEASE_REUSE_LIMIT 8
+
+#define CACHE_VERSION 1
+
+// Last good AP and lease. NVS rather than RTC memory, which does not survive
+// a power cycle.
+struct LinkCache
+{
+    uint8_t version;
+    uint8_t channel;
+    uint8_t bssid[6];
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+    uint8_t leaseReuses; // Fast connects on the cached address since the last DHCP
+};
+
+static Preferences prefs;
+static LinkCache cache = {};
+static bool cacheValid = false;
+static bool attemptFast = false;   // Current attempt is directed at the cached AP
+static bool attemptStatic = false; // ...and reuses the cached address
+static unsigned long attemptStart = 0;
+static unsigned long backoffStart = 0;
+static uint8_t failStreak = 0;
+static NetworkStats stats = {};
+static void (*linkLostCallback)() = nullptr;
+
+static const char *const STATE_LABELS[] = {"idle", "connecting", "connected", "backoff"};
+
+static void loadCache()
+{
+    cacheValid = false;
+    if (prefs.begin("wifi", true))
+    {
+        cacheValid = prefs.getBytes("link", &cache, sizeof(cache)) == sizeof(cache) &&
+                     cache.version == CACHE_VERSION && cache.channel > 0;
+        prefs.end();
+    }
+}
+
+// Record the AP and lease of the link that just came up, writing flash only
+// when something changed
+static void updateCache()
+{
+    const uint8_t *bssid = WiFi.BSSID();
+    if (!bssid)
+    {
+        return;
+    }
+
+    LinkCache fresh = {};
+    fresh.version = CACHE_VERSION;
+    fresh.channel = WiFi.channel();
+    memcpy(fresh.bssid, bssid, sizeof(fresh.bssid));
+    fresh.ip = WiFi.localIP();
+    fresh.gateway = WiFi.gatewayIP();
+    fresh.subnet = WiFi.subnetMask();
+    fresh.dns = WiFi.dnsIP();
+    fresh.leaseReuses = attemptStatic ? cache.leaseReuses + 1 : 0;
+
+    if (cacheValid && memcmp(&fresh, &cache, sizeof(fresh)) == 0)
+    {
+        return;
+    }
+    cache = fresh;
+    cacheValid = true;
+    if (prefs.begin("wifi", false))
+    {
+        prefs.putBytes("link", &cache, sizeof(cache));
+        prefs.end();
+    }
+}
+
+static void startAttempt(bool fast);
+
+static void handleDisconnect(arduino_event_id_t)
+{
+    if (linkLostCallback)
+    {
+        linkLostCallback();
+    }
+}
+
+void networkInit(void (*onLinkLost)())
+{
+    stats = {};
+    failStreak = 0;
+    linkLostCallback = onLinkLost;
+
+    // The state machine does the retrying, and the core should not rewrite
+    // the credentials to flash on every begin()
+    WiFi.mode(WIFI_STA);
+    WiFi.persistent(false);
+    WiFi.setAutoReconnect(false);
+    WiFi.onEvent(handleDisconnect, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+
+    loadCache();
+    if (cacheValid)
+    {
+        LOG(WIFI_CACHED_AP, cache.bssid[0], cache.bssid[1], cache.bssid[2], cache.bssid[3], cache.bssid[4],
+            cache.bssid[5], cache.channel);
+    }
+    startAttempt(true);
+}
+
+static void startAttempt(bool fast)
+{
+    attemptFast = fast && cacheValid;
+    attemptStatic = attemptFast && cache.leaseReuses < LEASE_REUSE_LIMIT;
+
+    WiFi.disconnect();
+    if (attemptStatic)
+    {
+        WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway), IPAddress(cache.subnet), IPAddress(cache.dns));
+    }
+    else
+    {
+        WiFi.config(IPAddress(), IPAddress(), IPAddress()); // Back to DHCP
+    }
+
+    if (attemptFast)
+    {
+        WiFi.begin(ssid, password, cache.channel, cache.bssid);
+    }
+    else
+    {
+        LOG(WIFI_CONNECTING, ssid);
+        WiFi.begin(ssid, password);
+    }
+
+    attemptStart = millis();
+    stats.attempts++;
+    stats.state = NETWORK_CONNECTING;
+}
+
+static void onConnected()
+{
+    unsigned long now = millis();
+    stats.lastAssociateMs = now - attemptStart;
+    stats.connects++;
+    if (attemptFast)
+    {
+        stats.fastConnects++;
+    }
+    if (stats.bootConnectMs == 0)
+    {
+        stats.bootConnectMs = now;
+    }
+    stats.state = NETWORK_CONNECTED;
+    stats.backoffMs = 0;
+    failStreak = 0;
+
+    LOG(WIFI_CONNECTED, stats.lastAssociateMs,
+        attemptStatic ? "cached AP and lease" : attemptFast ? "cached AP" : "full scan");
+    IPAddress ip = WiFi.localIP();
+    LOG(WIFI_ADDRESS, ip[0], ip[1], ip[2], ip[3]);
+    updateCache();
+
+    // SNTP keeps the system clock in step from here on, and the clock
+    // survives a soft reset, so the weather cache stays usable across one.
+    // configTime() would reset TZ to UTC under the fallback weather.
+    if (stats.connects == 1)
+    {
+        configTzTime(WEATHER_TIMEZONE, "pool.ntp.org", "time.nist.gov");
+    }
+}
+
+static unsigned long onAttemptFailed()
+{
+    stats.failures++;
+    WiFi.disconnect();
+
+    // The AP may have moved to another channel: scan for it straight away.
+    // The cache stays until a link proves it wrong, so a plain outage still
+    // reconnects the fast way.
+    if (attemptFast)
+    {
+        startAttempt(false);
+        return CONNECT_POLL_MS;
+    }
+
+    if (failStreak < 8)
+    {
+        failStreak++;
+    }
+    unsigned long backoff = (unsigned long)BACKOFF_MIN_MS << (failStreak - 1);
+    if (backoff > BACKOFF_MAX_MS)
+    {
+        backoff = BACKOFF_MAX_MS;
+    }
+    backoff += random(backoff / 4); // Keep devices that lost the same AP from retrying in step
+
+    stats.backoffMs = backoff;
+    stats.state = NETWORK_BACKOFF;
+    backoffStart = millis();
+    LOG(WIFI_FAILED, backoff / 1000);
+    return backoff;
+}
+
+unsigned long updateNetwork()
+{
+    wl_status_t status = WiFi.status();
+    switch (stats.state)
+    {
+    case NETWORK_IDLE:
+        startAttempt(true);
+        return CONNECT_POLL_MS;
+
+    case NETWORK_CONNECTING:
+    {
+        if (status == WL_CONNECTED)
+        {
+            onConnected();
+            return LINK_CHECK_MS;
+        }
+        bool refused = status == WL_NO_SSID_AVAIL || status == WL_CONNECT_FAILED;
+        unsigned long timeout = attemptFast ? FAST_CONNECT_TIMEOUT_MS : FULL_CONNECT_TIMEOUT_MS;
+        if (!refused && millis() - attemptStart < timeout)
+        {
+            return CONNECT_POLL_MS;
+        }
+        return onAttemptFailed();
+    }
+
+    case NETWORK_CONNECTED:
+        if (status == WL_CONNECTED)
+        {
+            return LINK_CHECK_MS;
+        }
+        stats.drops++;
+        LOG(WIFI_LOST);
+        startAttempt(true);
+        return CONNECT_POLL_MS;
+
+    case NETWORK_BACKOFF:
+    default:
+    {
+        unsigned long waited = millis() - backoffStart;
+        if (waited < stats.backoffMs)
+        {
+            return stats.backoffMs - waited;
+        }
+        startAttempt(true);
+        return CONNECT_POLL_MS;
+    }
+    }
+}
+
+bool isNetworkConnecting()
+{
+    return stats.state == NETWORK_CONNECTING;
+}
+
+const NetworkStats &getNetworkStats()
+{
+    return stats;
+}
+
+const char *networkStateLabel(NetworkState state)
+{
+    return state <= NETWORK_BACKOFF ? STATE_LABELS[state] : "?";
+}
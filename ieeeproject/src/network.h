@@ -0,0 +1,45 @@
+// network.h
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include <Arduino.h>
+
+enum NetworkState : uint8_t
+{
+    NETWORK_IDLE,       // Not started yet
+    NETWORK_CONNECTING, // Association in progress
+    NETWORK_CONNECTED,  // Link up
+    NETWORK_BACKOFF     // Waiting before the next attempt
+};
+
+// Connection history since networkInit()
+struct NetworkStats
+{
+    NetworkState state;
+    unsigned long attempts;        // WiFi.begin() calls
+    unsigned long connects;        // Attempts that got a link
+    unsigned long fastConnects;    // Of those, using the cached AP and lease
+    unsigned long failures;        // Attempts that timed out or were refused
+    unsigned long drops;           // Links lost after connecting
+    unsigned long bootConnectMs;   // millis() when the first link came up, 0 until then
+    unsigned long lastAssociateMs; // WiFi.begin() to link up, most recent connect
+    unsigned long backoffMs;       // Current wait between failed attempts
+};
+
+// Load the cached AP and lease and start the first attempt; onLinkLost is
+// called from the WiFi event task when the station drops off. Does not wait
+// for the association, which carries on in the WiFi task.
+void networkInit(void (*onLinkLost)());
+
+// Connection state machine: starts attempts, notices links coming up or going
+// away and backs off after failures. Never waits on the radio. Returns the
+// milliseconds until it needs to run again.
+unsigned long updateNetwork();
+
+// True while an attempt is in progress (radio busy scanning or associating)
+bool isNetworkConnecting();
+
+const NetworkStats &getNetworkStats();
+const char *networkStateLabel(NetworkState state);
+
+#endif
@@ -0,0 +1,207 @@
+// power.cpp
+#include "power.h"
+#include <WiFi.h>
+#include <climits>
+#include "network.h"
+#include "weather.h"
+#ifdef NATIVE_BUILD
+#include "NativeHal.h"
+#else
+#include <driver/uart.h>
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#endif
+
+// Shorter waits stay awake: getting in and out of light sleep takes about a
+// millisecond at a higher current than the sleep itself saves
+#define LIGHT_SLEEP_MIN_MS 20
+
+// After serial input, stay out of light sleep for a while. The UART wake
+// swallows the first byte, so this keeps the rest of a session responsive.
+#define EVENT_WAKE_HOLDOFF_MS 3000
+
+// Automatic light sleep (power management plus tickless idle in the IDF
+// config) keeps the WiFi association through light sleep, waking for beacons.
+// Without it, manual light sleep drops the association, so it is only used
+// while WiFi is down. The host models the automatic configuration.
+#if defined(NATIVE_BUILD) || (CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE)
+#define AUTO_LIGHT_SLEEP 1
+#else
+#define AUTO_LIGHT_SLEEP 0
+#endif
+
+// Typical ESP32-C3 supply currents at 3.3 V, good for comparing configurations
+// rather than standing in for a measurement
+static const float STATE_CURRENT_MA[POWER_STATE_COUNT] = {
+    24.0, // Active at 160 MHz
+    90.0, // Radio busy
+    16.0, // Modem sleep, DTIM 1
+    12.0, // Idle, radio off
+    1.6,  // Light sleep with DTIM 1 beacon wakeups
+    0.13, // Light sleep
+};
+
+static const char *const STATE_LABELS[POWER_STATE_COUNT] = {
+    "active", "radio", "modem sleep", "idle", "light sleep+WiFi", "light sleep"};
+
+static PowerStats stats = {};
+static unsigned long awakeSince = 0; // End of the last sleep
+static unsigned long lastEventWake = 0;
+static bool hadEventWake = false;
+
+#if !defined(NATIVE_BUILD) && AUTO_LIGHT_SLEEP
+static esp_pm_lock_handle_t noLightSleep = nullptr;
+#endif
+
+void powerInit()
+{
+    // Radio sleeps between beacons whenever associated
+    WiFi.setSleep(true);
+
+#ifndef NATIVE_BUILD
+#if AUTO_LIGHT_SLEEP
+    esp_pm_config_esp32c3_t pm = {};
+    pm.max_freq_mhz = 160;
+    pm.min_freq_mhz = 40;
+    pm.light_sleep_enable = true;
+    esp_pm_configure(&pm);
+    esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "powerSleep", &noLightSleep);
+#endif
+    // A few edges on RX wake the chip; the bytes themselves are lost
+    uart_set_wakeup_threshold(UART_NUM_0, 3);
+    esp_sleep_enable_uart_wakeup(UART_NUM_0);
+#endif
+
+    awakeSince = millis();
+}
+
+static bool canLightSleep(unsigned long ms, bool associated)
+{
+    if (ms < LIGHT_SLEEP_MIN_MS)
+    {
+        return false;
+    }
+    if (hadEventWake && millis() - lastEventWake < EVENT_WAKE_HOLDOFF_MS)
+    {
+        return false;
+    }
+#if AUTO_LIGHT_SLEEP
+    (void)associated; // Automatic light sleep keeps the association
+#else
+    if (associated)
+    {
+        return false;
+    }
+#endif
+#if !defined(NATIVE_BUILD) && ARDUINO_USB_CDC_ON_BOOT && ARDUINO_USB_MODE
+    // The USB Serial/JTAG port drops off the bus in light sleep
+    if (Serial)
+    {
+        return false;
+    }
+#endif
+    return true;
+}
+
+// Block in the chosen state; true when something other than the timer woke us
+static bool sleepIn(PowerState state, unsigned long ms)
+{
+#ifdef NATIVE_BUILD
+    (void)state;
+    return hal::sleepUntilInputOr(ms == ULONG_MAX ? ULONG_MAX : millis() + ms);
+#else
+    bool light = state == POWER_LIGHT_SLEEP || state == POWER_LIGHT_SLEEP_WIFI;
+#if AUTO_LIGHT_SLEEP
+    // The idle task light-sleeps by itself while we block; hold it off when
+    // the state calls for staying awake
+    if (!light)
+    {
+        esp_pm_lock_acquire(noLightSleep);
+    }
+    bool notified = ulTaskNotifyTake(pdTRUE, ms == ULONG_MAX ? portMAX_DELAY : pdMS_TO_TICKS(ms)) != 0;
+    if (!light)
+    {
+        esp_pm_lock_release(noLightSleep);
+    }
+    return notified;
+#else
+    if (!light)
+    {
+        return ulTaskNotifyTake(pdTRUE, ms == ULONG_MAX ? portMAX_DELAY : pdMS_TO_TICKS(ms)) != 0;
+    }
+    Serial.flush(); // TX has to drain before the UART clock stops
+    esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000);
+    esp_light_sleep_start();
+    return esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_TIMER;
+#endif
+#endif
+}
+
+void powerSleep(unsigned long ms)
+{
+    bool associated = WiFi.status() == WL_CONNECTED;
+    PowerState state;
+    if (isWeatherFetchInProgress() || isNetworkConnecting())
+    {
+        state = POWER_RADIO;
+    }
+    else if (canLightSleep(ms, associated))
+    {
+        state = associated ? POWER_LIGHT_SLEEP_WIFI : POWER_LIGHT_SLEEP;
+    }
+    else
+    {
+        state = associated ? POWER_MODEM_SLEEP : POWER_IDLE;
+    }
+
+    unsigned long start = millis();
+    stats.stateMs[POWER_ACTIVE] += start - awakeSince;
+    bool event = sleepIn(state, ms);
+    awakeSince = millis();
+    stats.stateMs[state] += awakeSince - start;
+    stats.wakeups++;
+    if (state == POWER_LIGHT_SLEEP || state == POWER_LIGHT_SLEEP_WIFI)
+    {
+        stats.lightSleeps++;
+    }
+    if (event)
+    {
+        stats.eventWakes++;
+        lastEventWake = awakeSince;
+        hadEventWake = true;
+    }
+    else
+    {
+        stats.timerWakes++;
+    }
+}
+
+const PowerStats &getPowerStats()
+{
+    stats.stateMs[POWER_ACTIVE] += millis() - awakeSince;
+    awakeSince = millis();
+    return stats;
+}
+
+const char *powerStateLabel(PowerState state)
+{
+    return state < POWER_STATE_COUNT ? STATE_LABELS[state] : "?";
+}
+
+float powerStateCurrentMa(PowerState state)
+{
+    return state < POWER_STATE_COUNT ? STATE_CURRENT_MA[state] : 0;
+}
+
+float estimateAverageCurrentMa()
+{
+    const PowerStats &current = getPowerStats();
+    uint64_t totalMs = 0;
+    float chargeMaMs = 0;
+    for (int state = 0; state < POWER_STATE_COUNT; state++)
+    {
+        totalMs += current.stateMs[state];
+        chargeMaMs += current.stateMs[state] * STATE_CURRENT_MA[state];
+    }
+    return totalMs ? chargeMaMs / totalMs : 0;
+}
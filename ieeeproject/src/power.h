@@ -0,0 +1,47 @@
+// power.h
+#ifndef POWER_H
+#define POWER_H
+
+#include <Arduino.h>
+
+// Where the time goes between wakeups. Sleep states split by whether WiFi is
+// associated, since keeping the association costs beacon wakeups.
+enum PowerState : uint8_t
+{
+    POWER_ACTIVE,             // CPU running jobs
+    POWER_RADIO,              // Waiting on a weather fetch or WiFi connect, radio busy
+    POWER_MODEM_SLEEP,        // Blocked, WiFi associated in modem sleep
+    POWER_IDLE,               // Blocked, radio off
+    POWER_LIGHT_SLEEP_WIFI,   // Light sleep, waking for DTIM beacons
+    POWER_LIGHT_SLEEP,        // Light sleep, radio off
+    POWER_STATE_COUNT
+};
+
+// Wake counts and time per state since powerInit()
+struct PowerStats
+{
+    unsigned long wakeups;     // Sleeps that ended
+    unsigned long timerWakes;  // Ended at the scheduled deadline
+    unsigned long eventWakes;  // Ended early by serial input or another task
+    unsigned long lightSleeps; // Sleeps spent in light sleep
+    uint64_t stateMs[POWER_STATE_COUNT];
+};
+
+// Put the radio in modem sleep and set up light sleep and its wake sources
+void powerInit();
+
+// Sleep for up to ms in the lowest state that keeps the radio's promises;
+// returns early on serial input or a scheduler trigger
+void powerSleep(unsigned long ms);
+
+// Counters, with the active time brought up to date
+const PowerStats &getPowerStats();
+
+// Display name and typical supply current of a state, in mA
+const char *powerStateLabel(PowerState state);
+float powerStateCurrentMa(PowerState state);
+
+// Average supply current since powerInit(), estimated from the time per state
+float estimateAverageCurrentMa();
+
+#endif
@@ -0,0 +1,140 @@
+// stats.cpp
+#include "stats.h"
+
+#if STATS_ENABLED
+
+// Each probe has one writer (the fetch probe lives on the weather task, the
+// rest on the loop task), so recording takes no lock. A dump can catch a
+// histogram mid-update; it is for reading, not for decisions.
+static StatsHistogram histograms[PROBE_COUNT];
+static uint32_t counters[COUNTER_COUNT];
+static uint32_t cpuMHz = 0;
+static unsigned long sinceMs = 0;
+
+static const char *const PROBE_LABELS[] = {"loop pass", "wake lateness", "DHT read", "weather fetch",
+                                           "display push", "window move"};
+
+void statsRecord(StatsProbe probe, uint32_t us)
+{
+    StatsHistogram &h = histograms[probe];
+    uint8_t bucket = us ? 32 - __builtin_clz(us) : 0;
+    if (bucket >= STATS_BUCKETS)
+    {
+        bucket = STATS_BUCKETS - 1;
+    }
+    h.buckets[bucket]++;
+    h.count++;
+    h.totalUs += us;
+    if (us > h.maxUs)
+    {
+        h.maxUs = us;
+    }
+}
+
+void statsRecordCycles(StatsProbe probe, uint32_t cycles)
+{
+    // Cycle probes only cover code that keeps the CPU busy, so at full speed
+    if (cpuMHz == 0)
+    {
+        cpuMHz = ESP.getCpuFreqMHz();
+    }
+    statsRecord(probe, cycles / cpuMHz);
+}
+
+void statsCount(StatsCounter counter)
+{
+    counters[counter]++;
+}
+
+void statsReset()
+{
+    memset(histograms, 0, sizeof(histograms));
+    memset(counters, 0, sizeof(counters));
+    sinceMs = millis();
+}
+
+const StatsHistogram &getStatsHistogram(StatsProbe probe)
+{
+    return histograms[probe];
+}
+
+uint32_t getStatsCounter(StatsCounter counter)
+{
+    return counters[counter];
+}
+
+const char *statsProbeLabel(StatsProbe probe)
+{
+    return probe < PROBE_COUNT ? PROBE_LABELS[probe] : "?";
+}
+
+// Upper bound of the bucket holding the given fraction of the samples
+static uint32_t percentileUs(const StatsHistogram &h, uint32_t permille)
+{
+    uint64_t target = ((uint64_t)h.count * permille + 999) / 1000;
+    uint64_t seen = 0;
+    for (uint8_t bucket = 0; bucket < STATS_BUCKETS - 1; bucket++)
+    {
+        seen += h.buckets[bucket];
+        if (seen >= target)
+        {
+            return 1UL << bucket;
+        }
+    }
+    return h.maxUs;
+}
+
+void printStats(Print &out)
+{
+    out.printf("\n=== Stats (last %lu s) ===\n", (millis() - sinceMs) / 1000);
+    out.printf("%-14s %8s %9s %9s %9s %9s\n", "probe", "count", "mean us", "p50 <us", "p99 <us", "max us");
+    for (uint8_t probe = 0; probe < PROBE_COUNT; probe++)
+    {
+        const StatsHistogram &h = histograms[probe];
+        out.printf("%-14s %8lu %9lu %9lu %9lu %9lu\n", PROBE_LABELS[probe], (unsigned long)h.count,
+                   h.count ? (unsigned long)(h.totalUs / h.count) : 0UL,
+                   h.count ? (unsigned long)percentileUs(h, 500) : 0UL,
+                   h.count ? (unsigned long)percentileUs(h, 990) : 0UL, (unsigned long)h.maxUs);
+    }
+
+    // Non-empty buckets by upper bound: "<1024:12" is 12 samples in [512, 1024) us
+    out.println("Histograms (<upper bound us:count):");
+    for (uint8_t probe = 0; probe < PROBE_COUNT; probe++)
+    {
+        const StatsHistogram &h = histograms[probe];
+        if (h.count == 0)
+        {
+            continue;
+        }
+        out.printf("  %-14s", PROBE_LABELS[probe]);
+        for (uint8_t bucket = 0; bucket < STATS_BUCKETS; bucket++)
+        {
+            if (h.buckets[bucket] == 0)
+            {
+                continue;
+            }
+            if (bucket == STATS_BUCKETS - 1)
+            {
+                out.printf(" >=%lu:%lu", 1UL << (bucket - 1), (unsigned long)h.buckets[bucket]);
+            }
+            else
+            {
+                out.printf(" <%lu:%lu", 1UL << bucket, (unsigned long)h.buckets[bucket]);
+            }
+        }
+        out.println();
+    }
+
+    uint32_t dhtReads = histograms[PROBE_SENSOR].count;
+    uint32_t fetches = histograms[PROBE_WEATHER_FETCH].count;
+    out.printf("Max loop stall: %lu us\n", (unsigned long)histograms[PROBE_LOOP].maxUs);
+    out.printf("DHT failures: %lu of %lu reads (%.1f%%)\n", (unsigned long)counters[COUNT_DHT_FAILURES],
+               (unsigned long)dhtReads, dhtReads ? 100.0 * counters[COUNT_DHT_FAILURES] / dhtReads : 0.0);
+    out.printf("Weather fetch failures: %lu of %lu\n", (unsigned long)counters[COUNT_FETCH_FAILURES],
+               (unsigned long)fetches);
+    out.printf("Heap: %lu bytes free, low-water %lu bytes\n", (unsigned long)ESP.getFreeHeap(),
+               (unsigned long)ESP.getMinFreeHeap());
+    out.println("=========================\n");
+}
+
+#endif // STATS_ENABLED
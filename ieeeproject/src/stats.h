@@ -0,0 +1,100 @@
+// stats.h
+#ifndef STATS_H
+#define STATS_H
+
+#include <Arduino.h>
+
+// Build with -DSTATS_ENABLED=0 to compile every probe, the counters and the
+// stats command out
+#ifndef STATS_ENABLED
+#define STATS_ENABLED 1
+#endif
+
+// Timed code paths
+enum StatsProbe : uint8_t
+{
+    PROBE_LOOP,          // One scheduler pass: every job that was due
+    PROBE_WAKE_LATENESS, // How far past its deadline a timed sleep woke
+    PROBE_SENSOR,        // DHT read, start signal to reply collected
+    PROBE_WEATHER_FETCH, // fetchRealWeatherData(), on the weather task
+    PROBE_DISPLAY,       // Pushing a frame to the panel
+    PROBE_WINDOW,        // WindowController::setPosition()
+    PROBE_COUNT
+};
+
+// Plain event counts
+enum StatsCounter : uint8_t
+{
+    COUNT_DHT_FAILURES,
+    COUNT_FETCH_FAILURES,
+    COUNTER_COUNT
+};
+
+// Bucket 0 holds 0 us, bucket n holds [2^(n-1), 2^n) us and the last one
+// everything from 2^(STATS_BUCKETS-2) us up, about 4 s
+#define STATS_BUCKETS 24
+
+struct StatsHistogram
+{
+    uint32_t count;
+    uint32_t maxUs;
+    uint64_t totalUs;
+    uint32_t buckets[STATS_BUCKETS];
+};
+
+#if STATS_ENABLED
+
+void statsRecord(StatsProbe probe, uint32_t us);
+void statsRecordCycles(StatsProbe probe, uint32_t cycles);
+void statsCount(StatsCounter counter);
+void statsReset();
+
+const StatsHistogram &getStatsHistogram(StatsProbe probe);
+uint32_t getStatsCounter(StatsCounter counter);
+const char *statsProbeLabel(StatsProbe probe);
+
+// Summary per probe, the histograms and the counters
+void printStats(Print &out);
+
+// Times a scope in microseconds of wall time. Anything that may wait (a
+// delay(), an I2C transfer, a socket) needs this one.
+class StatsTimeScope
+{
+private:
+    StatsProbe probe;
+    unsigned long start;
+
+public:
+    explicit StatsTimeScope(StatsProbe probe) : probe(probe), start(micros()) {}
+    ~StatsTimeScope() { statsRecord(probe, micros() - start); }
+};
+
+// Times a scope with the cycle counter, a single register read. Only for code
+// that never waits: with power management the CPU drops to 40 MHz while idle,
+// and the counter with it.
+class StatsCycleScope
+{
+private:
+    StatsProbe probe;
+    uint32_t start;
+
+public:
+    explicit StatsCycleScope(StatsProbe probe) : probe(probe), start(ESP.getCycleCount()) {}
+    ~StatsCycleScope() { statsRecordCycles(probe, ESP.getCycleCount() - start); }
+};
+
+#define STATS_PROBE(probe) StatsTimeScope statsProbeScope(probe)
+#define STATS_PROBE_CYCLES(probe) StatsCycleScope statsProbeScope(probe)
+#define STATS_RECORD(probe, us) statsRecord(probe, us)
+#define STATS_COUNT(counter) statsCount(counter)
+
+#else
+
+#define STATS_PROBE(probe) ((void)0)
+#define STATS_PROBE_CYCLES(probe) ((void)0)
+#define STATS_RECORD(probe, us) ((void)0)
+#define STATS_COUNT(counter) ((void)0)
+
+#endif // STATS_ENABLED
+
+#endif
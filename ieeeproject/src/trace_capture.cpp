@@ -0,0 +1,96 @@
+// trace_capture.cpp
+#include "trace_capture.h"
+
+#if TRACE_CAPTURE
+
+void traceCaptureDht(unsigned long startedAt, const DhtReading &reading)
+{
+    LogPayload payload;
+    payload.size = 0;
+    logPack(payload, (uint32_t)startedAt);
+    logPack(payload, reading.status);
+    for (uint8_t byte : reading.bytes)
+    {
+        logPack(payload, byte);
+    }
+    logSubmitWaiting(LOG_TRACE_DHT, payload);
+}
+
+void traceCaptureHttp(int code, unsigned long startedAt, uint32_t clock)
+{
+    LogPayload payload;
+    payload.size = 0;
+    logPack(payload, code);
+    logPack(payload, (uint32_t)startedAt);
+    logPack(payload, clock);
+    logSubmitWaiting(LOG_TRACE_HTTP, payload);
+}
+
+void traceCaptureRest(int angle)
+{
+    LogPayload payload;
+    payload.size = 0;
+    logPack(payload, angle);
+    logSubmitWaiting(LOG_TRACE_REST, payload);
+}
+
+TraceCaptureStream::TraceCaptureStream(Stream &source, LogId id) : source(source), id(id)
+{
+    setTimeout(source.getTimeout());
+}
+
+TraceCaptureStream::~TraceCaptureStream()
+{
+    flushChunk();
+}
+
+void TraceCaptureStream::keep(int c)
+{
+    if (c < 0)
+    {
+        return;
+    }
+    chunk[length++] = (char)c;
+    if (length == sizeof(chunk) - 1)
+    {
+        flushChunk();
+    }
+}
+
+void TraceCaptureStream::flushChunk()
+{
+    if (length == 0)
+    {
+        return;
+    }
+    chunk[length] = '\0';
+    length = 0;
+    LogPayload payload;
+    payload.size = 0;
+    logPack(payload, (const char *)chunk);
+    logSubmitWaiting(id, payload);
+}
+
+int TraceCaptureStream::available()
+{
+    return source.available();
+}
+
+int TraceCaptureStream::read()
+{
+    int c = source.read();
+    keep(c);
+    return c;
+}
+
+int TraceCaptureStream::peek()
+{
+    return source.peek();
+}
+
+size_t TraceCaptureStream::write(uint8_t c)
+{
+    return source.write(c);
+}
+
+#endif // TRACE_CAPTURE
@@ -0,0 +1,64 @@
+// trace_capture.h
+#ifndef TRACE_CAPTURE_H
+#define TRACE_CAPTURE_H
+
+#include <Arduino.h>
+#include "DhtReader.h"
+#include "log.h"
+
+// Build with -DTRACE_CAPTURE=1 (and -DLOG_BINARY=1) to log what the device
+// gets from outside as TRACE_* records: each DHT reply, each weather
+// response with its body, serial input, and where the servo came to rest
+// after each move. tools/trace_from_log.py turns a capture of that build
+// into a trace the host runner replays with --replay, so a day on the
+// real device can be run again against changed firmware.
+#ifndef TRACE_CAPTURE
+#define TRACE_CAPTURE 0
+#endif
+
+#if TRACE_CAPTURE
+
+// The records wait for room in the log ring rather than drop: a trace with
+// a hole in a response body is no use
+void traceCaptureDht(unsigned long startedAt, const DhtReading &reading);
+void traceCaptureHttp(int code, unsigned long startedAt, uint32_t clock);
+void traceCaptureRest(int angle);
+
+// Reads through to another stream and logs every byte read from it as
+// records of the given ID, a string of up to LOG_PAYLOAD_BYTES - 1 bytes
+// each; what is left goes out when it is destroyed
+class TraceCaptureStream : public Stream
+{
+private:
+    Stream &source;
+    LogId id;
+    char chunk[LOG_PAYLOAD_BYTES];
+    uint8_t length = 0;
+    void keep(int c);
+    void flushChunk();
+
+public:
+    TraceCaptureStream(Stream &source, LogId id);
+    ~TraceCaptureStream();
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t c) override;
+};
+
+#define CAPTURE_DHT(startedAt, reading) traceCaptureDht(startedAt, reading)
+#define CAPTURE_HTTP(code, startedAt, clock) traceCaptureHttp(code, startedAt, clock)
+#define CAPTURE_REST(angle) traceCaptureRest(angle)
+#define CAPTURE_STREAM(name, source, message) TraceCaptureStream name(source, LOG_##message)
+
+#else
+
+#define CAPTURE_DHT(startedAt, reading) ((void)0)
+#define CAPTURE_HTTP(code, startedAt, clock) ((void)0)
+#define CAPTURE_REST(angle) ((void)0)
+#define CAPTURE_STREAM(name, source, message) Stream &name = source
+
+#endif // TRACE_CAPTURE
+
+#endif
@@ -1,294 +1,705 @@
 #include "weather.h"
+#include "stats.h"
+#include "log.h"
+#include "trace_capture.h"
 #include <WiFi.h>
 #include <HTTPClient.h>
+#include <WiFiClientSecure.h>
 #include <ArduinoJson.h>
-
-// WiFi credentials
-const char *ssid = "Noah";
-const char *password = "11111111";
-
-// Open-Meteo API configuration
-const String latitude = "40.699155";   // Latitude for AEC
-const String longitude = "-75.210961"; // Longitude for AEC
-const String weatherUrl = "https://api.open-meteo.com/v1/forecast?latitude=" +
-                          latitude + "&longitude=" + longitude +
-                          "&current=temperature_2m,relative_humidity_2m," +
-                          "precipitation,wind_speed_10m,weather_code" +
+#include <Preferences.h>
+#include <atomic>
+#include <climits>
+#include <ctime>
+#include <WeatherSim.h>
+
+#ifdef NATIVE_BUILD
+#include "NativeHal.h"
+#else
+#include <sys/time.h>
+#endif
+
+// Open-Meteo API configuration. The request line is a single literal in
+// flash, so a fetch builds nothing on the heap to send it.
+#define WEATHER_HOST "api.open-meteo.com"
+#define WEATHER_LATITUDE "40.699155"   // Latitude for AEC
+#define WEATHER_LONGITUDE "-75.210961" // Longitude for AEC
+const char weatherUrl[] = "https://" WEATHER_HOST "/v1/forecast?latitude=" WEATHER_LATITUDE
+                          "&longitude=" WEATHER_LONGITUDE
+                          "&current=temperature_2m,relative_humidity_2m,"
+                          "precipitation,wind_speed_10m,weather_code"
+                          "&hourly=temperature_2m,precipitation_probability,"
+                          "precipitation,wind_speed_10m,weather_code"
+                          "&forecast_hours=24&timeformat=unixtime"
                           "&temperature_unit=fahrenheit&wind_speed_unit=mph";
 
+// TLS client for the fetch task. Every fetch opens a fresh connection with a
+// full handshake: the core keeps no session to resume, and fetches are too
+// far apart for the server to hold an idle connection.
+WiFiClientSecure weatherClient;
+
 // Timing variables
 unsigned long lastFetchTime = 0;
 unsigned long lastFakeDataChange = 0;
-const unsigned long fetchInterval = 5 * 60 * 1000; // 5 minutes
-const unsigned long fakeDataInterval = 5 * 1000;   // 5 seconds
-
-// Current weather data
-WeatherData currentWeather;
-
-// Fake weather options for rotation
-const int NUM_FAKE_WEATHER_TYPES = 4;
-const String fakeWeatherTypes[NUM_FAKE_WEATHER_TYPES] = {
-    "Sunny", "Cloudy", "Rainy", "Snowy"};
-int currentFakeWeatherIndex = 0;
+const uint8_t RAIN_LOOKAHEAD_HOURS = 6;              // Rain due this soon tightens the refresh...
+const uint8_t RAIN_CHANCE_PERCENT = 50;              // ...at this chance or more
+const int16_t FORECAST_DRIFT_DECI = 20;              // A refetch that moved an hour by 2 F counts as unsettled
+const uint32_t forecastStepSeconds = 15 * 60;        // Re-read the forecast at this granularity
+const unsigned long fetchRetryInterval = 5 * 60 * 1000; // Between fetch attempts that failed
+const unsigned long fakeDataInterval = 60 * 1000;       // Fallback weather moves slowly
+const unsigned long fetchPollInterval = 250;            // While a fetch is in flight
+
+// Anything earlier means the system clock was never set
+const uint32_t CLOCK_VALID_AFTER = 1700000000;
+
+// JSON storage for the fetch task. Filtered parsing keeps the document small:
+// the current values plus the six hourly arrays, all numbers. Both live in
+// static memory, so a fetch needs no heap for JSON at all.
+//
+// The filter is one slot per key it keeps: current and its five fields,
+// hourly and its six arrays. Its keys are literals, held by pointer.
+const size_t WEATHER_FILTER_SIZE = JSON_OBJECT_SIZE(2) + JSON_OBJECT_SIZE(5) + JSON_OBJECT_SIZE(6);
+// Read from a stream, the document copies each distinct key it keeps, and
+// needs room to read in one more key (the longest in the body) before the
+// filter drops it or it is found to be a duplicate
+const size_t WEATHER_KEYS_SIZE = sizeof("current") + sizeof("hourly") + sizeof("time") + sizeof("temperature_2m") +
+                                 sizeof("precipitation") + sizeof("wind_speed_10m") + sizeof("weather_code") +
+                                 2 * sizeof("precipitation_probability");
+const size_t WEATHER_DOC_SIZE = JSON_OBJECT_SIZE(2) + JSON_OBJECT_SIZE(5) + JSON_OBJECT_SIZE(6) +
+                                6 * JSON_ARRAY_SIZE(FORECAST_HOURS) + WEATHER_KEYS_SIZE;
+StaticJsonDocument<WEATHER_FILTER_SIZE> weatherFilter;
+StaticJsonDocument<WEATHER_DOC_SIZE> weatherDoc;
+
+// Current weather data, only touched by the loop task
+WeatherData currentWeather = {};
+
+// Refetch the forecast once it is this old: 30 min while rain is near or
+// successive forecasts disagree, backing off to 6 h while they agree
+AdaptiveRate forecastRefresh(30 * 60 * 1000UL, 6 * 60 * 60 * 1000UL, 3 * 60 * 60 * 1000UL);
+
+// Cached hourly forecast, only touched by the loop task. Kept in NVS so a
+// reboot or an outage carries on from it instead of refetching or faking.
+const uint8_t FORECAST_VERSION = 1;
+WeatherForecast forecast = {};
+uint32_t publishedStep = 0; // forecastStepSeconds period of the last snapshot
+WeatherFetchTiming fetchTiming = {};
+
+// Background fetch mailbox. The loop task hands the slot to the worker by
+// setting fetchInFlight; the worker fills fetchedWeather and hands it back by
+// setting fetchDone. Only one side owns the slot at a time, so no lock.
+std::atomic<bool> fetchInFlight(false);
+std::atomic<bool> fetchDone(false);
+WeatherData fetchedWeather = {};
+WeatherForecast fetchedForecast = {};
+WeatherFetchTiming fetchedTiming = {};
+bool fetchSucceeded = false;
+unsigned long fetchFinishedAt = 0;
+
+#ifndef NATIVE_BUILD
+TaskHandle_t weatherTaskHandle = nullptr;
+const uint32_t WEATHER_TASK_STACK = 8192; // HTTPS + JSON parsing
+#endif
+
+// Fallback weather with no forecast and no WiFi: the seeded simulator, so
+// the display shows weather that changes the way weather does instead of
+// random snapshots. It is published as not real, and the window controller
+// does not act on it. Only its outdoor side is read; nothing steps its room.
+WeatherSim fallbackWeather;
+unsigned long fallbackStartedAt = 0;
+bool fallbackStarted = false;
 
 // Function prototypes
-void connectToWiFi();
-bool fetchRealWeatherData();
+bool fetchRealWeatherData(WeatherData &weather, WeatherForecast &hourly, WeatherFetchTiming &timing);
 void generateFakeWeatherData();
-String getWeatherTypeFromCode(int code);
+WeatherCode getWeatherTypeFromCode(int code);
+void startWeatherFetch();
+void collectWeatherFetch();
 
-void weatherInit()
+void setWeatherClock(uint32_t unixTime)
 {
-    // Try to connect to WiFi
-    connectToWiFi();
+#ifdef NATIVE_BUILD
+    hal::setEpochSeconds(unixTime);
+#else
+    timeval now = {(time_t)unixTime, 0};
+    settimeofday(&now, nullptr);
+#endif
+}
 
-    // Get initial weather data (real or fake)
-    refreshWeather();
+uint32_t weatherClock()
+{
+#ifdef NATIVE_BUILD
+    uint32_t now = hal::epochSeconds();
+#else
+    uint32_t now = (uint32_t)time(nullptr);
+#endif
+    return now >= CLOCK_VALID_AFTER ? now : 0;
 }
 
-WeatherData getWeather()
+void loadForecast()
 {
-    // Check if it's time to refresh data
-    unsigned long currentTime = millis();
+    Preferences prefs;
+    if (prefs.begin("weather", true))
+    {
+        if (prefs.getBytes("forecast", &forecast, sizeof(forecast)) != sizeof(forecast) ||
+            forecast.version != FORECAST_VERSION || forecast.hours > FORECAST_HOURS)
+        {
+            forecast = {};
+        }
+        prefs.end();
+    }
+}
 
-    // Refresh real data if connected and interval passed
-    if (WiFi.status() == WL_CONNECTED &&
-        (currentTime - lastFetchTime >= fetchInterval || lastFetchTime == 0))
+void runWeatherFetch()
+{
+    fetchSucceeded = fetchRealWeatherData(fetchedWeather, fetchedForecast, fetchedTiming);
+    if (fetchSucceeded)
     {
-        fetchRealWeatherData();
-        lastFetchTime = currentTime;
+        // Persist from here so the flash write never holds up the loop task
+        Preferences prefs;
+        if (prefs.begin("weather", false))
+        {
+            prefs.putBytes("forecast", &fetchedForecast, sizeof(fetchedForecast));
+            prefs.end();
+        }
     }
-    // Update fake data if not connected and interval passed
-    else if (WiFi.status() != WL_CONNECTED &&
-             (currentTime - lastFakeDataChange >= fakeDataInterval || lastFakeDataChange == 0))
+    else
     {
-        generateFakeWeatherData();
-        lastFakeDataChange = currentTime;
+        STATS_COUNT(COUNT_FETCH_FAILURES);
     }
+    fetchFinishedAt = millis();
+    fetchDone.store(true, std::memory_order_release);
+}
 
-    return currentWeather;
+#ifndef NATIVE_BUILD
+void weatherTask(void *)
+{
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        runWeatherFetch();
+    }
 }
+#endif
 
-void refreshWeather()
+void weatherInit()
 {
-    if (WiFi.status() == WL_CONNECTED)
+    // Same as HTTPClient did on its own for an https URL without a CA
+    weatherClient.setInsecure();
+
+    // Only the fallback needs the local time. Set here for a clock that
+    // survived the reset; the network module starts SNTP with it as well.
+    setenv("TZ", WEATHER_TIMEZONE, 1);
+    tzset();
+
+#ifndef NATIVE_BUILD
+    xTaskCreate(weatherTask, "weather", WEATHER_TASK_STACK, nullptr, 1, &weatherTaskHandle);
+#endif
+
+    // Carry on from the cached forecast if the clock survived the reset;
+    // otherwise fake data until the network module has a link
+    loadForecast();
+    updateWeather();
+}
+
+void startWeatherFetch()
+{
+    if (fetchInFlight.load(std::memory_order_acquire))
+    {
+        return;
+    }
+    fetchInFlight.store(true, std::memory_order_release);
+
+#ifdef NATIVE_BUILD
+    // No second task on the host: run the worker off the virtual clock so the
+    // result only becomes visible once the fetch would have finished
+    hal::runOffClock(runWeatherFetch);
+#else
+    xTaskNotifyGive(weatherTaskHandle);
+#endif
+}
+
+// Rain or snow in a forecast within RAIN_LOOKAHEAD_HOURS of now
+bool rainDue(const WeatherForecast &hourly, uint32_t now)
+{
+    for (uint8_t i = 0; i < hourly.hours; i++)
+    {
+        const ForecastHour &hour = hourly.hour[i];
+        uint32_t start = hourly.firstHour + i * 3600;
+        if (start + 3600 > now && start < now + RAIN_LOOKAHEAD_HOURS * 3600 &&
+            (hour.precipitationChance >= RAIN_CHANCE_PERCENT || isBadWeather(hour.weatherCode)))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Whether any hour moved by more than FORECAST_DRIFT_DECI between two fetches
+bool forecastDrifted(const WeatherForecast &previous, const WeatherForecast &fresh)
+{
+    for (uint8_t i = 0; i < fresh.hours; i++)
+    {
+        uint32_t start = fresh.firstHour + i * 3600;
+        uint32_t same = (start - previous.firstHour) / 3600;
+        if (previous.hours > 0 && start >= previous.firstHour && same < previous.hours &&
+            abs(fresh.hour[i].temperatureDeciF - previous.hour[same].temperatureDeciF) > FORECAST_DRIFT_DECI)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void collectWeatherFetch()
+{
+    if (!fetchDone.load(std::memory_order_acquire) || (long)(millis() - fetchFinishedAt) < 0)
+    {
+        return;
+    }
+
+    fetchTiming = fetchedTiming;
+    if (fetchSucceeded)
     {
-        if (fetchRealWeatherData())
+        currentWeather = fetchedWeather;
+        currentWeather.isValid = true;
+        currentWeather.updatedAt = fetchFinishedAt;
+        if (rainDue(fetchedForecast, weatherClock()) || forecastDrifted(forecast, fetchedForecast))
         {
-            lastFetchTime = millis();
+            forecastRefresh.hurry();
         }
         else
         {
-            generateFakeWeatherData();
-            lastFakeDataChange = millis();
+            forecastRefresh.relax();
         }
+        forecast = fetchedForecast;
+        // The fresh current conditions stand until the next forecast step
+        publishedStep = weatherClock() / forecastStepSeconds;
     }
-    else
+    else if (!currentWeather.isValid)
     {
+        // Nothing to show yet, keep the controller fed until the next attempt
         generateFakeWeatherData();
         lastFakeDataChange = millis();
     }
+
+    fetchDone.store(false, std::memory_order_relaxed);
+    fetchInFlight.store(false, std::memory_order_release);
 }
 
-void connectToWiFi()
+unsigned long updateWeather()
 {
-    Serial.print("Connecting to WiFi network: ");
-    Serial.println(ssid);
+    // Pick up a finished background fetch, if any
+    collectWeatherFetch();
 
-    WiFi.begin(ssid, password);
-
-    // Wait for connection with timeout
-    int timeout = 0;
-    while (WiFi.status() != WL_CONNECTED && timeout < 20)
+    unsigned long currentTime = millis();
+    uint32_t now = weatherClock();
+    bool connected = WiFi.status() == WL_CONNECTED;
+    unsigned long wait = ULONG_MAX;
+
+    // Refetch once the forecast gets old, or has never been fetched. Rain
+    // coming into the lookahead of the cached forecast tightens it at once.
+    uint32_t refreshSeconds = (rainDue(forecast, now) ? forecastRefresh.getMin() : forecastRefresh.interval()) / 1000;
+    uint32_t age = now && forecast.hours ? now - forecast.fetchedAt : refreshSeconds;
+    if (connected && age >= refreshSeconds)
+    {
+        if (lastFetchTime == 0 || currentTime - lastFetchTime >= fetchRetryInterval)
+        {
+            startWeatherFetch();
+            lastFetchTime = currentTime;
+        }
+        wait = fetchRetryInterval - (currentTime - lastFetchTime);
+    }
+    else if (connected)
     {
-        delay(500);
-        Serial.print(".");
-        timeout++;
+        wait = (refreshSeconds - age) * 1000UL;
     }
 
-    if (WiFi.status() == WL_CONNECTED)
+    // Between fetches, serve the current hour of the forecast
+    WeatherData cached;
+    if (forecastAt(now, cached))
     {
-        Serial.println("\nWiFi connected successfully!");
-        Serial.print("IP address: ");
-        Serial.println(WiFi.localIP());
+        uint32_t step = now / forecastStepSeconds;
+        if (step != publishedStep || !currentWeather.isRealData)
+        {
+            currentWeather = cached;
+            currentWeather.updatedAt = currentTime;
+            publishedStep = step;
+        }
+        unsigned long toNextStep = (forecastStepSeconds - now % forecastStepSeconds) * 1000UL;
+        wait = min(wait, toNextStep);
     }
-    else
+    // Update fake data if not connected and interval passed
+    else if (!connected)
+    {
+        if (currentTime - lastFakeDataChange >= fakeDataInterval || lastFakeDataChange == 0)
+        {
+            generateFakeWeatherData();
+            lastFakeDataChange = currentTime;
+        }
+        wait = fakeDataInterval - (currentTime - lastFakeDataChange);
+    }
+
+    // Look in on a fetch in flight often enough to publish it promptly
+    if (isWeatherFetchInProgress() && wait > fetchPollInterval)
     {
-        Serial.println("\nFailed to connect to WiFi. Using fake weather data.");
+        wait = fetchPollInterval;
     }
+    return wait;
 }
 
-bool fetchRealWeatherData()
+const WeatherData &getWeather()
 {
-    Serial.println("\n--- Fetching weather data ---");
+    return currentWeather;
+}
 
-    HTTPClient http;
-    http.begin(weatherUrl);
+unsigned long getWeatherAge()
+{
+    return millis() - currentWeather.updatedAt;
+}
 
-    Serial.print("Sending GET request to: ");
-    Serial.println(weatherUrl);
+const AdaptiveRate &getForecastRefresh()
+{
+    return forecastRefresh;
+}
 
-    int httpCode = http.GET();
-    Serial.print("HTTP response code: ");
-    Serial.println(httpCode);
+const WeatherFetchTiming &getWeatherFetchTiming()
+{
+    return fetchTiming;
+}
+
+bool isWeatherFetchInProgress()
+{
+    return fetchInFlight.load(std::memory_order_acquire);
+}
+
+void refreshWeather()
+{
+    if (WiFi.status() == WL_CONNECTED)
+    {
+        startWeatherFetch();
+        lastFetchTime = millis();
+    }
+    else if (!currentWeather.isRealData)
+    {
+        generateFakeWeatherData();
+        lastFakeDataChange = millis();
+    }
+}
+
+const WeatherForecast &getForecast()
+{
+    return forecast;
+}
 
-    if (httpCode == 200)
+bool forecastAt(uint32_t unixTime, WeatherData &weather)
+{
+    if (unixTime == 0 || forecast.hours == 0 || unixTime < forecast.firstHour)
     {
-        String payload = http.getString();
+        return false;
+    }
+    uint32_t offset = unixTime - forecast.firstHour;
+    uint32_t index = offset / 3600;
+    if (index >= forecast.hours)
+    {
+        return false;
+    }
 
-        // Parse JSON
-        DynamicJsonDocument doc(1024);
-        DeserializationError error = deserializeJson(doc, payload);
+    // Temperature and wind move smoothly, so interpolate towards the next hour
+    const ForecastHour &hour = forecast.hour[index];
+    const ForecastHour &next = index + 1 < forecast.hours ? forecast.hour[index + 1] : hour;
+    int32_t into = offset % 3600;
+    int32_t temperatureDeci = (hour.temperatureDeciF * (3600 - into) + next.temperatureDeciF * into) / 3600;
+    int32_t windDeci = (hour.windSpeedDeciMPH * (3600 - into) + next.windSpeedDeciMPH * into) / 3600;
+
+    weather.temperatureF = temperatureDeci / 10.0f;
+    weather.windSpeedMPH = windDeci / 10.0f;
+    weather.weatherCode = hour.weatherCode;
+    weather.precipitationAmount = hour.precipitationCentiMm / 100.0f;
+    weather.precipitationChance = hour.precipitationChance;
+    weather.isRealData = true;
+    weather.isValid = true;
+    weather.updatedAt = 0;
+    weather.isForecast = true;
+    return true;
+}
 
-        if (error)
-        {
-            Serial.print("JSON parsing failed: ");
-            Serial.println(error.c_str());
-            http.end();
-            return false;
-        }
-        else
+bool parseWeatherResponse(Stream &body, WeatherData &weather, WeatherForecast &hourly)
+{
+    // Keep only the fields we read, everything else in the body is skipped
+    // while streaming
+    static const char *const HOURLY_FIELDS[] = {"time", "temperature_2m", "precipitation_probability",
+                                                "precipitation", "wind_speed_10m", "weather_code"};
+    if (weatherFilter.isNull())
+    {
+        weatherFilter["current"]["time"] = true;
+        weatherFilter["current"]["temperature_2m"] = true;
+        weatherFilter["current"]["precipitation"] = true;
+        weatherFilter["current"]["wind_speed_10m"] = true;
+        weatherFilter["current"]["weather_code"] = true;
+        for (const char *field : HOURLY_FIELDS)
         {
-            // Extract weather data
-            float temperatureC = doc["current"]["temperature_2m"];
-            float precipitation = doc["current"]["precipitation"];
-            float windSpeed = doc["current"]["wind_speed_10m"];
-            int weatherCode = doc["current"]["weather_code"];
-
-            // Update current weather
-            currentWeather.temperatureF = temperatureC; // Already in F due to API parameter
-            currentWeather.windSpeedMPH = windSpeed;    // Already in MPH due to API parameter
-            currentWeather.precipitationAmount = precipitation;
-
-            // Determine precipitation chance based on amount (simplified)
-            currentWeather.precipitationChance = precipitation > 0 ? min(100, (int)(precipitation * 100)) : 0;
-
-            // Get weather type from code
-            currentWeather.weatherType = getWeatherTypeFromCode(weatherCode);
-
-            // Mark as real data
-            currentWeather.isRealData = true;
-
-            // Print formatted weather data
-            Serial.println("\n=== Current Weather Conditions ===");
-            Serial.print("Temperature: ");
-            Serial.print(currentWeather.temperatureF);
-            Serial.println(" °F");
-            Serial.print("Wind Speed: ");
-            Serial.print(currentWeather.windSpeedMPH);
-            Serial.println(" MPH");
-            Serial.print("Weather: ");
-            Serial.println(currentWeather.weatherType);
-            Serial.print("Precipitation: ");
-            Serial.print(currentWeather.precipitationAmount);
-            Serial.println(" mm");
-            Serial.print("Precipitation Chance: ");
-            Serial.print(currentWeather.precipitationChance);
-            Serial.println("%");
-            Serial.println("==================================\n");
-
-            http.end();
-            return true;
+            weatherFilter["hourly"][field] = true;
         }
     }
-    else
+    // A key that did not fit is dropped without a word, and its field would
+    // read as 0 from then on
+    if (weatherFilter.overflowed())
     {
-        Serial.print("HTTP request failed with error code: ");
-        Serial.println(httpCode);
-        http.end();
+        LOG(WEATHER_FILTER_OVERFLOWED);
+        return false;
+    }
+
+    DeserializationError error = deserializeJson(weatherDoc, body, DeserializationOption::Filter(weatherFilter));
+    if (error)
+    {
+        LOG(WEATHER_JSON_FAILED, error.c_str());
         return false;
     }
+
+    // Extract weather data
+    uint32_t observedAt = weatherDoc["current"]["time"];
+    float temperatureC = weatherDoc["current"]["temperature_2m"];
+    float precipitation = weatherDoc["current"]["precipitation"];
+    float windSpeed = weatherDoc["current"]["wind_speed_10m"];
+    int weatherCode = weatherDoc["current"]["weather_code"];
+
+    // Fill in the snapshot
+    weather.temperatureF = temperatureC; // Already in F due to API parameter
+    weather.windSpeedMPH = windSpeed;    // Already in MPH due to API parameter
+    weather.precipitationAmount = precipitation;
+
+    // Get weather type from code
+    weather.weatherCode = getWeatherTypeFromCode(weatherCode);
+
+    // Mark as real data
+    weather.isRealData = true;
+    weather.isForecast = false;
+
+    // Pack the hourly arrays; they all share the time axis
+    JsonVariantConst times = weatherDoc["hourly"]["time"];
+    JsonVariantConst temperatures = weatherDoc["hourly"]["temperature_2m"];
+    JsonVariantConst chances = weatherDoc["hourly"]["precipitation_probability"];
+    JsonVariantConst amounts = weatherDoc["hourly"]["precipitation"];
+    JsonVariantConst winds = weatherDoc["hourly"]["wind_speed_10m"];
+    JsonVariantConst codes = weatherDoc["hourly"]["weather_code"];
+    size_t hours = min(times.size(), (size_t)FORECAST_HOURS);
+
+    hourly = {};
+    hourly.version = FORECAST_VERSION;
+    hourly.hours = hours;
+    hourly.firstHour = times[0];
+    hourly.fetchedAt = observedAt;
+    for (size_t i = 0; i < hours; i++)
+    {
+        ForecastHour &hour = hourly.hour[i];
+        hour.temperatureDeciF = lroundf(temperatures[i].as<float>() * 10);
+        hour.windSpeedDeciMPH = constrain(lroundf(winds[i].as<float>() * 10), 0L, 65535L);
+        hour.precipitationCentiMm = constrain(lroundf(amounts[i].as<float>() * 100), 0L, 65535L);
+        hour.precipitationChance = constrain(chances[i].as<int>(), 0, 100);
+        hour.weatherCode = getWeatherTypeFromCode(codes[i].as<int>());
+    }
+
+    // The forecast probability for this hour, where there is one, beats a
+    // guess from the amount
+    if (hours > 0 && observedAt >= hourly.firstHour && observedAt - hourly.firstHour < 3600)
+    {
+        weather.precipitationChance = hourly.hour[0].precipitationChance;
+    }
+    else
+    {
+        weather.precipitationChance = precipitation > 0 ? min(100, (int)(precipitation * 100)) : 0;
+    }
+    return true;
 }
 
-void generateFakeWeatherData()
+bool fetchRealWeatherData(WeatherData &weather, WeatherForecast &hourly, WeatherFetchTiming &timing)
 {
-    // Rotate through fake weather types
-    currentFakeWeatherIndex = (currentFakeWeatherIndex + 1) % NUM_FAKE_WEATHER_TYPES;
-    String weatherType = fakeWeatherTypes[currentFakeWeatherIndex];
+    STATS_PROBE(PROBE_WEATHER_FETCH);
+    LOG(WEATHER_FETCHING);
+    timing = {};
+
+    // Look up and connect ahead of HTTPClient, which picks up the open
+    // connection, so each phase can be timed on its own
+    unsigned long fetchStart = millis();
+    unsigned long phaseStart = fetchStart;
+    IPAddress address;
+    if (!WiFi.hostByName(WEATHER_HOST, address))
+    {
+        LOG(WEATHER_DNS_FAILED);
+        timing.httpCode = WEATHER_ERROR_DNS_FAILED;
+        CAPTURE_HTTP(timing.httpCode, fetchStart, weatherClock());
+        return false;
+    }
+    timing.dnsMs = millis() - phaseStart;
+
+    // Connect to the address just looked up; the host name is still needed
+    // for SNI
+    phaseStart = millis();
+    if (!weatherClient.connect(address, 443, WEATHER_HOST, nullptr, nullptr, nullptr))
+    {
+        LOG(WEATHER_CONNECT_FAILED);
+        timing.httpCode = HTTPC_ERROR_CONNECTION_REFUSED;
+        CAPTURE_HTTP(timing.httpCode, fetchStart, weatherClock());
+        return false;
+    }
+    timing.connectMs = millis() - phaseStart;
+
+    HTTPClient http;
+    // HTTP/1.0 keeps the body free of chunked transfer framing so it can be
+    // parsed straight off the socket
+    http.useHTTP10(true);
+    http.begin(weatherClient, weatherUrl);
+
+    LOG(WEATHER_REQUEST);
+
+    phaseStart = millis();
+    int httpCode = http.GET();
+    timing.firstByteMs = millis() - phaseStart;
+    timing.httpCode = httpCode;
+    LOG(WEATHER_HTTP_CODE, httpCode);
+    CAPTURE_HTTP(httpCode, fetchStart, weatherClock());
+
+    if (httpCode != 200)
+    {
+        LOG(WEATHER_HTTP_FAILED, httpCode);
+        http.end();
+        return false;
+    }
 
-    // Generate fake data based on weather type
-    float tempF, windMPH, precipAmount;
-    int precipChance;
+    phaseStart = millis();
+    bool parsed;
+    {
+        CAPTURE_STREAM(body, http.getStream(), TRACE_HTTP_BODY);
+        parsed = parseWeatherResponse(body, weather, hourly);
+    }
+    timing.bodyMs = millis() - phaseStart;
+    http.end();
 
-    if (weatherType == "Sunny")
+    if (!parsed)
     {
-        tempF = random(70, 95);
-        windMPH = random(0, 10);
-        precipAmount = 0;
-        precipChance = 0;
+        return false;
     }
-    else if (weatherType == "Cloudy")
+
+    // Without SNTP yet, the observation time is good enough to find the
+    // current hour in the forecast
+    if (weatherClock() == 0)
     {
-        tempF = random(60, 80);
-        windMPH = random(5, 15);
-        precipAmount = 0;
-        precipChance = random(0, 30);
+        setWeatherClock(hourly.fetchedAt);
     }
-    else if (weatherType == "Rainy")
+
+    LOG(WEATHER_CURRENT, weather.temperatureF, weather.windSpeedMPH, weatherLabel(weather.weatherCode));
+    LOG(WEATHER_PRECIPITATION, weather.precipitationAmount, weather.precipitationChance);
+    LOG(WEATHER_TIMING, timing.dnsMs, timing.connectMs, timing.firstByteMs, timing.bodyMs);
+
+    return true;
+}
+
+void generateFakeWeatherData()
+{
+    // Sim time runs from the first fallback, starting at the local time of
+    // day if the clock has been set: the sim's warmest hour is local
+    if (!fallbackStarted)
     {
-        tempF = random(50, 70);
-        windMPH = random(5, 20);
-        precipAmount = random(5, 25) / 10.0;
-        precipChance = random(60, 100);
+        uint32_t secondOfDay = 0;
+        time_t now = weatherClock();
+        struct tm local;
+        if (now != 0 && localtime_r(&now, &local))
+        {
+            secondOfDay = local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec;
+        }
+        fallbackWeather.reset(WEATHER_FALLBACK_SEED, secondOfDay);
+        fallbackStartedAt = millis();
+        fallbackStarted = true;
     }
-    else
-    { // Snowy
-        tempF = random(20, 35);
-        windMPH = random(5, 25);
-        precipAmount = random(5, 30) / 10.0;
-        precipChance = random(70, 100);
-    }
-
-    // Update current weather with fake data
-    currentWeather.temperatureF = tempF;
-    currentWeather.windSpeedMPH = windMPH;
-    currentWeather.weatherType = weatherType;
-    currentWeather.precipitationAmount = precipAmount;
-    currentWeather.precipitationChance = precipChance;
+    uint64_t simMs = millis() - fallbackStartedAt;
+
+    currentWeather.temperatureF = fallbackWeather.outdoorMicroFAt(simMs) / 1000000.0f;
+    currentWeather.windSpeedMPH = fallbackWeather.windDeciMphAt(simMs) / 10.0f;
+    currentWeather.weatherCode = getWeatherTypeFromCode(fallbackWeather.wmoCodeAt(simMs));
+    currentWeather.precipitationAmount = fallbackWeather.precipitationCentiMmAt(simMs) / 100.0f;
+    currentWeather.precipitationChance = fallbackWeather.precipitationChanceAt(simMs);
     currentWeather.isRealData = false;
+    currentWeather.isForecast = false;
+    currentWeather.isValid = true;
+    currentWeather.updatedAt = millis();
 
-    Serial.println("\n=== Fake Weather Conditions ===");
-    Serial.print("Temperature: ");
-    Serial.print(currentWeather.temperatureF);
-    Serial.println(" °F");
-    Serial.print("Wind Speed: ");
-    Serial.print(currentWeather.windSpeedMPH);
-    Serial.println(" MPH");
-    Serial.print("Weather: ");
-    Serial.println(currentWeather.weatherType);
-    Serial.print("Precipitation: ");
-    Serial.print(currentWeather.precipitationAmount);
-    Serial.println(" in");
-    Serial.print("Precipitation Chance: ");
-    Serial.print(currentWeather.precipitationChance);
-    Serial.println("%");
-    Serial.println("================================\n");
+    LOG(WEATHER_FAKE, currentWeather.temperatureF, currentWeather.windSpeedMPH,
+        weatherLabel(currentWeather.weatherCode));
+    LOG(WEATHER_FAKE_PRECIPITATION, currentWeather.precipitationAmount, currentWeather.precipitationChance);
 }
 
-String getWeatherTypeFromCode(int code)
+WeatherCode getWeatherTypeFromCode(int code)
 {
     // WMO Weather interpretation codes (https://open-meteo.com/en/docs)
     if (code == 0)
-        return "Clear Sky";
+        return WeatherCode::ClearSky;
     if (code >= 1 && code <= 3)
-        return "Partly Cloudy";
+        return WeatherCode::PartlyCloudy;
     if (code >= 45 && code <= 48)
-        return "Foggy";
+        return WeatherCode::Foggy;
     if (code >= 51 && code <= 55)
-        return "Drizzle";
+        return WeatherCode::Drizzle;
     if (code >= 56 && code <= 57)
-        return "Freezing Drizzle";
+        return WeatherCode::FreezingDrizzle;
     if (code >= 61 && code <= 65)
-        return "Rain";
+        return WeatherCode::Rain;
     if (code >= 66 && code <= 67)
-        return "Freezing Rain";
+        return WeatherCode::FreezingRain;
     if (code >= 71 && code <= 77)
-        return "Snow";
+        return WeatherCode::Snow;
     if (code >= 80 && code <= 82)
-        return "Rain Showers";
+        return WeatherCode::RainShowers;
     if (code >= 85 && code <= 86)
-        return "Snow Showers";
+        return WeatherCode::SnowShowers;
     if (code >= 95 && code <= 99)
+        return WeatherCode::Thunderstorm;
+    return WeatherCode::Unknown;
+}
+
+const char *weatherLabel(WeatherCode code)
+{
+    switch (code)
+    {
+    case WeatherCode::ClearSky:
+        return "Clear Sky";
+    case WeatherCode::PartlyCloudy:
+        return "Partly Cloudy";
+    case WeatherCode::Cloudy:
+        return "Cloudy";
+    case WeatherCode::Foggy:
+        return "Foggy";
+    case WeatherCode::Drizzle:
+        return "Drizzle";
+    case WeatherCode::FreezingDrizzle:
+        return "Freezing Drizzle";
+    case WeatherCode::Rain:
+        return "Rain";
+    case WeatherCode::FreezingRain:
+        return "Freezing Rain";
+    case WeatherCode::Snow:
+        return "Snow";
+    case WeatherCode::RainShowers:
+        return "Rain Showers";
+    case WeatherCode::SnowShowers:
+        return "Snow Showers";
+    case WeatherCode::Thunderstorm:
         return "Thunderstorm";
-    return "Unknown";
+    default:
+        return "Unknown";
+    }
+}
+
+bool isBadWeather(WeatherCode code)
+{
+    switch (code)
+    {
+    case WeatherCode::Rain:
+    case WeatherCode::FreezingRain:
+    case WeatherCode::Snow:
+    case WeatherCode::RainShowers:
+    case WeatherCode::SnowShowers:
+    case WeatherCode::Thunderstorm:
+        return true;
+    default:
+        return false;
+    }
 }
@@ -2,25 +2,128 @@
 #define WEATHER_H
 
 #include <Arduino.h>
+#include "AdaptiveRate.h"
 
-// Weather data structure
+// Weather condition, grouped the way the WMO interpretation codes are
+enum class WeatherCode : uint8_t
+{
+    Unknown,
+    ClearSky,
+    PartlyCloudy,
+    Cloudy,
+    Foggy,
+    Drizzle,
+    FreezingDrizzle,
+    Rain,
+    FreezingRain,
+    Snow,
+    RainShowers,
+    SnowShowers,
+    Thunderstorm
+};
+
+// Weather data structure. Plain data, so snapshots copy without allocating.
 struct WeatherData
 {
     float temperatureF;        // Temperature in Fahrenheit
     float windSpeedMPH;        // Wind speed in MPH
-    String weatherType;        // Weather condition (e.g., "Sunny", "Rainy")
+    WeatherCode weatherCode;   // Weather condition
     float precipitationAmount; // Precipitation amount in inches
     int precipitationChance;   // Precipitation chance as percentage (0-100)
     bool isRealData;           // Flag to indicate if data is real or fake
+    bool isValid;              // False until the first snapshot is published
+    unsigned long updatedAt;   // millis() when this snapshot was published
+    bool isForecast;           // Read from the cached hourly forecast, not fetched just now
+};
+
+#define FORECAST_HOURS 24
+
+// POSIX TZ of the site. The fallback weather keeps to its local time of day,
+// so SNTP is started with configTzTime(): configTime() would set UTC again.
+#define WEATHER_TIMEZONE "EST5EDT,M3.2.0,M11.1.0"
+
+// Seed of the simulated weather served while there is no forecast
+#define WEATHER_FALLBACK_SEED 0x5EA50
+
+// One hour of forecast, packed small for the NVS cache
+struct ForecastHour
+{
+    int16_t temperatureDeciF;      // Tenths of a degree Fahrenheit
+    uint16_t windSpeedDeciMPH;     // Tenths of a MPH
+    uint16_t precipitationCentiMm; // Hundredths of a mm over the hour before
+    uint8_t precipitationChance;   // Percent
+    WeatherCode weatherCode;
+};
+
+// Hourly forecast as fetched, stamped in Unix time
+struct WeatherForecast
+{
+    uint8_t version;
+    uint8_t hours;      // Entries in use
+    uint32_t firstHour; // Start of hour[0]
+    uint32_t fetchedAt;
+    ForecastHour hour[FORECAST_HOURS];
+};
+
+// httpCode of a fetch that never got past the host lookup, clear of the
+// HTTPC_ERROR_* codes (-1 to -11)
+#define WEATHER_ERROR_DNS_FAILED (-100)
+
+// Where the time went in the last fetch attempt, in milliseconds. Phases it
+// never reached stay 0.
+struct WeatherFetchTiming
+{
+    uint16_t dnsMs;       // Host lookup, 0 when the resolver cache had it
+    uint16_t connectMs;   // TCP connect and TLS handshake
+    uint16_t firstByteMs; // Request sent to response headers in
+    uint16_t bodyMs;      // Body read and parsed off the socket
+    int16_t httpCode;     // HTTP status, a negative HTTPClient error or WEATHER_ERROR_DNS_FAILED
 };
 
-// Initialize the weather module
+// Initialize the weather module and publish the cached forecast, if it covers
+// the current hour
 void weatherInit();
 
-// Get current weather data (real or fake depending on WiFi status)
-WeatherData getWeather();
+// Weather bookkeeping: picks up a finished background fetch, refetches the
+// forecast when it gets old and otherwise serves the current hour from it.
+// Falls back to fake data only with no usable forecast and no WiFi. Never
+// waits on the network. Returns the milliseconds until it needs to run again.
+unsigned long updateWeather();
+
+// Get the latest weather snapshot
+const WeatherData &getWeather();
+
+// Display name of a weather condition (e.g., "Clear Sky", "Rain")
+const char *weatherLabel(WeatherCode code);
+
+// Rain, snow or thunder: conditions to keep the window shut for
+bool isBadWeather(WeatherCode code);
+
+// Milliseconds since the current snapshot was published
+unsigned long getWeatherAge();
 
-// Force a refresh of weather data
+// How old the forecast may get before it is refetched, adapted to how
+// settled it is
+const AdaptiveRate &getForecastRefresh();
+
+// Phase timings of the last finished fetch
+const WeatherFetchTiming &getWeatherFetchTiming();
+
+// True while a background fetch is running
+bool isWeatherFetchInProgress();
+
+// Start a refresh of weather data without waiting for it
 void refreshWeather();
 
+// The cached forecast (hours is 0 without one), and the current hour from it
+const WeatherForecast &getForecast();
+bool forecastAt(uint32_t unixTime, WeatherData &weather);
+
+// Unix time from the system clock, 0 until SNTP or a fetch has set it
+uint32_t weatherClock();
+
+// Decode an Open-Meteo /v1/forecast body straight from the stream into the
+// current conditions and the hourly forecast
+bool parseWeatherResponse(Stream &body, WeatherData &weather, WeatherForecast &forecast);
+
 #endif
@@ -0,0 +1,169 @@
+// DHT replies decoded from synthetic RMT captures: clean, jittered and
+// corrupted, each with the status the decoder has to give it
+#include <Arduino.h>
+#include <unity.h>
+#include "NativeHal.h"
+#include "DhtReader.h"
+
+namespace
+{
+    // Pulse 3 + 2n is the low before bit n, 4 + 2n its high
+    const uint8_t DHT11_BYTES[] = {45, 0, 23, 0, 68};             // 45 %, 23 C
+    const uint8_t DHT22_BYTES[] = {0x02, 0x64, 0x80, 0x35, 0x1B}; // 61.2 %, -5.3 C
+
+    // A reply as dhtUnpackItems() gives it, with room for inserted pulses
+    struct DhtTrace
+    {
+        DhtPulse pulses[DHT_MAX_PULSES + 4];
+        size_t count;
+    };
+
+    DhtTrace encodeDhtTrace(const uint8_t *bytes, uint8_t jitterUs)
+    {
+        uint32_t items[DHT_MAX_PULSES / 2];
+        DhtTrace trace;
+        size_t itemCount = hal::dhtEncode(bytes, items, DHT_MAX_PULSES / 2, jitterUs);
+        trace.count = dhtUnpackItems(items, itemCount, trace.pulses, DHT_MAX_PULSES);
+        return trace;
+    }
+
+    // Put a pulse in front of pulse at, shifting the rest along
+    void insertDhtPulse(DhtTrace &trace, size_t at, uint8_t level, uint16_t us)
+    {
+        memmove(&trace.pulses[at + 1], &trace.pulses[at], (trace.count - at) * sizeof(DhtPulse));
+        trace.pulses[at] = DhtPulse{us, level};
+        trace.count++;
+    }
+
+    DhtStatus decode(const DhtTrace &trace, uint8_t type, DhtReading &reading)
+    {
+        return dhtDecode(trace.pulses, trace.count, type, reading);
+    }
+
+    DhtStatus decode(const DhtTrace &trace, uint8_t type)
+    {
+        DhtReading reading;
+        return decode(trace, type, reading);
+    }
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_dht11_clean()
+{
+    DhtReading reading;
+    TEST_ASSERT_EQUAL(DHT_OK, decode(encodeDhtTrace(DHT11_BYTES, 0), DHT11, reading));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(DHT11_BYTES, reading.bytes, 5);
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 23.0, reading.temperatureC);
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 45.0, reading.humidity);
+}
+
+void test_dht11_jitter()
+{
+    DhtReading reading;
+    TEST_ASSERT_EQUAL(DHT_OK, decode(encodeDhtTrace(DHT11_BYTES, 12), DHT11, reading));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(DHT11_BYTES, reading.bytes, 5);
+}
+
+void test_dht22_below_zero()
+{
+    DhtReading reading;
+    TEST_ASSERT_EQUAL(DHT_OK, decode(encodeDhtTrace(DHT22_BYTES, 4), DHT22, reading));
+    TEST_ASSERT_FLOAT_WITHIN(0.05, -5.3, reading.temperatureC);
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 61.2, reading.humidity);
+}
+
+void test_start_signal_in_front()
+{
+    DhtTrace trace = encodeDhtTrace(DHT11_BYTES, 4);
+    insertDhtPulse(trace, 0, LOW, 20000);
+    TEST_ASSERT_EQUAL(DHT_OK, decode(trace, DHT11));
+}
+
+void test_one_bit_flipped()
+{
+    DhtTrace trace = encodeDhtTrace(DHT11_BYTES, 4);
+    trace.pulses[4 + 2 * 13].us = 70; // Bits 8-15, the humidity tenths, are all 0
+    TEST_ASSERT_EQUAL(DHT_BAD_CHECKSUM, decode(trace, DHT11));
+}
+
+void test_cut_off()
+{
+    DhtTrace trace = encodeDhtTrace(DHT11_BYTES, 4);
+    trace.count = 3 + 2 * 30;
+    TEST_ASSERT_EQUAL(DHT_TRUNCATED, decode(trace, DHT11));
+}
+
+void test_glitch_in_a_bit()
+{
+    DhtTrace trace = encodeDhtTrace(DHT11_BYTES, 4);
+    trace.pulses[4 + 2 * 5].us = 30; // A 1 split by a 4 us dip
+    insertDhtPulse(trace, 5 + 2 * 5, LOW, 4);
+    insertDhtPulse(trace, 6 + 2 * 5, HIGH, 36);
+    TEST_ASSERT_EQUAL(DHT_BAD_TIMING, decode(trace, DHT11));
+}
+
+void test_stretched_low()
+{
+    DhtTrace trace = encodeDhtTrace(DHT11_BYTES, 4);
+    trace.pulses[3 + 2 * 20].us = 200;
+    TEST_ASSERT_EQUAL(DHT_BAD_TIMING, decode(trace, DHT11));
+}
+
+void test_no_reply()
+{
+    DhtTrace trace;
+    trace.count = 0;
+    TEST_ASSERT_EQUAL(DHT_NO_RESPONSE, decode(trace, DHT11));
+
+    for (int i = 0; i < 12; i++)
+    {
+        trace.pulses[trace.count++] = DhtPulse{(uint16_t)(5 + i * 3), (uint8_t)(i % 2)};
+    }
+    TEST_ASSERT_EQUAL(DHT_NO_RESPONSE, decode(trace, DHT11));
+}
+
+// The stand-in's own replies: whatever it garbles has to come out as an
+// error, never as a reading that passed
+void test_stand_in_replies()
+{
+    hal::env().dhtErrorPercent = 10;
+    int ok = 0;
+    for (int i = 0; i < 1000; i++)
+    {
+        uint32_t items[DHT_MAX_PULSES / 2];
+        DhtPulse pulses[DHT_MAX_PULSES];
+        size_t count = dhtUnpackItems(items, hal::dhtCapture(true, items, DHT_MAX_PULSES / 2), pulses,
+                                      DHT_MAX_PULSES);
+        DhtReading reading;
+        if (dhtDecode(pulses, count, DHT11, reading) == DHT_OK)
+        {
+            ok++;
+            TEST_ASSERT_FLOAT_WITHIN(1.0, hal::indoorTemperatureF(), reading.temperatureC * 9 / 5 + 32);
+        }
+    }
+    hal::env().dhtErrorPercent = 0;
+    TEST_ASSERT_INT_WITHIN(50, 900, ok);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_dht11_clean);
+    RUN_TEST(test_dht11_jitter);
+    RUN_TEST(test_dht22_below_zero);
+    RUN_TEST(test_start_signal_in_front);
+    RUN_TEST(test_one_bit_flipped);
+    RUN_TEST(test_cut_off);
+    RUN_TEST(test_glitch_in_a_bit);
+    RUN_TEST(test_stretched_low);
+    RUN_TEST(test_no_reply);
+    RUN_TEST(test_stand_in_replies);
+    return UNITY_END();
+}
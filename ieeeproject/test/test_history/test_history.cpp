@@ -0,0 +1,140 @@
+// Sample history: samples come back from flash and the RAM ring exactly,
+// the hour rollups survive a reboot, and a damaged block is skipped
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <unity.h>
+#include "NativeHal.h"
+#include "history.h"
+
+namespace
+{
+    // A sample every 30 s, the sensor job's pace, over three days
+    const uint32_t INTERVAL = 30;
+    const uint32_t SAMPLES = 3 * 86400 / INTERVAL;
+    const uint32_t START_TIME = 1775347200; // 2026-04-05 00:00 UTC
+    const uint32_t END_TIME = START_TIME + SAMPLES * INTERVAL;
+
+    // Slow drifts with a little noise, and outdoor gaps now and then
+    void sampleAt(uint32_t i, int16_t values[HISTORY_CHANNELS])
+    {
+        uint32_t noise = i * 2654435761u;
+        values[HISTORY_INDOOR_TEMP] = 700 + 40 * sin(i / 2880.0 * 2 * M_PI) + (int)(noise >> 30);
+        values[HISTORY_HUMIDITY] = 450 + (int)(noise >> 28 & 7);
+        values[HISTORY_OUTDOOR_TEMP] = i % 480 < 20 ? HISTORY_MISSING : 600 + 150 * sin(i / 2880.0 * 2 * M_PI);
+        values[HISTORY_WINDOW] = i / 240 % 3 * 450;
+    }
+
+    void addSamples(uint32_t first, uint32_t last)
+    {
+        for (uint32_t i = first; i < last; i++)
+        {
+            int16_t values[HISTORY_CHANNELS];
+            sampleAt(i, values);
+            hal::setEpochSeconds(START_TIME + i * INTERVAL);
+            historyAdd(values);
+        }
+        hal::setEpochSeconds(START_TIME + last * INTERVAL);
+    }
+
+    // Queried at the sample interval, every sample is its own bucket
+    void checkRawRange(uint32_t from, uint32_t samples)
+    {
+        HistoryPoint points[HISTORY_QUERY_MAX_POINTS];
+        for (int channel = 0; channel < HISTORY_CHANNELS; channel++)
+        {
+            size_t count = historyQuery((HistoryChannel)channel, from, from + samples * INTERVAL, INTERVAL, points,
+                                        HISTORY_QUERY_MAX_POINTS);
+            TEST_ASSERT_EQUAL(samples, count);
+            for (size_t p = 0; p < count; p++)
+            {
+                uint32_t i = (points[p].time - START_TIME) / INTERVAL;
+                int16_t values[HISTORY_CHANNELS];
+                sampleAt(i, values);
+                if (values[channel] == HISTORY_MISSING)
+                {
+                    TEST_ASSERT_EQUAL(0, points[p].count);
+                    continue;
+                }
+                TEST_ASSERT_EQUAL(1, points[p].count);
+                TEST_ASSERT_EQUAL_INT16(values[channel], points[p].avg);
+            }
+        }
+    }
+}
+
+void setUp()
+{
+    LittleFS.format();
+    historyInit();
+    addSamples(0, SAMPLES);
+}
+
+void tearDown()
+{
+}
+
+void test_raw_samples_from_flash()
+{
+    checkRawRange(START_TIME + 86400, 240);
+}
+
+// Two hours across the point where flash ends and the RAM ring takes over
+void test_raw_samples_across_flash_and_ram()
+{
+    checkRawRange(END_TIME - 100 * INTERVAL, 100);
+    checkRawRange(END_TIME - (HISTORY_RAW_SAMPLES + 60) * INTERVAL, HISTORY_RAW_SAMPLES + 60);
+}
+
+void test_rollups_survive_a_reload()
+{
+    const size_t buckets = 12;
+    HistoryPoint before[buckets];
+    HistoryPoint after[buckets];
+    uint32_t from = END_TIME - buckets * 6 * 3600;
+    TEST_ASSERT_EQUAL(buckets, historyQuery(HISTORY_INDOOR_TEMP, from, END_TIME, 6 * 3600, before, buckets));
+
+    historyInit();
+    TEST_ASSERT_GREATER_THAN(0, getHistoryStats().segmentsInUse);
+    TEST_ASSERT_EQUAL(buckets, historyQuery(HISTORY_INDOOR_TEMP, from, END_TIME, 6 * 3600, after, buckets));
+
+    // The hour still open at the reboot was never written
+    for (size_t i = 0; i < buckets - 1; i++)
+    {
+        TEST_ASSERT_EQUAL(before[i].count, after[i].count);
+        TEST_ASSERT_EQUAL_INT16(before[i].min, after[i].min);
+        TEST_ASSERT_EQUAL_INT16(before[i].max, after[i].max);
+        TEST_ASSERT_EQUAL_INT16(before[i].avg, after[i].avg);
+    }
+}
+
+// A sample record too short for a block header in every segment: the reload
+// and the flash walk step over it, and the blocks written after it read back
+void test_short_block_is_skipped()
+{
+    const uint8_t shortRecord[] = {1, 4, 0, 0xAA, 0xBB, 0xCC, 0xDD};
+    for (uint8_t slot = 0; slot < HISTORY_SEGMENTS; slot++)
+    {
+        char path[24];
+        snprintf(path, sizeof(path), "/history/%u.seg", slot);
+        if (LittleFS.exists(path))
+        {
+            File file = LittleFS.open(path, FILE_APPEND);
+            file.write(shortRecord, sizeof(shortRecord));
+            file.close();
+        }
+    }
+
+    historyInit();
+    addSamples(SAMPLES, SAMPLES + 4 * HISTORY_RAW_SAMPLES);
+    checkRawRange(START_TIME + (SAMPLES + 2 * HISTORY_RAW_SAMPLES) * INTERVAL - 60 * INTERVAL, 120);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_raw_samples_from_flash);
+    RUN_TEST(test_raw_samples_across_flash_and_ram);
+    RUN_TEST(test_rollups_survive_a_reload);
+    RUN_TEST(test_short_block_is_skipped);
+    return UNITY_END();
+}
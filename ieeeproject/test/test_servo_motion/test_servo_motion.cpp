@@ -0,0 +1,118 @@
+// Servo trajectories: planned timing against the analytic trapezoid, the
+// steps written once per PWM frame, and the release after a move
+#include <Arduino.h>
+#include <unity.h>
+#include "NativeHal.h"
+#include "ServoMotion.h"
+#include "WindowController.h"
+
+namespace
+{
+    // Full swing to a small nudge, both ways, and a move to where it already is
+    const struct
+    {
+        int from;
+        int to;
+    } MOVES[] = {{0, 180}, {180, 0}, {0, 90}, {45, 55}, {90, 91}, {30, 30}};
+
+    // Duration of a move from the profile: trapezoid when it reaches full
+    // speed, triangle when it does not
+    double expectedMs(int from, int to)
+    {
+        const double speed = ServoMotion::MAX_SPEED;
+        const double accel = ServoMotion::ACCEL;
+        double distance = abs(to - from);
+        return distance >= speed * speed / accel ? (distance / speed + speed / accel) * 1000
+                                                 : 2 * sqrt(distance / accel) * 1000;
+    }
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_durations_match_the_profile()
+{
+    for (auto &move : MOVES)
+    {
+        MotionPlan plan = planMotion(move.from, move.to, ServoMotion::MAX_SPEED, ServoMotion::ACCEL);
+        TEST_ASSERT_FLOAT_WITHIN(2, expectedMs(move.from, move.to), motionDurationMs(plan));
+    }
+
+    // The full swing is the one the speed limit is quoted against
+    MotionPlan swing = planMotion(0, 180, ServoMotion::MAX_SPEED, ServoMotion::ACCEL);
+    TEST_ASSERT_EQUAL_UINT32(2500, motionDurationMs(swing));
+    TEST_ASSERT_EQUAL(ServoMotion::MAX_SPEED * 1000, swing.peakMdegPerS);
+    TEST_ASSERT_GREATER_THAN(0, swing.cruiseMs);
+
+    // Too short to get up to speed
+    MotionPlan nudge = planMotion(45, 55, ServoMotion::MAX_SPEED, ServoMotion::ACCEL);
+    TEST_ASSERT_EQUAL_UINT32(0, nudge.cruiseMs);
+    TEST_ASSERT_LESS_THAN(ServoMotion::MAX_SPEED * 1000, nudge.peakMdegPerS);
+}
+
+// Sampled once per PWM frame, the way update() does, a plan has to keep
+// going the same way, never beat the speed limit, and land on the target
+void test_frames_stay_within_the_speed_limit()
+{
+    const int32_t maxStep = ServoMotion::MAX_SPEED * ServoMotion::STEP_MS + 1;
+    for (auto &move : MOVES)
+    {
+        MotionPlan plan = planMotion(move.from, move.to, ServoMotion::MAX_SPEED, ServoMotion::ACCEL);
+        uint32_t total = motionDurationMs(plan);
+        int32_t previous = motionPositionAt(plan, 0);
+        TEST_ASSERT_EQUAL_INT32(move.from * 1000, previous);
+        for (uint32_t t = ServoMotion::STEP_MS; t < total + ServoMotion::STEP_MS; t += ServoMotion::STEP_MS)
+        {
+            int32_t position = motionPositionAt(plan, t);
+            int32_t step = move.to >= move.from ? position - previous : previous - position;
+            TEST_ASSERT_GREATER_OR_EQUAL(0, step);
+            TEST_ASSERT_LESS_OR_EQUAL(maxStep, step);
+            previous = position;
+        }
+        TEST_ASSERT_EQUAL_INT32(move.to * 1000, previous);
+    }
+}
+
+// The whole path on the virtual clock: the controller's job stepping a full
+// swing, holding, and letting go of the PWM once
+void test_controller_moves_then_releases()
+{
+    WindowController controller(3);
+    controller.begin([]() {});
+    uint64_t start = hal::nowMicros();
+    uint64_t arrivedUs = 0;
+    controller.setPosition(180);
+    for (unsigned long wait = controller.updateMotion(); wait != 0; wait = controller.updateMotion())
+    {
+        if (arrivedUs == 0 && controller.getServoPosition() == 180)
+        {
+            arrivedUs = hal::nowMicros() - start;
+        }
+        hal::advanceMicros((uint64_t)wait * 1000);
+    }
+    uint64_t releasedMs = (hal::nowMicros() - start) / 1000;
+
+    // On target within a frame of the plan, and let go HOLD_MS after it ends
+    uint32_t planMs = motionDurationMs(planMotion(0, 180, ServoMotion::MAX_SPEED, ServoMotion::ACCEL));
+    TEST_ASSERT_NOT_EQUAL(0, arrivedUs);
+    TEST_ASSERT_LESS_OR_EQUAL(planMs + ServoMotion::STEP_MS, arrivedUs / 1000);
+    TEST_ASSERT_UINT32_WITHIN(ServoMotion::STEP_MS, planMs + ServoMotion::HOLD_MS, releasedMs);
+
+    const ServoMotionStats &stats = controller.getMotionStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.detaches);
+    TEST_ASSERT_EQUAL(180, controller.getServoPosition());
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_durations_match_the_profile);
+    RUN_TEST(test_frames_stay_within_the_speed_limit);
+    RUN_TEST(test_controller_moves_then_releases);
+    return UNITY_END();
+}
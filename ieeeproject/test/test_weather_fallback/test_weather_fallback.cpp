@@ -0,0 +1,83 @@
+// Fallback weather after a connect: SNTP is started on the first link, and
+// the simulator that takes over once the link and the forecast are gone
+// still starts at the site's local time of day, not at UTC
+#include <Arduino.h>
+#include <Preferences.h>
+#include <unity.h>
+#include "NativeHal.h"
+#include "network.h"
+#include "weather.h"
+
+namespace
+{
+    const uint32_t START_TIME = 1775399400;  // 2026-04-05 14:30 UTC
+    const int32_t EDT_OFFSET = -4 * 3600;    // In effect at the site on that day
+
+    // One hour of forecast in NVS from before a soft reset, so the boot
+    // serves it instead of starting the fallback
+    void cacheForecastHour(uint32_t firstHour)
+    {
+        WeatherForecast cached = {};
+        cached.version = 1;
+        cached.hours = 1;
+        cached.firstHour = firstHour;
+        cached.fetchedAt = firstHour;
+        cached.hour[0] = {650, 50, 0, 10, WeatherCode::ClearSky};
+        Preferences prefs;
+        prefs.begin("weather", false);
+        prefs.putBytes("forecast", &cached, sizeof(cached));
+        prefs.end();
+    }
+
+    float fallbackStartF(uint32_t secondOfDay)
+    {
+        WeatherSim sim(WEATHER_FALLBACK_SEED, secondOfDay);
+        return sim.outdoorMicroFAt(0) / 1000000.0f;
+    }
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_fallback_after_connect_starts_at_local_time()
+{
+    // Boot the way main.cpp does, from a soft reset with the clock kept
+    hal::env().wallClockAtStart = START_TIME;
+    hal::env().rtcTimeValid = true;
+    cacheForecastHour(START_TIME - START_TIME % 3600);
+    networkInit(nullptr);
+    weatherInit();
+    TEST_ASSERT_TRUE(getWeather().isForecast);
+
+    // Connect, which starts SNTP
+    while (getNetworkStats().state != NETWORK_CONNECTED)
+    {
+        hal::advanceMicros((uint64_t)updateNetwork() * 1000);
+    }
+
+    // Lose the link until the forecast runs out: the simulator takes over
+    hal::env().wifiAvailable = false;
+    hal::advanceMicros(3600ULL * 1000000);
+    updateWeather();
+    const WeatherData &weather = getWeather();
+    TEST_ASSERT_TRUE(weather.isValid);
+    TEST_ASSERT_FALSE(weather.isRealData);
+
+    uint32_t now = weatherClock();
+    uint32_t localSecond = (now + EDT_OFFSET) % 86400;
+    uint32_t utcSecond = now % 86400;
+    TEST_ASSERT_NOT_EQUAL(fallbackStartF(utcSecond), fallbackStartF(localSecond));
+    TEST_ASSERT_EQUAL_FLOAT(fallbackStartF(localSecond), weather.temperatureF);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fallback_after_connect_starts_at_local_time);
+    return UNITY_END();
+}
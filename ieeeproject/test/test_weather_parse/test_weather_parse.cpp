@@ -0,0 +1,122 @@
+// Open-Meteo decode: a canned timeformat=unixtime body, fed through a
+// Stream, comes out with the current conditions and all 24 forecast hours,
+// every field of every hour read
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include <unity.h>
+#include "weather.h"
+
+namespace
+{
+    // Same shape and field order as api.open-meteo.com sends for weatherUrl,
+    // fetched at 2026-04-05 14:30 UTC with rain coming in the afternoon
+    const char BODY[] =
+        "{\"latitude\":40.69759,\"longitude\":-75.21269,\"generationtime_ms\":0.0641345977783203,"
+        "\"utc_offset_seconds\":0,\"timezone\":\"GMT\",\"timezone_abbreviation\":\"GMT\",\"elevation\":104.0,"
+        "\"current_units\":{\"time\":\"unixtime\",\"interval\":\"seconds\",\"temperature_2m\":\"°F\","
+        "\"relative_humidity_2m\":\"%\",\"precipitation\":\"mm\",\"wind_speed_10m\":\"mp/h\","
+        "\"weather_code\":\"wmo code\"},"
+        "\"current\":{\"time\":1775399400,\"interval\":900,\"temperature_2m\":58.9,\"relative_humidity_2m\":71,"
+        "\"precipitation\":0.00,\"wind_speed_10m\":8.6,\"weather_code\":3},"
+        "\"hourly_units\":{\"time\":\"unixtime\",\"temperature_2m\":\"°F\",\"precipitation_probability\":\"%\","
+        "\"precipitation\":\"mm\",\"wind_speed_10m\":\"mp/h\",\"weather_code\":\"wmo code\"},"
+        "\"hourly\":{"
+        "\"time\":[1775397600,1775401200,1775404800,1775408400,1775412000,1775415600,1775419200,1775422800,"
+        "1775426400,1775430000,1775433600,1775437200,1775440800,1775444400,1775448000,1775451600,1775455200,"
+        "1775458800,1775462400,1775466000,1775469600,1775473200,1775476800,1775480400],"
+        "\"temperature_2m\":[58.4,59.1,58.7,57.2,55.8,54.3,52.9,51.6,50.2,49.5,48.8,48.1,47.6,47.2,46.9,46.5,"
+        "46.8,48.3,50.7,53.4,55.9,57.6,58.8,59.5],"
+        "\"precipitation_probability\":[5,10,25,40,65,85,90,80,55,35,20,15,10,8,8,5,5,3,3,5,10,15,20,30],"
+        "\"precipitation\":[0.00,0.00,0.10,0.40,1.20,2.80,3.50,1.90,0.60,0.20,0.00,0.00,0.00,0.00,0.00,0.00,"
+        "0.00,0.00,0.00,0.00,0.00,0.00,0.00,0.10],"
+        "\"wind_speed_10m\":[8.2,9.0,10.4,12.1,14.8,16.3,15.0,13.2,11.5,9.8,8.1,7.4,6.9,6.2,5.8,5.5,5.9,6.8,"
+        "7.7,8.5,9.1,9.6,10.2,10.8],"
+        "\"weather_code\":[3,3,61,61,63,65,95,95,80,61,51,45,45,3,2,2,1,1,2,3,3,3,51,61]}}";
+
+    const uint32_t FIRST_HOUR = 1775397600;
+
+    const int16_t TEMPERATURES[FORECAST_HOURS] = {584, 591, 587, 572, 558, 543, 529, 516, 502, 495, 488, 481,
+                                                  476, 472, 469, 465, 468, 483, 507, 534, 559, 576, 588, 595};
+    const uint8_t CHANCES[FORECAST_HOURS] = {5, 10, 25, 40, 65, 85, 90, 80, 55, 35, 20, 15,
+                                             10, 8, 8, 5, 5, 3, 3, 5, 10, 15, 20, 30};
+    const WeatherCode P = WeatherCode::PartlyCloudy;
+    const WeatherCode R = WeatherCode::Rain;
+    const WeatherCode CODES[FORECAST_HOURS] = {
+        P, P, R, R, R, R, WeatherCode::Thunderstorm, WeatherCode::Thunderstorm, WeatherCode::RainShowers,
+        R, WeatherCode::Drizzle, WeatherCode::Foggy, WeatherCode::Foggy, P, P, P, P, P, P, P, P, P,
+        WeatherCode::Drizzle, R};
+
+    WeatherData weather;
+    WeatherForecast hourly;
+    bool parsed;
+}
+
+void setUp()
+{
+    WiFiClient body;
+    body.load(BODY, sizeof(BODY) - 1);
+    weather = {};
+    hourly = {};
+    parsed = parseWeatherResponse(body, weather, hourly);
+}
+
+void tearDown()
+{
+}
+
+void test_current_conditions()
+{
+    TEST_ASSERT_TRUE(parsed);
+    TEST_ASSERT_TRUE(weather.isRealData);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 58.9, weather.temperatureF);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 8.6, weather.windSpeedMPH);
+    TEST_ASSERT_EQUAL(WeatherCode::PartlyCloudy, weather.weatherCode);
+    // The current hour's forecast chance, not a guess from the amount
+    TEST_ASSERT_EQUAL(5, weather.precipitationChance);
+}
+
+void test_all_hours()
+{
+    TEST_ASSERT_TRUE(parsed);
+    TEST_ASSERT_EQUAL(FORECAST_HOURS, hourly.hours);
+    TEST_ASSERT_EQUAL_UINT32(FIRST_HOUR, hourly.firstHour);
+    TEST_ASSERT_EQUAL_UINT32(1775399400, hourly.fetchedAt);
+}
+
+// Every field of every hour came through the filter: none reads as the 0 a
+// dropped filter key leaves behind, which would also read as clear sky
+void test_every_hour_read()
+{
+    TEST_ASSERT_TRUE(parsed);
+    for (int i = 0; i < FORECAST_HOURS; i++)
+    {
+        const ForecastHour &hour = hourly.hour[i];
+        TEST_ASSERT_NOT_EQUAL(0, hour.temperatureDeciF);
+        TEST_ASSERT_NOT_EQUAL(0, hour.precipitationChance);
+        TEST_ASSERT_NOT_EQUAL(0, hour.windSpeedDeciMPH);
+        TEST_ASSERT_NOT_EQUAL(WeatherCode::ClearSky, hour.weatherCode);
+        TEST_ASSERT_EQUAL_INT16(TEMPERATURES[i], hour.temperatureDeciF);
+        TEST_ASSERT_EQUAL_UINT8(CHANCES[i], hour.precipitationChance);
+        TEST_ASSERT_EQUAL(CODES[i], hour.weatherCode);
+    }
+    TEST_ASSERT_EQUAL_UINT16(350, hourly.hour[6].precipitationCentiMm);
+}
+
+// Rain in the cached forecast is what closes the window while offline
+void test_rain_hours_are_bad_weather()
+{
+    TEST_ASSERT_TRUE(parsed);
+    TEST_ASSERT_FALSE(isBadWeather(hourly.hour[0].weatherCode));
+    TEST_ASSERT_TRUE(isBadWeather(hourly.hour[2].weatherCode));
+    TEST_ASSERT_TRUE(isBadWeather(hourly.hour[6].weatherCode));
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_current_conditions);
+    RUN_TEST(test_all_hours);
+    RUN_TEST(test_every_hour_read);
+    RUN_TEST(test_rain_hours_are_bad_weather);
+    return UNITY_END();
+}
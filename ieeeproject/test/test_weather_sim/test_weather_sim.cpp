@@ -0,0 +1,145 @@
+// Seeded weather and room simulator: the same seed gives the same weather,
+// the day peaks at the local hour it is set to, and the room follows the
+// window
+#include <Arduino.h>
+#include <unity.h>
+#include <WeatherSim.h>
+
+namespace
+{
+    const uint64_t HOUR_MS = 3600000;
+    const uint64_t DAY_MS = 24 * HOUR_MS;
+
+    // Clear skies with a fixed daily mean, so only the day-night swing moves
+    const WeatherSim::Params CLEAR_SKIES = {
+        660,
+        100,
+        15,
+        0,
+        {{100, 0, 0, 0}, {100, 0, 0, 0}, {100, 0, 0, 0}, {100, 0, 0, 0}},
+    };
+
+    // Sim time of the warmest 10 minutes in the day from fromMs
+    uint64_t warmestAt(WeatherSim &sim, uint64_t fromMs)
+    {
+        uint64_t warmest = fromMs;
+        for (uint64_t ms = fromMs; ms < fromMs + DAY_MS; ms += 600000)
+        {
+            if (sim.outdoorMicroFAt(ms) > sim.outdoorMicroFAt(warmest))
+            {
+                warmest = ms;
+            }
+        }
+        return warmest;
+    }
+
+    // Mean indoor temperature over three days with the window held at deg
+    int32_t meanIndoorMicroF(int deg)
+    {
+        WeatherSim sim(3);
+        sim.setWindow(deg);
+        int64_t sum = 0;
+        int samples = 0;
+        for (uint64_t ms = DAY_MS; ms <= 4 * DAY_MS; ms += 600000)
+        {
+            sim.advanceTo(ms);
+            sum += sim.room().indoorMicroF();
+            samples++;
+        }
+        return (int32_t)(sum / samples);
+    }
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_same_seed_same_weather()
+{
+    WeatherSim first(1);
+    WeatherSim second(1);
+    for (uint64_t ms = 0; ms < 30 * DAY_MS; ms += 600000)
+    {
+        TEST_ASSERT_EQUAL_INT32(first.outdoorMicroFAt(ms), second.outdoorMicroFAt(ms));
+        TEST_ASSERT_EQUAL(first.wmoCodeAt(ms), second.wmoCodeAt(ms));
+        TEST_ASSERT_EQUAL(first.precipitationChanceAt(ms), second.precipitationChanceAt(ms));
+    }
+
+    // reset() starts the same sequence over
+    WeatherSim fresh(1);
+    WeatherSim again(5);
+    again.advanceTo(DAY_MS);
+    again.reset(1, 0);
+    for (uint64_t ms = 0; ms < 7 * DAY_MS; ms += HOUR_MS)
+    {
+        TEST_ASSERT_EQUAL(fresh.wmoCodeAt(ms), again.wmoCodeAt(ms));
+    }
+}
+
+void test_other_seed_other_weather()
+{
+    WeatherSim first(1);
+    WeatherSim other(2);
+    int differs = 0;
+    for (uint64_t ms = 0; ms < 30 * DAY_MS; ms += HOUR_MS)
+    {
+        differs += first.wmoCodeAt(ms) != other.wmoCodeAt(ms);
+    }
+    TEST_ASSERT_GREATER_THAN(0, differs);
+}
+
+// A forecast read ahead sees the hours the sim later steps through
+void test_forecast_matches_what_comes()
+{
+    WeatherSim sim(9);
+    int32_t forecast[24];
+    for (int hour = 0; hour < 24; hour++)
+    {
+        forecast[hour] = sim.outdoorMicroFAt(hour * HOUR_MS);
+    }
+    for (int hour = 0; hour < 24; hour++)
+    {
+        sim.advanceTo(hour * HOUR_MS);
+        TEST_ASSERT_EQUAL_INT32(forecast[hour], sim.outdoorMicroFAt(hour * HOUR_MS));
+    }
+}
+
+// startSecondOfDay is local time: the day peaks at warmestHour local,
+// wherever in the day the sim starts
+void test_warmest_at_the_local_hour()
+{
+    for (uint32_t startHour : {0u, 6u, 15u, 22u})
+    {
+        WeatherSim sim(1, startHour * 3600, CLEAR_SKIES);
+        uint64_t warmest = warmestAt(sim, DAY_MS);
+        uint32_t localSecond = (startHour * 3600 + warmest / 1000) % 86400;
+        TEST_ASSERT_UINT32_WITHIN(1800, CLEAR_SKIES.warmestHour * 3600, localSecond);
+    }
+}
+
+// The default climate runs cooler than the shut room, so the wider the
+// window, the closer the room comes to the outdoor mean
+void test_room_follows_the_window()
+{
+    int32_t shut = meanIndoorMicroF(0);
+    int32_t half = meanIndoorMicroF(90);
+    int32_t open = meanIndoorMicroF(180);
+    TEST_ASSERT_GREATER_THAN(half, shut);
+    TEST_ASSERT_GREATER_THAN(open, half);
+    TEST_ASSERT_INT_WITHIN(15000000, WeatherSim::DEFAULT_PARAMS.meanDeciF * 100000, open);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_same_seed_same_weather);
+    RUN_TEST(test_other_seed_other_weather);
+    RUN_TEST(test_forecast_matches_what_comes);
+    RUN_TEST(test_warmest_at_the_local_hour);
+    RUN_TEST(test_room_follows_the_window);
+    return UNITY_END();
+}
@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""Decode the binary log records the firmware writes when built with
+-DLOG_BINARY=1.
+
+Reads a serial capture (a file, or stdin) and prints it with every record
+turned back into its text, prefixed with the device time. Anything between
+records is the firmware's ordinary text output and is passed through.
+
+    pio device monitor --raw | tools/log_decode.py
+    tools/log_decode.py capture.bin
+
+Message IDs come from src/log_messages.h, so decode with the same revision
+the firmware was built from.
+"""
+
+import argparse
+import codecs
+import os
+import re
+import struct
+import sys
+
+FRAME_MARKER = 0x1E
+HEADER = struct.Struct("<BBBI")  # marker, ID, payload size, time in ms
+
+MESSAGE_LINE = re.compile(r'^LOG_MESSAGE\((\w+),\s*(\w+),\s*"((?:[^"\\]|\\.)*)"\)')
+CONVERSION = re.compile(r"%(%|[-+ #0]*\d*(?:\.\d+)?(?:hh|h|ll|l|z)?([diuxXceEfFgGs]))")
+
+DEFAULT_MESSAGES = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "log_messages.h")
+
+
+def load_messages(path):
+    """(name, level, format) per message ID, in file order."""
+    messages = []
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            match = MESSAGE_LINE.match(line.strip())
+            if match:
+                name, level, fmt = match.groups()
+                fmt = bytes(fmt, "utf-8").decode("unicode_escape").encode("latin-1").decode("utf-8")
+                messages.append((name, level, fmt))
+    return messages
+
+
+def render(fmt, payload):
+    """Apply a message format to a packed payload, the way the device does."""
+    offset = 0
+    out = []
+    last = 0
+    for match in CONVERSION.finditer(fmt):
+        out.append(fmt[last:match.start()])
+        last = match.end()
+        if match.group(1) == "%":
+            out.append("%")
+            continue
+        conversion = match.group(2)
+        spec = "%" + re.sub(r"(hh|h|ll|l|z)", "", match.group(1))
+        if conversion == "s":
+            end = payload.find(b"\0", offset)
+            end = len(payload) if end < 0 else end
+            value = payload[offset:end].decode("utf-8", "replace")
+            offset = end + 1
+        else:
+            raw = payload[offset:offset + 4].ljust(4, b"\0")
+            offset += 4
+            if conversion in "eEfFgG":
+                value = struct.unpack("<f", raw)[0]
+            elif conversion in "di":
+                value = struct.unpack("<i", raw)[0]
+            elif conversion == "c":
+                value = chr(struct.unpack("<I", raw)[0] & 0xFF)
+                spec = spec[:-1] + "s"
+            else:
+                value = struct.unpack("<I", raw)[0]
+        out.append(spec % value)
+    out.append(fmt[last:])
+    return "".join(out)
+
+
+class LogDecoder:
+    """Turns a byte stream into text on out. Feed it bytes as they arrive; a
+    record cut off at the end of one read is held until the rest comes in."""
+
+    def __init__(self, messages, out):
+        self.messages = messages
+        self.out = out
+        self.buffer = bytearray()
+        self.text = codecs.getincrementaldecoder("utf-8")("replace")
+
+    def feed(self, data):
+        self.buffer += data
+        pos = 0
+        while True:
+            marker = self.buffer.find(FRAME_MARKER, pos)
+            if marker < 0:
+                marker = len(self.buffer)
+                break
+            if marker + HEADER.size > len(self.buffer):
+                break
+            _, message_id, size, time_ms = HEADER.unpack_from(self.buffer, marker)
+            end = marker + HEADER.size + size
+            if end > len(self.buffer):
+                break
+
+            self.out.write(self.text.decode(bytes(self.buffer[pos:marker])))
+            self._record(message_id, bytes(self.buffer[marker + HEADER.size:end]), time_ms)
+            pos = end
+        self.out.write(self.text.decode(bytes(self.buffer[pos:marker])))
+        del self.buffer[:marker]
+
+    def finish(self):
+        """Whatever is left is text after all: a marker byte with no record."""
+        self.out.write(self.text.decode(bytes(self.buffer), final=True))
+        self.buffer.clear()
+
+    def _record(self, message_id, payload, time_ms):
+        if message_id < len(self.messages):
+            name, level, fmt = self.messages[message_id]
+            text = render(fmt, payload)
+        else:
+            level, text = "?", "unknown message %d (payload %s)" % (message_id, payload.hex())
+        self.out.write("[%10.3f] %-5s %s\n" % (time_ms / 1000.0, level, text))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("capture", nargs="?", help="serial capture, stdin if omitted")
+    parser.add_argument("--messages", default=DEFAULT_MESSAGES, help="path to log_messages.h")
+    args = parser.parse_args()
+
+    decoder = LogDecoder(load_messages(args.messages), sys.stdout)
+    source = open(args.capture, "rb") if args.capture else sys.stdin.buffer
+    with source:
+        while True:
+            # Whatever has arrived, so a live monitor prints as it goes
+            data = source.read1(65536)
+            if not data:
+                break
+            decoder.feed(data)
+            sys.stdout.flush()
+    decoder.finish()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""Turn a serial capture from the device into a trace for the host runner.
+
+Build the firmware with -DLOG_BINARY=1 -DTRACE_CAPTURE=1 and capture its
+serial output from power-up. The TRACE_* records in it (DHT replies,
+weather responses, serial input and where the servo came to rest) become a
+trace in the format lib/NativeHAL/src/Trace.cpp reads:
+
+    pio device monitor --raw > capture.bin
+    tools/trace_from_log.py capture.bin day.wtrc
+    .pio/build/native/program --replay day.wtrc
+
+The replay feeds the firmware what the device saw, at the times it saw it,
+and reports any window decision that comes out differently. A trace covers
+one boot: records after a reset in the capture are left out.
+
+Message IDs come from src/log_messages.h, so convert with the same revision
+the firmware was built from.
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+from log_decode import DEFAULT_MESSAGES, LogDecoder, load_messages
+
+TRACE_MAGIC = b"WTRC"
+TRACE_VERSION = 1
+TRACE_DHT, TRACE_HTTP, TRACE_SERIAL, TRACE_SERVO, TRACE_REST = range(1, 6)
+
+# DhtStatus in src/DhtReader.h
+DHT_OK, DHT_NO_RESPONSE, DHT_TRUNCATED, DHT_BAD_TIMING, DHT_BAD_CHECKSUM = range(5)
+
+HIGH, LOW = 1, 0
+
+# Further behind the latest record than this is a reset, not task ordering
+REORDER_MS = 60000
+
+
+def varint(value):
+    out = bytearray()
+    while value >= 0x80:
+        out.append(value & 0x7F | 0x80)
+        value >>= 7
+    out.append(value)
+    return bytes(out)
+
+
+def zigzag(value):
+    return value << 1 if value >= 0 else (-value << 1) - 1
+
+
+def dht_pulses(status, data):
+    """A reply the firmware decodes to the same status. Only the status of a
+    failed read is logged, so those get a stand-in: the response and one bit,
+    then cut off, or the low before that bit stretched out of tolerance."""
+    if status == DHT_NO_RESPONSE:
+        return b"\0"
+    if status in (DHT_OK, DHT_BAD_CHECKSUM):
+        return b"\1" + data
+    pulses = [(HIGH, 30), (LOW, 80), (HIGH, 80)]
+    if status == DHT_TRUNCATED:
+        pulses += [(LOW, 50), (HIGH, 26), (LOW, 50)]
+    else:
+        pulses += [(LOW, 150), (HIGH, 26), (LOW, 50)]
+        for bit in range(1, 40):
+            pulses += [(HIGH, 70 if data[bit // 8] & 0x80 >> bit % 8 else 26), (LOW, 50)]
+    pulses.append((HIGH, 0))  # Idle line: the end marker
+    return b"\2" + b"".join(varint(us << 1 | level) for level, us in pulses)
+
+
+class TraceBuilder(LogDecoder):
+    """Collects trace records from the TRACE_* log records, on a clock that
+    carries on past the 32-bit millisecond wrap."""
+
+    def __init__(self, messages):
+        super().__init__(messages, open(os.devnull, "w"))
+        self.ids = {name: message_id for message_id, (name, _, _) in enumerate(messages)}
+        self.records = []  # (ms, kind, payload), in log order
+        self.wall_clock = None
+        self.last_ms = 0  # Latest device time seen, and the same unwrapped
+        self.last_now = 0
+        self.rebooted = False
+
+    def _now(self, time_ms):
+        """Device time unwrapped, None once the device has reset. Records
+        from different tasks can come out a little behind one another."""
+        delta = (time_ms - self.last_ms + (1 << 31) & 0xFFFFFFFF) - (1 << 31)
+        if delta < -REORDER_MS:
+            self.rebooted = True
+            return None
+        now = self.last_now + delta
+        if delta > 0:
+            self.last_ms, self.last_now = time_ms, now
+        return now
+
+    @staticmethod
+    def _since(now, time_ms, started_at):
+        """An earlier device time, unwrapped the way now is."""
+        return now - (time_ms - started_at & 0xFFFFFFFF)
+
+    def _record(self, message_id, payload, time_ms):
+        if self.rebooted:
+            return
+        name = self.messages[message_id][0] if message_id < len(self.messages) else None
+        if not name or not name.startswith("TRACE_"):
+            return
+        now = self._now(time_ms)
+        if now is None:
+            print("warning: the device reset at %.3f s; the rest of the capture is left out" % (time_ms / 1000.0),
+                  file=sys.stderr)
+            return
+
+        if message_id == self.ids["TRACE_DHT"]:
+            fields = struct.unpack_from("<7I", payload)
+            data = bytes(fields[2:])
+            self.records.append([self._since(now, time_ms, fields[0]), TRACE_DHT, dht_pulses(fields[1], data)])
+        elif message_id == self.ids["TRACE_HTTP"]:
+            code, started_at, clock = struct.unpack_from("<iII", payload)
+            at = self._since(now, time_ms, started_at)
+            if self.wall_clock is None and clock:
+                self.wall_clock = clock - now // 1000
+            self.records.append([at, TRACE_HTTP, bytearray(varint(code & 0xFFFFFFFFFFFFFFFF))])
+        elif message_id == self.ids["TRACE_HTTP_BODY"]:
+            # Goes with the response before it
+            for record in reversed(self.records):
+                if record[1] == TRACE_HTTP:
+                    record[2] += payload.split(b"\0", 1)[0]
+                    break
+        elif message_id == self.ids["TRACE_SERIAL"]:
+            self.records.append([now, TRACE_SERIAL, payload.split(b"\0", 1)[0]])
+        elif message_id == self.ids["TRACE_REST"]:
+            angle = struct.unpack_from("<i", payload)[0]
+            self.records.append([now, TRACE_REST, bytes([angle & 0xFF])])
+
+    def trace(self):
+        if self.wall_clock is None:
+            print("warning: no weather fetch saw the clock set; the trace starts at 1970", file=sys.stderr)
+        out = bytearray(TRACE_MAGIC)
+        out.append(TRACE_VERSION)
+        out += struct.pack("<I", max(self.wall_clock or 0, 0))
+        last = 0
+        for at, kind, payload in sorted(self.records, key=lambda record: record[0]):
+            out.append(kind)
+            out += varint(zigzag(at - last))
+            out += varint(len(payload))
+            out += payload
+            last = at
+        return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("capture", help="serial capture from a TRACE_CAPTURE build")
+    parser.add_argument("trace", help="trace file to write")
+    parser.add_argument("--messages", default=DEFAULT_MESSAGES, help="path to log_messages.h")
+    args = parser.parse_args()
+
+    builder = TraceBuilder(load_messages(args.messages))
+    with open(args.capture, "rb") as source:
+        while True:
+            data = source.read(65536)
+            if not data:
+                break
+            builder.feed(data)
+    builder.finish()
+
+    trace = builder.trace()
+    with open(args.trace, "wb") as out:
+        out.write(trace)
+    counts = {}
+    for _, kind, _ in builder.records:
+        counts[kind] = counts.get(kind, 0) + 1
+    print("%d records: %d DHT, %d HTTP, %d serial, %d rests" % (len(builder.records), counts.get(TRACE_DHT, 0),
+          counts.get(TRACE_HTTP, 0), counts.get(TRACE_SERIAL, 0), counts.get(TRACE_REST, 0)), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()